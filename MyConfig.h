@@ -954,6 +954,46 @@
 //#define MY_RFM95_TCXO
 /** @}*/ // End of RFM95SettingGrpPub group
 
+/**
+ * @defgroup ReplaySettingGrpPub Replay
+ * @ingroup RadioSettingGrpPub
+ * @brief These options are specific to the replay transport (Linux only).
+ *
+ * The replay transport has no radio hardware. It feeds the frames received in a pcap file
+ * written by the gateway capture (capture=1) into the gateway, with the original timing
+ * scaled by replay_speed. Sent frames are discarded, enable capture to record them.
+ * The file and speed are set by replay_file and replay_speed in the configuration file.
+ * Use tools/replay/mysreplay.py to drive and evaluate replays.
+ * @{
+ */
+
+/**
+ * @def MY_RADIO_REPLAY
+ * @brief Define this to use the replay transport for sensor network communication.
+ */
+//#define MY_RADIO_REPLAY
+/** @}*/ // End of ReplaySettingGrpPub group
+
+/**
+ * @defgroup SimulationSettingGrpPub Simulation
+ * @ingroup RadioSettingGrpPub
+ * @brief These options are specific to the network simulation (Linux only).
+ *
+ * A simulation build runs many nodes in one process, each on a virtual clock driven by a
+ * discrete-event scheduler and connected by a modelled radio medium, so hours of network
+ * behaviour take seconds. Build and run it with tools/sim.
+ * @{
+ */
+
+/**
+ * @def MY_SIMULATION
+ * @brief Define this to build a node for the simulator instead of real hardware.
+ *
+ * hwMillis(), delay(), wait() and the transport are then backed by the simulator.
+ */
+//#define MY_SIMULATION
+/** @}*/ // End of SimulationSettingGrpPub group
+
 /**
  * @defgroup SoftSpiSettingGrpPub Soft SPI
  * @ingroup RadioSettingGrpPub
@@ -1032,6 +1072,64 @@
 #define MY_ROUTING_TABLE_SAVE_INTERVAL_MS (30*60*1000ul)
 #endif
 
+/**
+ * @def MY_ROUTE_CACHE_FEATURE
+ * @ingroup memorysavings
+ * @brief If defined, repeaters without RAM routing table keep the most recently used routes in RAM.
+ *
+ * Routes are looked up in a small LRU cache in front of the routing table in EEPROM. A changed
+ * route is written back when it is evicted from the cache or every
+ * @ref MY_ROUTING_TABLE_SAVE_INTERVAL_MS, unchanged routes are never written.
+ * @note Only used if the RAM routing table is not enabled, see @ref MY_RAM_ROUTING_TABLE_FEATURE.
+ */
+//#define MY_ROUTE_CACHE_FEATURE
+
+/**
+ * @def MY_ROUTE_CACHE_SIZE
+ * @brief Number of routes kept in the route cache (3 bytes RAM each, max 255).
+ */
+#ifndef MY_ROUTE_CACHE_SIZE
+#define MY_ROUTE_CACHE_SIZE (8u)
+#endif
+
+/**
+ * @def MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE
+ * @brief If defined, node IDs are 16 bit wide and networks can grow beyond 254 nodes.
+ *
+ * Frames between nodes whose IDs fit 8 bits stay protocol version 2, so nodes without this
+ * feature keep working alongside. Otherwise the frame is sent as protocol version 3, the high
+ * bytes of last, sender and destination follow the 7 byte header and the payload is limited to
+ * 22 bytes, send() fails for longer payloads. Nodes without the feature drop version 3 frames.
+ *
+ * The version is negotiated hop by hop: a parent answers the find parent request of a node with
+ * this feature in a version 3 frame, and the node requests its ID in a version 3 frame only
+ * through such a parent. A repeater keeps the version 3 frame only if its own parent handles
+ * it, so an ID request reaches the gateway in a version 3 frame only if every hop handles
+ * extended IDs. The gateway then passes the request to the controller with payload 3, and only
+ * those requests may be answered with an ID above 254, up to 0xFEFF.
+ *
+ * Supported by the RF24, replay and simulation transports. Signing, @ref MY_TRANSPORT_AEAD_FEATURE
+ * and @ref MY_OTA_FIRMWARE_FEATURE cover 8 bit IDs only and cannot be enabled alongside. The
+ * gateway features tracking nodes by ID (@ref MY_GATEWAY_ID_ALLOCATION_FEATURE,
+ * @ref MY_GATEWAY_LIVENESS_FEATURE, @ref MY_GATEWAY_LINK_HEALTH_FEATURE) ignore extended IDs.
+ */
+//#define MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE
+
+/**
+ * @def MY_EXTENDED_ROUTES
+ * @brief Number of routes to or via extended node IDs a repeater keeps (4 bytes RAM each).
+ *
+ * Routes between 8 bit IDs stay in the routing table, routes involving an extended ID are kept
+ * in a hash table in RAM only and are learned again after a restart. Must be a power of 2.
+ */
+#ifndef MY_EXTENDED_ROUTES
+#if defined(__linux__)
+#define MY_EXTENDED_ROUTES (4096u)
+#else
+#define MY_EXTENDED_ROUTES (64u)
+#endif
+#endif
+
 /**
  * @def MY_REPEATER_FEATURE
  * @brief Enables repeater functionality (relays messages from other nodes)
@@ -1123,6 +1221,99 @@
 */
 //#define MY_SIGNAL_REPORT_ENABLED
 
+/**
+ * @def MY_TRANSPORT_RX_RATE_LIMIT_FEATURE
+ * @brief If defined, GW and repeater nodes rate limit incoming traffic per neighbour (token bucket).
+ *
+ * Every message is charged to the node it was received from (the last hop), relayed messages
+ * count against the repeater that relayed them. Messages exceeding the rate of a neighbour are
+ * dropped before verification and routing. When a neighbour is throttled, a single
+ * I_LOG_MESSAGE is sent to the controller. The throttle is lifted once its bucket is refilled.
+ * @note Requires ~1.5kB RAM, i.e. not suitable for atmega328 based repeaters.
+ */
+//#define MY_TRANSPORT_RX_RATE_LIMIT_FEATURE
+
+/**
+ * @def MY_TRANSPORT_RX_RATE_LIMIT_INTERVAL_MS
+ * @brief Interval (in ms) to refill one token of a regular node bucket.
+ */
+#ifndef MY_TRANSPORT_RX_RATE_LIMIT_INTERVAL_MS
+#define MY_TRANSPORT_RX_RATE_LIMIT_INTERVAL_MS (1000ul)
+#endif
+
+/**
+ * @def MY_TRANSPORT_RX_RATE_LIMIT_BURST
+ * @brief Bucket size of a regular node, i.e. max. number of messages accepted in a burst (max 255).
+ */
+#ifndef MY_TRANSPORT_RX_RATE_LIMIT_BURST
+#define MY_TRANSPORT_RX_RATE_LIMIT_BURST (20u)
+#endif
+
+/**
+ * @def MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_INTERVAL_MS
+ * @brief Interval (in ms) to refill one token of a repeater node bucket.
+ *
+ * A node is classified as repeater as soon as it relays a message, i.e. last != sender.
+ */
+#ifndef MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_INTERVAL_MS
+#define MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_INTERVAL_MS (250ul)
+#endif
+
+/**
+ * @def MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_BURST
+ * @brief Bucket size of a repeater node (max 255).
+ */
+#ifndef MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_BURST
+#define MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_BURST (40u)
+#endif
+
+/**
+ * @def MY_TRANSPORT_FORWARD_QUEUE_FEATURE
+ * @brief If defined, GW and repeater nodes queue messages to relay and send them between receptions.
+ *
+ * Without the queue a relayed message is sent right away, including radio retries and a nonce
+ * exchange for signed traffic, while further frames pile up in the radio FIFO. With the queue
+ * the FIFO is drained first and queued messages are sent while nothing is waiting to be
+ * processed. When the queue overflows, messages are dropped and a single I_LOG_MESSAGE is sent
+ * to the controller; the number of dropped messages and the highest forwarding latency are
+ * reported once the queue has drained.
+ * @note Requires (@ref MY_TRANSPORT_FORWARD_QUEUE_SIZE * ~37) bytes RAM. Combine with
+ * @ref MY_RX_MESSAGE_BUFFER_FEATURE to keep receiving frames while a relayed message is sent.
+ */
+//#define MY_TRANSPORT_FORWARD_QUEUE_FEATURE
+
+/**
+ * @def MY_TRANSPORT_FORWARD_QUEUE_SIZE
+ * @brief Number of messages the forwarding queue holds (max 255).
+ */
+#ifndef MY_TRANSPORT_FORWARD_QUEUE_SIZE
+#define MY_TRANSPORT_FORWARD_QUEUE_SIZE (4u)
+#endif
+
+/**
+ * @def MY_TRANSPORT_STATS_FEATURE
+ * @brief If defined, nodes count link statistics and report them to the gateway.
+ *
+ * The counters are cumulative since boot and wrap: TX attempts, failures and re-routed
+ * node-to-node messages, dropped received frames, parent changes, seconds spent finding a parent
+ * and in failure state, and the average TX power level. They are sent as one packed
+ * I_TRANSPORT_STATS message (see @ref transportStats_t) after every heartbeat and, if
+ * @ref MY_TRANSPORT_STATS_INTERVAL_MS is set, at that interval.
+ * @see MY_GATEWAY_LINK_HEALTH_FEATURE
+ */
+//#define MY_TRANSPORT_STATS_FEATURE
+
+/**
+ * @def MY_TRANSPORT_STATS_INTERVAL_MS
+ * @brief Interval (in ms) to report link statistics while transport is ready, 0 to report with
+ *        heartbeats only.
+ *
+ * Sleeping nodes should report with their heartbeats.
+ */
+#ifndef MY_TRANSPORT_STATS_INTERVAL_MS
+#define MY_TRANSPORT_STATS_INTERVAL_MS (0ul)
+#endif
+
 /** @}*/ // End of RoutingNodeSettingGrpPub group
 
 /**
@@ -1180,6 +1371,37 @@
  *        Incompatible libraries are unable to send sensor data.
  */
 #define MY_CORE_COMPATIBILITY_CHECK
+
+/**
+ * @def MY_SEND_QUEUE_FEATURE
+ * @brief If defined, sketches can queue messages with sendAsync() and carry on while they are sent.
+ *
+ * send() returns when the message reached the first stop, which includes radio retries and,
+ * with signing, waiting for a nonce. sendAsync() copies the message into a queue and returns
+ * right away, the core sends one queued message per _process() call, i.e. between loop() calls
+ * and during wait(). An optional callback reports whether the message reached the first stop
+ * and, if an ack was requested, whether the destination acknowledged it within
+ * @ref MY_SEND_QUEUE_ACK_TIMEOUT_MS. sleep() sends all queued messages and waits for their acks
+ * before the node goes to sleep. send() is not queued and overtakes queued messages.
+ * @note Requires (@ref MY_SEND_QUEUE_SIZE * ~75) bytes RAM.
+ */
+//#define MY_SEND_QUEUE_FEATURE
+
+/**
+ * @def MY_SEND_QUEUE_SIZE
+ * @brief Number of messages the send queue holds, and of messages waiting for an ack (max 255).
+ */
+#ifndef MY_SEND_QUEUE_SIZE
+#define MY_SEND_QUEUE_SIZE (4u)
+#endif
+
+/**
+ * @def MY_SEND_QUEUE_ACK_TIMEOUT_MS
+ * @brief Time (in ms) to wait for the ack of a queued message before reporting SEND_NO_ACK.
+ */
+#ifndef MY_SEND_QUEUE_ACK_TIMEOUT_MS
+#define MY_SEND_QUEUE_ACK_TIMEOUT_MS (1000ul)
+#endif
 /** @}*/ // End of CoreSettingGrpPub group
 
 /**
@@ -1241,6 +1463,25 @@
 #define MY_OTA_FLASH_JDECID (0x1F65)
 #endif
 
+/**
+ * @def MY_OTA_RESUME_FEATURE
+ * @brief Define this to resume interrupted OTA firmware updates after a reboot.
+ *
+ * The number of verified blocks and their CRC are saved in EEPROM every
+ * @ref MY_OTA_CHECKPOINT_BLOCKS blocks. When the controller offers the same firmware again,
+ * the blocks in flash are checked against the CRC and the transfer continues from there.
+ * Takes 12 bytes of EEPROM, before @ref EEPROM_LOCAL_CONFIG_ADDRESS.
+ */
+//#define MY_OTA_RESUME_FEATURE
+
+/**
+ * @def MY_OTA_CHECKPOINT_BLOCKS
+ * @brief Number of firmware blocks between two progress checkpoints in EEPROM.
+ */
+#ifndef MY_OTA_CHECKPOINT_BLOCKS
+#define MY_OTA_CHECKPOINT_BLOCKS (32u)
+#endif
+
 /**
  * @def MY_DISABLE_REMOTE_RESET
  * @brief Disables over-the-air reset of node
@@ -1278,6 +1519,154 @@
 #define MY_GATEWAY_MAX_CLIENTS (1u)
 #endif
 
+/**
+ * @def MY_GATEWAY_TX_SCHEDULER_FEATURE
+ * @brief If defined, messages from the controller to the sensor network are queued and
+ *        scheduled by priority class instead of being sent in arrival order.
+ *
+ * Classes are control (internal messages and ACKs), interactive (set, req, presentation) and
+ * bulk (stream, i.e. OTA firmware blocks). Classes are served weighted round robin, i.e. a
+ * firmware rollout cannot delay interactive commands by more than one frame.
+ */
+//#define MY_GATEWAY_TX_SCHEDULER_FEATURE
+
+/**
+ * @def MY_GATEWAY_TX_QUEUE_SIZE
+ * @brief Number of queued messages per priority class (max 255).
+ */
+#ifndef MY_GATEWAY_TX_QUEUE_SIZE
+#define MY_GATEWAY_TX_QUEUE_SIZE (8u)
+#endif
+
+/**
+ * @def MY_GATEWAY_TX_WEIGHT_CONTROL
+ * @brief Frames served per scheduling round for the control class.
+ */
+#ifndef MY_GATEWAY_TX_WEIGHT_CONTROL
+#define MY_GATEWAY_TX_WEIGHT_CONTROL (4u)
+#endif
+
+/**
+ * @def MY_GATEWAY_TX_WEIGHT_INTERACTIVE
+ * @brief Frames served per scheduling round for the interactive class.
+ */
+#ifndef MY_GATEWAY_TX_WEIGHT_INTERACTIVE
+#define MY_GATEWAY_TX_WEIGHT_INTERACTIVE (2u)
+#endif
+
+/**
+ * @def MY_GATEWAY_TX_WEIGHT_BULK
+ * @brief Frames served per scheduling round for the bulk class.
+ */
+#ifndef MY_GATEWAY_TX_WEIGHT_BULK
+#define MY_GATEWAY_TX_WEIGHT_BULK (1u)
+#endif
+
+/**
+ * @def MY_GATEWAY_ID_ALLOCATION_FEATURE
+ * @brief If defined, the gateway answers node ID requests itself instead of the controller.
+ *
+ * IDs are leased from a range, the lease table in EEPROM remembers the hardware token of every
+ * node, i.e. a node gets its old ID back after its EEPROM was cleared. Only requests carrying a
+ * token (@ref MY_ID_REQUEST_TOKEN_FEATURE) are answered, the controller is told about every
+ * allocation with a log message. Requests without token, or if the range is exhausted and no
+ * lease has expired, are handed over to the controller as before. Requires a sensor network.
+ * @see MyIdAllocator.h
+ */
+//#define MY_GATEWAY_ID_ALLOCATION_FEATURE
+
+/**
+ * @def MY_ID_LEASE_FIRST
+ * @brief First node ID handed out by @ref MY_GATEWAY_ID_ALLOCATION_FEATURE.
+ */
+#ifndef MY_ID_LEASE_FIRST
+#define MY_ID_LEASE_FIRST (1u)
+#endif
+
+/**
+ * @def MY_ID_LEASE_COUNT
+ * @brief Number of node IDs handed out by @ref MY_GATEWAY_ID_ALLOCATION_FEATURE.
+ *
+ * Every lease takes 6 bytes of EEPROM, before @ref EEPROM_LOCAL_CONFIG_ADDRESS.
+ */
+#ifndef MY_ID_LEASE_COUNT
+#define MY_ID_LEASE_COUNT (32u)
+#endif
+
+/**
+ * @def MY_ID_LEASE_EXPIRY_DAYS
+ * @brief Days of gateway uptime after which the lease of a node not heard from may be reclaimed.
+ */
+#ifndef MY_ID_LEASE_EXPIRY_DAYS
+#define MY_ID_LEASE_EXPIRY_DAYS (90u)
+#endif
+
+/**
+ * @def MY_ID_REQUEST_TOKEN_FEATURE
+ * @brief If defined, a node without ID sends a token of its hardware ID along with I_ID_REQUEST.
+ *
+ * The token lets a gateway with @ref MY_GATEWAY_ID_ALLOCATION_FEATURE hand out the same ID again
+ * after the EEPROM of the node was cleared. Requests without token are handed over to the
+ * controller. Requires hwUniqueID() support of the platform, controllers expecting an empty
+ * I_ID_REQUEST payload may not accept the request.
+ */
+//#define MY_ID_REQUEST_TOKEN_FEATURE
+
+/**
+ * @def MY_GATEWAY_LIVENESS_FEATURE
+ * @brief If defined, the gateway tells the controller when a node goes silent or returns.
+ *
+ * Every frame received from a node restarts its timer, a node not heard from for
+ * @ref MY_LIVENESS_TOLERANCE reporting intervals is reported offline with a log message
+ * "LIV:ID=<id>,OFF", the next frame from it is reported with "LIV:ID=<id>,ON". Requires a
+ * sensor network.
+ * @see MyNodeLiveness.h
+ */
+//#define MY_GATEWAY_LIVENESS_FEATURE
+
+/**
+ * @def MY_LIVENESS_INTERVAL_S
+ * @brief Expected reporting interval of all nodes in seconds, 0 learns it for every node.
+ *
+ * A learned interval follows longer gaps by at most doubling per report and shorter gaps
+ * slowly, the silence before a node returns from offline is not learned. Frames less than
+ * 2 seconds apart count as one report.
+ */
+#ifndef MY_LIVENESS_INTERVAL_S
+#define MY_LIVENESS_INTERVAL_S (0u)
+#endif
+
+/**
+ * @def MY_LIVENESS_TOLERANCE
+ * @brief Number of reporting intervals a node may miss before it is reported offline.
+ */
+#ifndef MY_LIVENESS_TOLERANCE
+#define MY_LIVENESS_TOLERANCE (3u)
+#endif
+
+/**
+ * @def MY_LIVENESS_WHEEL_SLOTS
+ * @brief Slots of the timer wheel, one second each. Maximum 256.
+ *
+ * Timeouts longer than the wheel take extra turns, with at least as many slots as nodes a tick
+ * touches about one timer.
+ */
+#ifndef MY_LIVENESS_WHEEL_SLOTS
+#define MY_LIVENESS_WHEEL_SLOTS (64u)
+#endif
+
+/**
+ * @def MY_GATEWAY_LINK_HEALTH_FEATURE
+ * @brief If defined, the gateway turns link statistics of nodes into link health metrics.
+ *
+ * For every statistics report of a node (see @ref MY_TRANSPORT_STATS_FEATURE), the controller
+ * gets a log message "LNK:<id>,Q<q>,P<p>,F<f>": the TX success rate in % averaged over reports,
+ * the parent changes and the seconds spent in failure state since the previous report. The
+ * report itself is handed over to the controller as well. Requires a sensor network.
+ * @see MyLinkHealth.h
+ */
+//#define MY_GATEWAY_LINK_HEALTH_FEATURE
+
 /**
  * @def MY_INCLUSION_MODE_FEATURE
  * @brief Define this to enable the inclusion mode feature.
@@ -1501,10 +1890,26 @@
 /**
  * @def MY_USE_UDP
  * @brief Enables UDP mode for Ethernet gateway.
- * @note This is not supported on ENC28J60 and Linux based GWs.
+ *
+ * Linux based GWs act as UDP server: controllers register by sending a valid message to
+ * @ref MY_PORT and receive all messages from then on, until they are silent for
+ * @ref MY_UDP_CONTROLLER_TIMEOUT_MS. A datagram may carry several newline separated messages,
+ * messages to the controllers are sent in batches once per loop.
+ * @note This is not supported on ENC28J60, Linux based GWs do not support UDP client mode.
  */
 //#define MY_USE_UDP
 
+/**
+ * @def MY_UDP_CONTROLLER_TIMEOUT_MS
+ * @brief Time (in ms) after which a Linux UDP GW stops sending to a controller it did not
+ *        hear from, 0 to keep controllers until replaced by new ones.
+ *
+ * Controllers have to send a message, e.g. an I_VERSION request, more often than this.
+ */
+#ifndef MY_UDP_CONTROLLER_TIMEOUT_MS
+#define MY_UDP_CONTROLLER_TIMEOUT_MS (600000ul)
+#endif
+
 /**
  * @def MY_IP_RENEWAL_INTERVAL_MS
  * @brief DHCP, default renewal setting in milliseconds.
@@ -1625,6 +2030,7 @@
  * | @ref MY_SIGNING_WEAK_SECURITY | Weakens signing security, useful for testing before deploying signing "globally" | "#define" in the top of your sketch | @verbatim --my-signing-weak_security @endverbatim
  * | @ref MY_VERIFICATION_TIMEOUT_MS | Change default signing timeout | "#define" in the top of your sketch | @verbatim --my-signing-verification-timeout-ms=<TIMEOUT> @endverbatim
  * | @ref MY_SIGNING_NODE_WHITELISTING | Defines a whitelist of trusted nodes | "#define" in the top of your sketch | @verbatim --my-signing-whitelist="<WHITELIST>" @endverbatim
+ * | @ref MY_SIGNING_RUNTIME_WHITELIST | Takes the whitelist of trusted nodes from a file at runtime | Not supported | @verbatim --my-signing-runtime-whitelist @endverbatim
  * | @ref MY_SIGNING_ATSHA204_PIN | Change default ATSHA204A communication pin | "#define" in the top of your sketch | Not supported
  * | @ref MY_SIGNING_SOFT_RANDOMSEED_PIN | Change default software RNG seed pin | "#define" in the top of your sketch | Not supported
  * | @ref MY_RF24_ENABLE_ENCRYPTION | Enables encryption on RF24 radios | "#define" in the top of your sketch | @verbatim --my-rf24-encryption-enabled @endverbatim
@@ -1775,6 +2181,23 @@
  */
 //#define MY_SIGNING_NODE_WHITELISTING {{.nodeId = GATEWAY_ADDRESS,.serial = {0x09,0x08,0x07,0x06,0x05,0x04,0x03,0x02,0x01}}}
 
+/**
+ * @def MY_SIGNING_RUNTIME_WHITELIST
+ * @brief Define to take the whitelist from the HAL at runtime instead of @ref MY_SIGNING_NODE_WHITELISTING
+ *
+ * Whitelisting is turned on as with @ref MY_SIGNING_NODE_WHITELISTING, but the serial of a sender
+ * is looked up with hwSigningWhitelist(), so nodes can be added or revoked without a rebuild.
+ * A list given in @ref MY_SIGNING_NODE_WHITELISTING is ignored.
+ *
+ * Only supported on Linux with soft signing. The list is read from signing_whitelist_file in the
+ * configuration file and reloaded when mysgw receives SIGHUP.
+ */
+//#define MY_SIGNING_RUNTIME_WHITELIST
+#if defined(MY_SIGNING_RUNTIME_WHITELIST)
+#undef MY_SIGNING_NODE_WHITELISTING
+#define MY_SIGNING_NODE_WHITELISTING
+#endif
+
 /**
  * @def MY_SIGNING_ATSHA204_PIN
  * @brief Atsha204a default pin setting. Set it to match the pin the device is attached to.
@@ -1864,13 +2287,63 @@
 #endif
 #endif
 
+/**
+ * @def MY_TRANSPORT_AEAD_FEATURE
+ * @brief Encrypts and authenticates every frame with %AES-CCM, independent of the radio.
+ *
+ * Every hop appends its frame counter and a 4 byte tag to the frame, the receiver drops frames
+ * that fail the tag or whose counter it has seen before. Secure messages go out in a single
+ * frame, without the nonce exchange of signing, and signing cannot be enabled alongside.
+ * The key is the %AES key used for radio encryption, radio encryption itself is disabled.
+ *
+ * The trailer takes 8 bytes of every frame, i.e. @ref MAX_PAYLOAD shrinks to 17 bytes, which is
+ * too small for @ref MY_OTA_FIRMWARE_FEATURE. It has to be enabled on ALL nodes in the network.
+ * @see MyTransportAead.h
+ */
+//#define MY_TRANSPORT_AEAD_FEATURE
+
+/**
+ * @def MY_AEAD_COUNTER_RESERVE
+ * @brief Frame counters reserved in EEPROM at a time.
+ *
+ * The counter is saved every @ref MY_AEAD_COUNTER_RESERVE frames, after a restart the node
+ * continues after the last reservation. Without a reservation in EEPROM the node starts at a
+ * random counter.
+ */
+#ifndef MY_AEAD_COUNTER_RESERVE
+#define MY_AEAD_COUNTER_RESERVE (256ul)
+#endif
+
+/**
+ * @def MY_AEAD_REPLAY_PEERS
+ * @brief Number of neighbours a node keeps a replay window for.
+ *
+ * Every window takes 15 bytes of RAM. The window of the least recently heard neighbour is only
+ * reused after an hour of silence, frames of further neighbours are dropped until then.
+ */
+#ifndef MY_AEAD_REPLAY_PEERS
+#if defined(__linux__)
+#define MY_AEAD_REPLAY_PEERS (254u)
+#else
+#define MY_AEAD_REPLAY_PEERS (8u)
+#endif
+#endif
+
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+// frames are encrypted by the transport layer already
+#undef MY_RF24_ENABLE_ENCRYPTION
+#undef MY_RFM69_ENABLE_ENCRYPTION
+#undef MY_NRF5_ESB_ENABLE_ENCRYPTION
+#undef MY_RFM95_ENABLE_ENCRYPTION
+#endif
+
 /**
  * @def MY_ENCRYPTION_FEATURE
  * @ingroup internals
  * @brief Helper flag to indicate that some encryption feature is enabled, set automatically
- * @see MY_RF24_ENABLE_ENCRYPTION, MY_RFM69_ENABLE_ENCRYPTION, MY_NRF5_ESB_ENABLE_ENCRYPTION, MY_RFM95_ENABLE_ENCRYPTION
+ * @see MY_RF24_ENABLE_ENCRYPTION, MY_RFM69_ENABLE_ENCRYPTION, MY_NRF5_ESB_ENABLE_ENCRYPTION, MY_RFM95_ENABLE_ENCRYPTION, MY_TRANSPORT_AEAD_FEATURE
  */
-#if defined(MY_RF24_ENABLE_ENCRYPTION) || defined(MY_RFM69_ENABLE_ENCRYPTION) || defined(MY_NRF5_ESB_ENABLE_ENCRYPTION) || defined(MY_RFM95_ENABLE_ENCRYPTION)
+#if defined(MY_RF24_ENABLE_ENCRYPTION) || defined(MY_RFM69_ENABLE_ENCRYPTION) || defined(MY_NRF5_ESB_ENABLE_ENCRYPTION) || defined(MY_RFM95_ENABLE_ENCRYPTION) || defined(MY_TRANSPORT_AEAD_FEATURE)
 #define MY_ENCRYPTION_FEATURE
 #endif
 /** @}*/ // End of EncryptionSettingGrpPub group
@@ -2033,6 +2506,24 @@
 #ifndef MY_LINUX_CONFIG_FILE
 #define MY_LINUX_CONFIG_FILE "/etc/mysensors.conf"
 #endif
+
+/**
+ * @def MY_TRACE_PROBES
+ * @brief Enables USDT static tracepoints on the message hot path (requires sys/sdt.h).
+ *
+ * Probes compile to NOPs and can be attached at runtime with bpftrace, perf or SystemTap.
+ * @see MyTracegrp
+ */
+//#define MY_TRACE_PROBES
+
+/**
+ * @def MY_TRACE_RECORDER
+ * @brief Keeps the trace probes in the flight recorder of the stall detector.
+ *
+ * Recorded events show up in the dumps of the stall detector. Implied by @ref MY_TRACE_PROBES.
+ * @see MyTracegrp
+ */
+//#define MY_TRACE_RECORDER
 /** @}*/ // End of LinuxSettingGrpPub group
 /** @}*/ // End of PlatformSettingGrpPub group
 
@@ -2104,10 +2595,17 @@
 #endif
 
 // Enable sensor network "feature" if one of the transport types was enabled
-#if defined(MY_RADIO_RF24) || defined(MY_RADIO_NRF5_ESB) || defined(MY_RADIO_RFM69) || defined(MY_RADIO_RFM95) || defined(MY_RS485)
+#if defined(MY_RADIO_RF24) || defined(MY_RADIO_NRF5_ESB) || defined(MY_RADIO_RFM69) || defined(MY_RADIO_RFM95) || defined(MY_RS485) || defined(MY_RADIO_REPLAY) || defined(MY_SIMULATION)
 #define MY_SENSOR_NETWORK
 #endif
 
+// gateway ID allocation, liveness tracking and link health serve the sensor network of a gateway
+#if !defined(MY_GATEWAY_FEATURE) || !defined(MY_SENSOR_NETWORK)
+#undef MY_GATEWAY_ID_ALLOCATION_FEATURE
+#undef MY_GATEWAY_LIVENESS_FEATURE
+#undef MY_GATEWAY_LINK_HEALTH_FEATURE
+#endif
+
 // LEDS
 #if !defined(MY_DEFAULT_ERR_LED_PIN) && defined(MY_HW_ERR_LED_PIN)
 #define MY_DEFAULT_ERR_LED_PIN MY_HW_ERR_LED_PIN
@@ -2182,6 +2680,8 @@
 #define MY_LINUX_SERIAL_GROUPNAME
 #define MY_LINUX_SERIAL_PTY
 #define MY_LINUX_IS_SERIAL_PTY
+#define MY_TRACE_PROBES
+#define MY_TRACE_RECORDER
 // inclusion mode
 #define MY_INCLUSION_MODE_FEATURE
 #define MY_INCLUSION_BUTTON_FEATURE
@@ -2203,14 +2703,21 @@
 #define MY_MQTT_PUBLISH_TOPIC_PREFIX
 #define MY_MQTT_SUBSCRIBE_TOPIC_PREFIX
 #define MY_SIGNAL_REPORT_ENABLED
+#define MY_TRANSPORT_RX_RATE_LIMIT_FEATURE
+#define MY_TRANSPORT_FORWARD_QUEUE_FEATURE
+#define MY_ROUTE_CACHE_FEATURE
+#define MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE
+#define MY_TRANSPORT_STATS_FEATURE
 // general
 #define MY_WITH_LEDS_BLINKING_INVERSE
 #define MY_INDICATION_HANDLER
 #define MY_DISABLE_REMOTE_RESET
+#define MY_OTA_RESUME_FEATURE
 #define MY_DISABLE_RAM_ROUTING_TABLE_FEATURE
 #define MY_LOCK_DEVICE
 // core
 #define MY_CORE_ONLY
+#define MY_SEND_QUEUE_FEATURE
 // GW
 #define MY_DEBUG_VERBOSE_GATEWAY
 #define MY_INCLUSION_BUTTON_EXTERNAL_PULLUP
@@ -2225,6 +2732,11 @@
 #define MY_HOSTNAME
 #define MY_GATEWAY_LINUX
 #define MY_GATEWAY_TINYGSM
+#define MY_GATEWAY_TX_SCHEDULER_FEATURE
+#define MY_GATEWAY_ID_ALLOCATION_FEATURE
+#define MY_ID_REQUEST_TOKEN_FEATURE
+#define MY_GATEWAY_LIVENESS_FEATURE
+#define MY_GATEWAY_LINK_HEALTH_FEATURE
 #define MY_GATEWAY_MQTT_CLIENT
 #define MY_GATEWAY_SERIAL
 #define MY_IP_ADDRESS
@@ -2283,11 +2795,13 @@
 #define MY_SECURITY_SIMPLE_PASSWD
 #define MY_SIGNING_SIMPLE_PASSWD
 #define MY_ENCRYPTION_SIMPLE_PASSWD
+#define MY_TRANSPORT_AEAD_FEATURE
 #define MY_SIGNING_ATSHA204
 #define MY_SIGNING_SOFT
 #define MY_SIGNING_REQUEST_SIGNATURES
 #define MY_SIGNING_WEAK_SECURITY
 #define MY_SIGNING_NODE_WHITELISTING
+#define MY_SIGNING_RUNTIME_WHITELIST
 #define MY_DEBUG_VERBOSE_SIGNING
 #define MY_SIGNING_FEATURE
 #define MY_ENCRYPTION_FEATURE
@@ -2333,6 +2847,10 @@
 #define MY_RFM95_MODEM_CONFIGRUATION
 #define MY_RFM95_POWER_PIN
 #define MY_RFM95_TCXO
+// Replay
+#define MY_RADIO_REPLAY
+// Simulation
+#define MY_SIMULATION
 #define MY_RFM95_MAX_POWER_LEVEL_DBM
 // SOFT-SPI
 #define MY_SOFTSPI
@@ -44,6 +44,7 @@
 
 #include "core/MySplashScreen.h"
 #include "core/MySensorsCore.h"
+#include "core/MyTrace.h"
 
 // OTA Debug, has to be defined before HAL
 #if defined(MY_OTA_LOG_SENDER_FEATURE) || defined(MY_OTA_LOG_RECEIVER_FEATURE)
@@ -141,6 +142,16 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #if defined(MY_SIGNING_ATSHA204) && defined(__linux__)
 #error No support for ATSHA204 on this platform
 #endif
+#if defined(MY_SIGNING_RUNTIME_WHITELIST) && (!defined(__linux__) || !defined(MY_SIGNING_SOFT))
+#error MY_SIGNING_RUNTIME_WHITELIST is only supported with soft signing on Linux
+#endif
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+#error Frames are authenticated by MY_TRANSPORT_AEAD_FEATURE, signing cannot be activated
+#endif
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+// signatures cover the 8 bit header, the header extension would be unsigned
+#error MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE does not support signing
+#endif
 
 #if defined(MY_SIGNING_ATSHA204)
 #include "core/MySigningAtsha204.cpp"
@@ -152,6 +163,14 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 
 // FLASH
 #if defined(MY_OTA_FIRMWARE_FEATURE)
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+// the firmware config request and blocks exceed the 17 byte payload left by the trailer
+#error MY_OTA_FIRMWARE_FEATURE needs payloads of up to 22 bytes, MY_TRANSPORT_AEAD_FEATURE leaves 17
+#endif
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+// the bootloader reads the 8 bit node ID from EEPROM
+#error MY_OTA_FIRMWARE_FEATURE is not supported with MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE
+#endif
 #ifndef MCUBOOT_PRESENT
 #if defined(MY_OTA_USE_I2C_EEPROM)
 #include "drivers/I2CEeprom/I2CEeprom.cpp"
@@ -167,7 +186,7 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #define MY_GATEWAY_CLIENT_MODE	//!< gateway client mode
 #endif
 
-#if defined(MY_USE_UDP) && !defined(MY_GATEWAY_CLIENT_MODE)
+#if defined(MY_USE_UDP) && !defined(MY_GATEWAY_CLIENT_MODE) && !defined(MY_GATEWAY_LINUX)
 #error You must specify MY_CONTROLLER_IP_ADDRESS or MY_CONTROLLER_URL_ADDRESS for UDP
 #endif
 
@@ -234,11 +253,12 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #include "core/MyGatewayTransportEthernet.cpp"
 #elif defined(MY_GATEWAY_LINUX)
 // GATEWAY - Generic Linux
-#if defined(MY_USE_UDP)
-#error UDP mode is not available for Linux
+#if defined(MY_USE_UDP) && defined(MY_GATEWAY_CLIENT_MODE)
+#error UDP client mode is not available for Linux
 #endif
 #include "hal/architecture/Linux/drivers/core/EthernetClient.h"
 #include "hal/architecture/Linux/drivers/core/EthernetServer.h"
+#include "hal/architecture/Linux/drivers/core/EthernetUDPServer.h"
 #include "hal/architecture/Linux/drivers/core/IPAddress.h"
 #include "core/MyGatewayTransportEthernet.cpp"
 #elif defined(MY_GATEWAY_W5100)
@@ -284,8 +304,18 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #else
 #define __RS485CNT 0	//!< __RS485CNT
 #endif
+#if defined(MY_RADIO_REPLAY)
+#define __REPLAYCNT 1	//!< __REPLAYCNT
+#else
+#define __REPLAYCNT 0	//!< __REPLAYCNT
+#endif
+#if defined(MY_SIMULATION)
+#define __SIMCNT 1		//!< __SIMCNT
+#else
+#define __SIMCNT 0		//!< __SIMCNT
+#endif
 
-#if (__RF24CNT + __NRF5ESBCNT + __RFM69CNT + __RFM95CNT + __RS485CNT > 1)
+#if (__RF24CNT + __NRF5ESBCNT + __RFM69CNT + __RFM95CNT + __RS485CNT + __REPLAYCNT + __SIMCNT > 1)
 #error Only one forward link driver can be activated
 #endif
 #endif //DOXYGEN
@@ -296,7 +326,7 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #endif
 
 // TRANSPORT INCLUDES
-#if defined(MY_RADIO_RF24) || defined(MY_RADIO_NRF5_ESB) || defined(MY_RADIO_RFM69) || defined(MY_RADIO_RFM95) || defined(MY_RS485)
+#if defined(MY_RADIO_RF24) || defined(MY_RADIO_NRF5_ESB) || defined(MY_RADIO_RFM69) || defined(MY_RADIO_RFM95) || defined(MY_RS485) || defined(MY_RADIO_REPLAY) || defined(MY_SIMULATION)
 #include "hal/transport/MyTransportHAL.h"
 #include "core/MyTransport.h"
 
@@ -334,6 +364,24 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #define MY_RAM_ROUTING_TABLE_ENABLED
 #endif
 
+// ROUTE CACHE
+#if defined(MY_ROUTE_CACHE_FEATURE) && (defined(MY_RAM_ROUTING_TABLE_ENABLED) || !defined(MY_REPEATER_FEATURE))
+// only repeaters reading routes from EEPROM need the cache
+#undef MY_ROUTE_CACHE_FEATURE
+#endif
+
+// TRANSPORT STATS
+#if defined(MY_TRANSPORT_STATS_FEATURE) && (defined(MY_GATEWAY_FEATURE) || !defined(MY_SENSOR_NETWORK))
+// reported by nodes to the gateway
+#undef MY_TRANSPORT_STATS_FEATURE
+#endif
+
+// INGRESS RATE LIMIT
+#if defined(MY_TRANSPORT_RX_RATE_LIMIT_FEATURE) && !defined(MY_REPEATER_FEATURE)
+// only GW and repeater nodes rate limit incoming traffic
+#undef MY_TRANSPORT_RX_RATE_LIMIT_FEATURE
+#endif
+
 // SOFTSERIAL
 #if defined(MY_GSM_TX) != defined(MY_GSM_RX)
 #error Both, MY_GSM_TX and MY_GSM_RX need to be defined when using SoftSerial
@@ -381,6 +429,16 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #elif defined(MY_RADIO_RFM95)
 #include "hal/transport/RFM95/driver/RFM95.cpp"
 #include "hal/transport/RFM95/MyTransportRFM95.cpp"
+#elif defined(MY_RADIO_REPLAY)
+#if !defined(__linux__)
+#error Replay transport is only supported on Linux
+#endif
+#include "hal/transport/Replay/MyTransportReplay.cpp"
+#elif defined(MY_SIMULATION)
+#if !defined(__linux__)
+#error Simulation is only supported on Linux
+#endif
+#include "hal/transport/Sim/MyTransportSim.cpp"
 #endif
 
 // PASSIVE MODE
@@ -398,6 +456,27 @@ MY_DEFAULT_RX_LED_PIN in your sketch instead to enable LEDs
 #endif
 #endif
 
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+#error MY_TRANSPORT_AEAD_FEATURE does not authenticate the header extension of MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE
+#endif
+#if !defined(MY_RADIO_RF24) && !defined(MY_RADIO_REPLAY) && !defined(MY_SIMULATION)
+// the other drivers address nodes with 8 bits in hardware or in their own frame header
+#error MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE is only supported by RF24, replay and simulation transports
+#endif
+#endif
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+#include "core/MyTransportAead.cpp"
+#endif
+#if defined(MY_GATEWAY_ID_ALLOCATION_FEATURE)
+#include "core/MyIdAllocator.cpp"
+#endif
+#if defined(MY_GATEWAY_LIVENESS_FEATURE)
+#include "core/MyNodeLiveness.cpp"
+#endif
+#if defined(MY_GATEWAY_LINK_HEALTH_FEATURE)
+#include "core/MyLinkHealth.cpp"
+#endif
 #include "core/MyTransport.cpp"
 #endif
 
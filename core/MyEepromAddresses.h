@@ -48,6 +48,28 @@
 #define SIZE_SIGNING_SOFT_SERIAL			(9u)		//!< Size soft signing serial
 #define SIZE_RF_ENCRYPTION_AES_KEY			(16u)	//!< Size RF AES encryption key
 #define SIZE_NODE_LOCK_COUNTER				(1u)		//!< Size node lock counter
+#if defined(MY_GATEWAY_ID_ALLOCATION_FEATURE)
+#define SIZE_ID_LEASE_DAY					(2u)		//!< Size ID lease day counter
+#define SIZE_ID_LEASE_TABLE					(MY_ID_LEASE_COUNT * 6u)	//!< Size ID lease table
+#else
+#define SIZE_ID_LEASE_DAY					(0u)		//!< Size ID lease day counter
+#define SIZE_ID_LEASE_TABLE					(0u)		//!< Size ID lease table
+#endif
+#if defined(MY_OTA_FIRMWARE_FEATURE) && defined(MY_OTA_RESUME_FEATURE)
+#define SIZE_OTA_CHECKPOINT					(12u)	//!< Size OTA progress checkpoint
+#else
+#define SIZE_OTA_CHECKPOINT					(0u)		//!< Size OTA progress checkpoint
+#endif
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+#define SIZE_AEAD_COUNTER					(4u)		//!< Size AEAD frame counter reservation
+#else
+#define SIZE_AEAD_COUNTER					(0u)		//!< Size AEAD frame counter reservation
+#endif
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+#define SIZE_NODE_ID_HIGH					(1u)		//!< Size high byte of an extended node ID
+#else
+#define SIZE_NODE_ID_HIGH					(0u)		//!< Size high byte of an extended node ID
+#endif
 
 
 /** @brief EEPROM start address */
@@ -84,8 +106,18 @@
 #define EEPROM_RF_ENCRYPTION_AES_KEY_ADDRESS (EEPROM_SIGNING_SOFT_SERIAL_ADDRESS + SIZE_SIGNING_SOFT_SERIAL)
 /** @brief Address node lock counter. This is set with @ref SecurityPersonalizer.ino */
 #define EEPROM_NODE_LOCK_COUNTER_ADDRESS (EEPROM_RF_ENCRYPTION_AES_KEY_ADDRESS + SIZE_RF_ENCRYPTION_AES_KEY)
+/** @brief Address ID lease day counter, gateways with @ref MY_GATEWAY_ID_ALLOCATION_FEATURE only */
+#define EEPROM_ID_LEASE_DAY_ADDRESS (EEPROM_NODE_LOCK_COUNTER_ADDRESS + SIZE_NODE_LOCK_COUNTER)
+/** @brief Address ID lease table, gateways with @ref MY_GATEWAY_ID_ALLOCATION_FEATURE only */
+#define EEPROM_ID_LEASE_TABLE_ADDRESS (EEPROM_ID_LEASE_DAY_ADDRESS + SIZE_ID_LEASE_DAY)
+/** @brief Address OTA progress checkpoint, nodes with @ref MY_OTA_RESUME_FEATURE only */
+#define EEPROM_OTA_CHECKPOINT_ADDRESS (EEPROM_ID_LEASE_TABLE_ADDRESS + SIZE_ID_LEASE_TABLE)
+/** @brief Address AEAD frame counter reservation, nodes with @ref MY_TRANSPORT_AEAD_FEATURE only */
+#define EEPROM_AEAD_COUNTER_ADDRESS (EEPROM_OTA_CHECKPOINT_ADDRESS + SIZE_OTA_CHECKPOINT)
+/** @brief Address high byte of the node ID, nodes with @ref MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE only */
+#define EEPROM_NODE_ID_HIGH_ADDRESS (EEPROM_AEAD_COUNTER_ADDRESS + SIZE_AEAD_COUNTER)
 /** @brief First free address for sketch static configuration */
-#define EEPROM_LOCAL_CONFIG_ADDRESS (EEPROM_NODE_LOCK_COUNTER_ADDRESS + SIZE_NODE_LOCK_COUNTER)
+#define EEPROM_LOCAL_CONFIG_ADDRESS (EEPROM_NODE_ID_HIGH_ADDRESS + SIZE_NODE_ID_HIGH)
 
 #endif // MyEepromAddresses_h
 
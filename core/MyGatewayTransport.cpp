@@ -25,45 +25,395 @@ extern bool transportSendRoute(MyMessage &message);
 extern MyMessage _msg;
 extern MyMessage _msgTmp;
 
+#if defined(MY_GATEWAY_TX_SCHEDULER_FEATURE) && defined(MY_SENSOR_NETWORK)
+// outbound priority classes
+#define GW_TX_CLASS_CONTROL		(0u)	//!< internal messages and ACKs
+#define GW_TX_CLASS_INTERACTIVE	(1u)	//!< set, req, presentation
+#define GW_TX_CLASS_BULK		(2u)	//!< stream, i.e. OTA firmware blocks
+#define GW_TX_CLASSES			(3u)	//!< number of classes
+
+static const uint8_t _gwTxWeight[GW_TX_CLASSES] = {
+	MY_GATEWAY_TX_WEIGHT_CONTROL,
+	MY_GATEWAY_TX_WEIGHT_INTERACTIVE,
+	MY_GATEWAY_TX_WEIGHT_BULK
+};
+static gatewayTxQueue_t _gwTxQueue[GW_TX_CLASSES];	//!< outbound queues, one per class
+static uint8_t _gwTxCredit[GW_TX_CLASSES];			//!< frames left in current round
+static bool _gwTxActive = false;					//!< sending, prevents re-entry via _process()
+
+static uint8_t gatewayTransportTxClass(MyMessage &message)
+{
+	const uint8_t command = mGetCommand(message);
+	if (mGetAck(message) || command == C_INTERNAL) {
+		return GW_TX_CLASS_CONTROL;
+	}
+	if (command == C_STREAM) {
+		return GW_TX_CLASS_BULK;
+	}
+	return GW_TX_CLASS_INTERACTIVE;
+}
+
+static bool gatewayTransportTxDispatch(void)
+{
+	if (_gwTxActive) {
+		// signing may call _process() while sending, keep order and stack depth
+		return false;
+	}
+	for (uint8_t round = 0; round < 2; round++) {
+		for (uint8_t txClass = 0; txClass < GW_TX_CLASSES; txClass++) {
+			gatewayTxQueue_t &queue = _gwTxQueue[txClass];
+			if (queue.count && _gwTxCredit[txClass]) {
+				_gwTxCredit[txClass]--;
+				MyMessage message = queue.msg[queue.head];
+				queue.head = (queue.head + 1) % MY_GATEWAY_TX_QUEUE_SIZE;
+				queue.count--;
+				_gwTxActive = true;
+				(void)transportSendRoute(message);
+				_gwTxActive = false;
+				return true;
+			}
+		}
+		// no pending class with credit left, start new round
+		for (uint8_t txClass = 0; txClass < GW_TX_CLASSES; txClass++) {
+			_gwTxCredit[txClass] = _gwTxWeight[txClass];
+		}
+	}
+	return false;
+}
+
+static void gatewayTransportTxEnqueue(MyMessage &message)
+{
+	const uint8_t txClass = gatewayTransportTxClass(message);
+	gatewayTxQueue_t &queue = _gwTxQueue[txClass];
+	if (queue.count == MY_GATEWAY_TX_QUEUE_SIZE) {
+		GATEWAY_DEBUG(PSTR("!GWT:TXQ:FULL,CL=%" PRIu8 "\n"), txClass);
+		if (!gatewayTransportTxDispatch()) {
+			// re-entered while sending, no room can be made: send directly
+			(void)transportSendRoute(message);
+			return;
+		}
+		if (queue.count == MY_GATEWAY_TX_QUEUE_SIZE) {
+			// another class was served, make room by serving oldest frame of this class
+			MyMessage oldest = queue.msg[queue.head];
+			queue.head = (queue.head + 1) % MY_GATEWAY_TX_QUEUE_SIZE;
+			queue.count--;
+			_gwTxActive = true;
+			(void)transportSendRoute(oldest);
+			_gwTxActive = false;
+		}
+	}
+	queue.msg[(queue.head + queue.count) % MY_GATEWAY_TX_QUEUE_SIZE] = message;
+	queue.count++;
+}
+#endif
+
+#if defined(MY_HW_HAS_JOURNAL)
+static uint32_t _gwJournalTimestamp = 0;	//!< timestamp of the last JRN:TS marker sent
+
+static void gatewayTransportJournalReplay(void)
+{
+	uint16_t budget = hwJournalPending() ? hwJournalReplayBudget() : 0;
+	while (budget--) {
+		MyMessage message;
+		uint8_t length;
+		uint32_t timestamp;
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+		// records hold wire frames, the node ID fields are wider in memory
+		uint8_t frame[MAX_MESSAGE_LENGTH];
+		if (!hwJournalPeek(frame, &length, &timestamp)) {
+			return;
+		}
+		(void)message.setFrame(frame, length);
+#else
+		if (!hwJournalPeek(&message, &length, &timestamp)) {
+			return;
+		}
+#endif
+		if (timestamp != _gwJournalTimestamp) {
+			// original time of the messages that follow, as metadata for the controller
+			char marker[MAX_PAYLOAD + 1];
+			(void)snprintf(marker, sizeof(marker), "JRN:TS=%" PRIu32, timestamp);
+			if (!gatewayTransportSend(buildGw(_msgTmp, I_LOG_MESSAGE).set(marker))) {
+				hwJournalReplayFailed();
+				return;
+			}
+			_gwJournalTimestamp = timestamp;
+		}
+		if (!gatewayTransportSend(message)) {
+			// controller still absent, or gone again
+			_gwJournalTimestamp = 0;
+			hwJournalReplayFailed();
+			return;
+		}
+		hwJournalPop();
+		GATEWAY_DEBUG(PSTR("GWT:JRN:REPLAY,P=%" PRIu32 "\n"), hwJournalPending());
+	}
+}
+#endif
+
+#if defined(MY_HW_HAS_SERIES)
+#define GATEWAY_SERIES_MAX_ROWS (250u)	//!< rows per query answer, the main loop waits meanwhile
+
+static uint16_t _gwSeriesRows = 0;		//!< rows sent for the current answer
+static uint16_t _gwSeriesSkip = 0;		//!< rows at _gwSeriesLast already sent, skipped by MORE
+static uint16_t _gwSeriesSame = 0;		//!< rows sent so far with time _gwSeriesLast
+static uint32_t _gwSeriesLast = 0;		//!< time of the last row sent
+static bool _gwSeriesMore = false;		//!< last answer stopped early, MORE continues it
+static uint32_t _gwSeriesKey = 0;		//!< series of the last query, continued by MORE
+static uint32_t _gwSeriesTo = 0;		//!< end of the last query
+static uint32_t _gwSeriesBucket = 0;	//!< bucket of the last query
+static char _gwSeriesAggregate = '\0';	//!< aggregate of the last query
+
+static void gatewayTransportSeriesAppend(MyMessage &message)
+{
+	if (mGetCommand(message) != C_SET || mGetAck(message)) {
+		return;
+	}
+	double value;
+	switch (mGetPayloadType(message)) {
+	case P_BYTE:
+		value = message.getByte();
+		break;
+	case P_INT16:
+		value = message.getInt();
+		break;
+	case P_UINT16:
+		value = message.getUInt();
+		break;
+	case P_LONG32:
+		value = message.getLong();
+		break;
+	case P_ULONG32:
+		value = message.getULong();
+		break;
+	case P_FLOAT32:
+		value = message.getFloat();
+		break;
+	case P_STRING: {
+		// numbers sent as text, other text is no reading
+		char text[MAX_PAYLOAD + 1];
+		char *end;
+		value = strtod(message.getString(text), &end);
+		if (end == text || *end != '\0') {
+			return;
+		}
+		break;
+	}
+	default:
+		return;
+	}
+	(void)hwSeriesAppend(HW_SERIES_KEY(message.sender, message.sensor, message.type), hwSeriesTime(),
+	                     value);
+}
+
+static int gatewayTransportSeriesRow(uint32_t timestamp, double value, void *context)
+{
+	(void)context;
+	char row[MAX_PAYLOAD + 1];
+	if (_gwSeriesSkip) {
+		// sent by the previous answer, which stopped between rows of the same second
+		_gwSeriesSkip--;
+		return 0;
+	}
+	if (_gwSeriesRows == GATEWAY_SERIES_MAX_ROWS) {
+		_gwSeriesMore = true;
+		return 1;
+	}
+	if (value == floor(value) && fabs(value) < 1e10) {
+		(void)snprintf(row, sizeof(row), "%" PRIu32 ",%.0f", timestamp, value);
+	} else {
+		(void)snprintf(row, sizeof(row), "%" PRIu32 ",%.7g", timestamp, value);
+	}
+	if (!gatewayTransportReply(buildGw(_msgTmp, I_SERIES_QUERY).set(row))) {
+		_gwSeriesMore = true;
+		return 1;
+	}
+	if (_gwSeriesSame && timestamp == _gwSeriesLast) {
+		_gwSeriesSame++;
+	} else {
+		_gwSeriesLast = timestamp;
+		_gwSeriesSame = 1;
+	}
+	_gwSeriesRows++;
+	return 0;
+}
+
+// seconds before now, or seconds since the epoch with a leading '@'
+static bool gatewayTransportSeriesTime(const char *text, const uint32_t now, uint32_t *timestamp)
+{
+	const bool absolute = (*text == '@');
+	char *end;
+	const unsigned long value = strtoul(text + absolute, &end, 10);
+	if (end == text + absolute || *end != '\0') {
+		return false;
+	}
+	*timestamp = absolute ? (uint32_t)value : (value < now ? now - (uint32_t)value : 0);
+	return true;
+}
+
+static void gatewayTransportSeriesQuery(void)
+{
+	// <node>,<child>,<type>,<from>,<to>,<aggregate>[<bucket>], or MORE to continue the last one
+	char request[MAX_PAYLOAD * 2 + 1];	// binary payloads are returned as hex
+	char reply[MAX_PAYLOAD + 1];
+	char fromText[12], toText[12];
+	unsigned int node, child, type;
+	uint32_t from = 0, to, bucket = 0;
+	char aggregate = '\0';
+	int rows = -1;
+	const uint32_t now = hwSeriesTime();
+	bool valid = false;
+
+	if (!strcmp(_msg.getString(request), "MORE")) {
+		// continue after the last row sent, relative times would have moved on meanwhile
+		from = _gwSeriesLast;
+		_gwSeriesSkip = _gwSeriesSame;
+		valid = _gwSeriesMore;
+	} else if (sscanf(request, "%u,%u,%u,%11[@0-9],%11[@0-9],%c%" SCNu32,
+	                  &node, &child, &type, fromText, toText, &aggregate, &bucket) >= 6 &&
+	           node == (nodeId_t)node && child <= 0xFF && type <= 0xFF &&
+	           gatewayTransportSeriesTime(fromText, now, &from) &&
+	           gatewayTransportSeriesTime(toText, now, &to) && from <= to) {
+		_gwSeriesKey = HW_SERIES_KEY(node, child, type);
+		_gwSeriesTo = to;
+		_gwSeriesAggregate = aggregate;
+		_gwSeriesBucket = bucket;
+		_gwSeriesLast = 0;
+		_gwSeriesSame = 0;
+		_gwSeriesSkip = 0;
+		valid = true;
+	}
+	_gwSeriesRows = 0;
+	_gwSeriesMore = false;
+	if (valid) {
+		rows = hwSeriesQuery(_gwSeriesKey, from, _gwSeriesTo, _gwSeriesAggregate, _gwSeriesBucket,
+		                     gatewayTransportSeriesRow, NULL);
+	}
+	if (rows < 0) {
+		(void)snprintf(reply, sizeof(reply), "ERR");
+	} else if (_gwSeriesMore) {
+		// time of the last row sent, the controller sends MORE for the rest
+		(void)snprintf(reply, sizeof(reply), "MORE,@%" PRIu32, _gwSeriesLast);
+	} else {
+		(void)snprintf(reply, sizeof(reply), "END,%" PRIu16, _gwSeriesRows);
+	}
+	(void)gatewayTransportReply(buildGw(_msgTmp, I_SERIES_QUERY).set(reply));
+	GATEWAY_DEBUG(PSTR("GWT:SER:QUERY,R=%" PRIu16 "\n"), _gwSeriesRows);
+}
+#endif
+
+bool gatewayTransportDeliver(MyMessage &message)
+{
+#if defined(MY_HW_HAS_SERIES)
+	gatewayTransportSeriesAppend(message);
+#endif
+#if defined(MY_HW_HAS_JOURNAL)
+	// while messages are pending in the journal new ones queue up behind them
+	if (!hwJournalPending() && gatewayTransportSend(message)) {
+		return true;
+	}
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	// offset by one, the key of node 0 must differ from HW_JOURNAL_KEY_NONE
+	const uint32_t sender = (uint32_t)message.sender + 1;
+	uint8_t frame[MAX_MESSAGE_LENGTH];
+	const uint8_t length = message.getFrame(frame, false);
+#else
+	const uint32_t sender = 0x0100ul | message.sender;
+	const uint8_t *frame = (const uint8_t *)&message;
+	const uint8_t length = HEADER_SIZE + mGetLength(message);
+#endif
+	const uint32_t key = (mGetCommand(message) == C_SET && !mGetAck(message)) ?
+	                     ((sender << 16) | ((uint32_t)message.sensor << 8) | message.type) :
+	                     HW_JOURNAL_KEY_NONE;
+	if (length && hwJournalAppend(key, frame, length)) {
+		GATEWAY_DEBUG(PSTR("GWT:JRN:STORED,P=%" PRIu32 "\n"), hwJournalPending());
+	}
+	return false;
+#else
+	return gatewayTransportSend(message);
+#endif
+}
+
 inline void gatewayTransportProcess(void)
 {
+#if defined(MY_GATEWAY_TX_SCHEDULER_FEATURE) && defined(MY_SENSOR_NETWORK)
+	// pick up everything the controller sent so far, then serve one frame by priority
+	uint8_t received = MY_GATEWAY_TX_QUEUE_SIZE;
+	while (received-- && gatewayTransportAvailable()) {
+		gatewayTransportProcessMessage();
+	}
+	(void)gatewayTransportTxDispatch();
+#else
 	if (gatewayTransportAvailable()) {
-		_msg = gatewayTransportReceive();
-		if (_msg.destination == GATEWAY_ADDRESS) {
-
-			// Check if sender requests an ack back.
-			if (mGetRequestAck(_msg)) {
-				// Copy message
-				_msgTmp = _msg;
-				mSetRequestAck(_msgTmp,
-				               false); // Reply without ack flag (otherwise we would end up in an eternal loop)
-				mSetAck(_msgTmp, true);
-				_msgTmp.sender = getNodeId();
-				_msgTmp.destination = _msg.sender;
-				gatewayTransportSend(_msgTmp);
-			}
-			if (mGetCommand(_msg) == C_INTERNAL) {
-				if (_msg.type == I_VERSION) {
-					// Request for version. Create the response
-					gatewayTransportSend(buildGw(_msgTmp, I_VERSION).set(MYSENSORS_LIBRARY_VERSION));
+		gatewayTransportProcessMessage();
+	}
+#endif
+#if defined(MY_HW_HAS_JOURNAL)
+	gatewayTransportJournalReplay();
+#endif
+}
+
+uint8_t gatewayTransportTxPending(void)
+{
+#if defined(MY_GATEWAY_TX_SCHEDULER_FEATURE) && defined(MY_SENSOR_NETWORK)
+	uint8_t pending = 0;
+	for (uint8_t txClass = 0; txClass < GW_TX_CLASSES; txClass++) {
+		pending += _gwTxQueue[txClass].count;
+	}
+	return pending;
+#else
+	return 0;
+#endif
+}
+
+void gatewayTransportProcessMessage(void)
+{
+	_msg = gatewayTransportReceive();
+	if (_msg.destination == GATEWAY_ADDRESS) {
+
+		// Check if sender requests an ack back.
+		if (mGetRequestAck(_msg)) {
+			// Copy message
+			_msgTmp = _msg;
+			mSetRequestAck(_msgTmp,
+			               false); // Reply without ack flag (otherwise we would end up in an eternal loop)
+			mSetAck(_msgTmp, true);
+			_msgTmp.sender = getNodeId();
+			_msgTmp.destination = _msg.sender;
+			gatewayTransportSend(_msgTmp);
+		}
+		if (mGetCommand(_msg) == C_INTERNAL) {
+			if (_msg.type == I_VERSION) {
+				// Request for version. Create the response
+				gatewayTransportSend(buildGw(_msgTmp, I_VERSION).set(MYSENSORS_LIBRARY_VERSION));
 #ifdef MY_INCLUSION_MODE_FEATURE
-				} else if (_msg.type == I_INCLUSION_MODE) {
-					// Request to change inclusion mode
-					inclusionModeSet(atoi(_msg.data) == 1);
+			} else if (_msg.type == I_INCLUSION_MODE) {
+				// Request to change inclusion mode
+				inclusionModeSet(atoi(_msg.data) == 1);
+#endif
+#if defined(MY_HW_HAS_SERIES)
+			} else if (_msg.type == I_SERIES_QUERY) {
+				gatewayTransportSeriesQuery();
 #endif
-				} else {
-					(void)_processInternalCoreMessage();
-				}
 			} else {
-				// Call incoming message callback if available
-				if (receive) {
-					receive(_msg);
-				}
+				(void)_processInternalCoreMessage();
 			}
 		} else {
-#if defined(MY_SENSOR_NETWORK)
-			transportSendRoute(_msg);
+#if defined(MY_SEND_QUEUE_FEATURE)
+			if (mGetAck(_msg)) {
+				_sendQueueAck(_msg);
+			}
 #endif
+			// Call incoming message callback if available
+			if (receive) {
+				receive(_msg);
+			}
 		}
+	} else {
+#if defined(MY_GATEWAY_TX_SCHEDULER_FEATURE) && defined(MY_SENSOR_NETWORK)
+		gatewayTransportTxEnqueue(_msg);
+#elif defined(MY_SENSOR_NETWORK)
+		transportSendRoute(_msg);
+#endif
 	}
 }
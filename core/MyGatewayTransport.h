@@ -37,6 +37,12 @@
 *  - GWT:<b>RFC</b>		from _readFromClient()
 *  - GWT:<b>TSA</b>		from @ref gatewayTransportAvailable()
 *  - GWT:<b>TRC</b>		from @ref gatewayTransportReceive()
+*  - GWT:<b>TXQ</b>		from @ref gatewayTransportProcessMessage(), outbound priority queues
+*  - GWT:<b>JRN</b>		from @ref gatewayTransportDeliver(), outbound journal
+*  - GWT:<b>SER</b>		from @ref gatewayTransportProcessMessage(), sensor history query
+*  - GWT:<b>IDA</b>		from idAllocatorRequest() and idAllocatorSeen(), node ID allocation
+*  - GWT:<b>LIV</b>		from livenessProcess() and livenessSeen(), node liveness
+*  - GWT:<b>LNK</b>		from linkHealthReport(), link health of nodes
 *
 * Gateway transport debug log messages :
 *
@@ -60,12 +66,24 @@
 * | | GWT | RFC   | C=%%d,MSG=%%s             | Received message [%%s] from client [%%d]
 * |!| GWT | RFC   | C=%%d,MSG TOO LONG        | Received message from client [%%d] too long
 * | | GWT | TSA   | UDP MSG=%%s               | Received UDP message [%%s]
+* | | GWT | TSA   | UDP CONTROLLER            | Sender of a valid UDP message registered as new controller
 * | | GWT | TSA   | ETH OK                    | Connected to network
 * |!| GWT | TSA   | ETH FAIL                  | Connection failed
 * | | GWT | TSA   | C=%d,DISCONNECTED         | Client [%%d] disconnected
 * | | GWT | TSA   | C=%d,CONNECTED            | Client [%%d] connected
 * |!| GWT | TSA   | NO FREE SLOT              | No free slot for client
 * |!| GWT | TRC   | IP RENEW FAIL             | IP renewal failed
+* |!| GWT | TXQ   | FULL,CL=%%d               | Outbound queue of priority class [%%d] full, frame sent ahead of schedule
+* | | GWT | JRN   | STORED,P=%%d              | Controller absent, message kept in journal, [%%d] messages pending
+* | | GWT | JRN   | REPLAY,P=%%d              | Journaled message replayed, [%%d] messages pending
+* | | GWT | SER   | QUERY,R=%%d               | Sensor history query answered with [%%d] rows
+* | | GWT | IDA   | ID=%%d,TK=%%08X            | Node with hardware token [%%08X] got ID [%%d]
+* | | GWT | IDA   | ADOPT,ID=%%d              | Node [%%d] heard without lease, lease taken for it
+* |!| GWT | IDA   | FULL                      | No free or expired lease, request handed over to the controller
+* | | GWT | LIV   | OFF,ID=%%d,I=%%d           | Node [%%d] silent for too long, reporting interval [%%d] s
+* | | GWT | LIV   | ON,ID=%%d,I=%%d            | Node [%%d] heard again, reporting interval [%%d] s
+* | | GWT | LNK   | ID=%%d,Q=%%d,TX=%%d,F=%%d    | Node [%%d] link quality [%%d] %%, [%%d] frames sent and [%%d] failed since its last report
+* |!| GWT | LNK   | ID=%%d,INVALID             | Statistics report of node [%%d] has an unknown layout
 *
 * @brief API declaration for MyGatewayTransport
 *
@@ -85,11 +103,35 @@
 #define GATEWAY_DEBUG(x,...)									//!< debug NULL
 #endif
 
+#if defined(MY_GATEWAY_TX_SCHEDULER_FEATURE)
+/**
+ * @brief Outbound queue of one priority class
+ */
+typedef struct {
+	MyMessage msg[MY_GATEWAY_TX_QUEUE_SIZE];	//!< queued messages
+	uint8_t head;								//!< index of oldest message
+	uint8_t count;								//!< number of queued messages
+} gatewayTxQueue_t;
+#endif
+
 /**
  * @brief Process gateway-related messages
  */
 void gatewayTransportProcess(void);
 
+/**
+ * @brief Number of messages waiting in the outbound queues (only with
+ * @ref MY_GATEWAY_TX_SCHEDULER_FEATURE)
+ * @return queued messages
+ */
+uint8_t gatewayTransportTxPending(void);
+
+/**
+ * @brief Process a message received from controller, i.e. handle it or hand it over to the
+ *        sensor network
+ */
+void gatewayTransportProcessMessage(void);
+
 /**
  * @brief Initialize gateway transport driver
  * @return true if transport initialized
@@ -103,6 +145,27 @@ bool gatewayTransportInit(void);
  */
 bool gatewayTransportSend(MyMessage &message);
 
+/**
+ * @brief Answer the controller the last message was received from
+ *
+ * Transports serving several controllers at once send only to that one, others broadcast
+ * like gatewayTransportSend().
+ * @param message to send
+ * @return true if message delivered
+ */
+bool gatewayTransportReply(MyMessage &message);
+
+/**
+ * @brief Hand over a sensor reading or a message from the network to the controller
+ *
+ * If the platform has an outbound journal (MY_HW_HAS_JOURNAL), messages the controller cannot
+ * take are kept in the journal and replayed in order by gatewayTransportProcess() on reconnect.
+ * If the platform keeps a sensor history (MY_HW_HAS_SERIES), numeric readings are added to it.
+ * @param message to send
+ * @return true if message delivered, false if it was not delivered (yet)
+ */
+bool gatewayTransportDeliver(MyMessage &message);
+
 /**
  * @brief Check if a new message is available from controller
  * @return true if message available
@@ -115,6 +178,13 @@ bool gatewayTransportAvailable(void);
  */
 MyMessage& gatewayTransportReceive(void);
 
+#if defined(MY_GATEWAY_LINUX) && defined(MY_USE_UDP) && !defined(MY_GATEWAY_CLIENT_MODE)
+/**
+ * @brief Send the messages queued for the controllers during this loop
+ */
+void gatewayTransportFlush(void);
+#endif
+
 #endif /* MyGatewayTransportEthernet_h */
 
 /** @}*/
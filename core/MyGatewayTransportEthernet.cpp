@@ -99,6 +99,9 @@ typedef struct {
 #if defined(MY_USE_UDP)
 EthernetUDP _ethernetServer;
 #endif /* End of MY_USE_UDP */
+#elif defined(MY_GATEWAY_LINUX) && defined(MY_USE_UDP) /* Elif part of MY_GATEWAY_CLIENT_MODE */
+EthernetUDPServer _ethernetServer(_ethernetGatewayPort, MY_GATEWAY_MAX_CLIENTS,
+                                  MY_UDP_CONTROLLER_TIMEOUT_MS);
 #elif defined(MY_GATEWAY_LINUX) /* Elif part of MY_GATEWAY_CLIENT_MODE */
 EthernetServer _ethernetServer(_ethernetGatewayPort, MY_GATEWAY_MAX_CLIENTS);
 #else /* Else part of MY_GATEWAY_CLIENT_MODE */
@@ -112,10 +115,17 @@ static inputBuffer inputString;
 #else
 static EthernetClient client = EthernetClient();
 #endif /* End of MY_USE_UDP */
-#elif defined(MY_GATEWAY_ESP8266) || defined(MY_GATEWAY_ESP32) || defined(MY_GATEWAY_LINUX)
+#elif defined(MY_GATEWAY_LINUX) && defined(MY_USE_UDP)
+static inputBuffer inputString;
+#elif defined(MY_GATEWAY_LINUX)
+static EthernetClient clients[MY_GATEWAY_MAX_CLIENTS];
+static inputBuffer inputString[MY_GATEWAY_MAX_CLIENTS];
+static uint8_t replyClient = 0;	// client the last message came from
+#elif defined(MY_GATEWAY_ESP8266) || defined(MY_GATEWAY_ESP32)
 static EthernetClient clients[MY_GATEWAY_MAX_CLIENTS];
 static bool clientsConnected[MY_GATEWAY_MAX_CLIENTS];
 static inputBuffer inputString[MY_GATEWAY_MAX_CLIENTS];
+static uint8_t replyClient = 0;	// client the last message came from
 #else /* Else part of MY_GATEWAY_CLIENT_MODE */
 static EthernetClient client = EthernetClient();
 static inputBuffer inputString;
@@ -247,6 +257,7 @@ bool gatewayTransportInit(void)
 
 bool gatewayTransportSend(MyMessage &message)
 {
+	MY_TRACE_MSG(gw__send, message, 0);
 	int nbytes = 0;
 	char *_ethernetMsg = protocolMyMessage2Serial(message);
 
@@ -293,6 +304,10 @@ bool gatewayTransportSend(MyMessage &message)
 			nbytes += clients[i].write((uint8_t *)_ethernetMsg, strlen(_ethernetMsg));
 		}
 	}
+#elif defined(MY_GATEWAY_LINUX) && !defined(MY_USE_UDP)
+	// only to the clients subscribed to this message
+	nbytes = _ethernetServer.write(_ethernetMsg, strlen(_ethernetMsg), message.sender, message.sensor,
+	                               mGetCommand(message), message.type);
 #else /* Else part of MY_GATEWAY_ESPxx*/
 	nbytes = _ethernetServer.write(_ethernetMsg);
 #endif /* End of MY_GATEWAY_ESPxx */
@@ -301,6 +316,25 @@ bool gatewayTransportSend(MyMessage &message)
 	return (nbytes > 0);
 }
 
+bool gatewayTransportReply(MyMessage &message)
+{
+#if (defined(MY_GATEWAY_ESP8266) || defined(MY_GATEWAY_ESP32) || defined(MY_GATEWAY_LINUX)) && !defined(MY_GATEWAY_CLIENT_MODE) && !defined(MY_USE_UDP)
+	MY_TRACE_MSG(gw__send, message, 0);
+	char *_ethernetMsg = protocolMyMessage2Serial(message);
+
+	setIndication(INDICATION_GW_TX);
+#if defined(MY_GATEWAY_LINUX)
+	return _ethernetServer.write(clients[replyClient], _ethernetMsg, strlen(_ethernetMsg)) > 0;
+#else
+	return clients[replyClient].connected() &&
+	       clients[replyClient].write((uint8_t *)_ethernetMsg, strlen(_ethernetMsg)) > 0;
+#endif
+#else
+	// a single controller is connected
+	return gatewayTransportSend(message);
+#endif
+}
+
 #if defined(MY_USE_UDP)
 // Nothing to do here
 #else
@@ -316,6 +350,11 @@ bool _readFromClient(uint8_t i)
 				inputString[i].string[inputString[i].idx] = 0;
 				GATEWAY_DEBUG(PSTR("GWT:RFC:C=%" PRIu8 ",MSG=%s\n"), i, inputString[i].string);
 				inputString[i].idx = 0;
+#if defined(MY_GATEWAY_LINUX)
+				if (_ethernetServer.subscribe(clients[i], inputString[i].string)) {
+					continue;
+				}
+#endif
 				if (protocolSerial2MyMessage(_ethernetMsg, inputString[i].string)) {
 					return true;
 				}
@@ -415,7 +454,69 @@ bool gatewayTransportAvailable(void)
 	}
 #endif /* End of MY_USE_UDP */
 #else /* Else part of MY_GATEWAY_CLIENT_MODE */
-#if defined(MY_GATEWAY_ESP8266) || defined(MY_GATEWAY_ESP32) || defined(MY_GATEWAY_LINUX)
+#if defined(MY_GATEWAY_LINUX) && defined(MY_USE_UDP)
+	const int length = _ethernetServer.read(inputString.string, MY_GATEWAY_MAX_RECEIVE_LENGTH);
+	if (length > 0) {
+		GATEWAY_DEBUG(PSTR("GWT:TSA:UDP MSG=%s\n"), inputString.string);
+		const bool ok = protocolSerial2MyMessage(_ethernetMsg, inputString.string);
+		if (ok) {
+			// only a valid message registers its sender as controller
+			_ethernetServer.registerSender();
+			if (_ethernetServer.hasNewController()) {
+				// greet it like a connecting TCP client
+				GATEWAY_DEBUG(PSTR("GWT:TSA:UDP CONTROLLER\n"));
+				gatewayTransportSend(buildGw(_msgTmp, I_GATEWAY_READY).set(MSG_GW_STARTUP_COMPLETE));
+				presentNode();
+			}
+			setIndication(INDICATION_GW_RX);
+		}
+		return ok;
+	}
+#elif defined(MY_GATEWAY_LINUX)
+	// Only sockets with pending events are looked at: accept new clients, then read from or
+	// stop those with data or a hang up
+	if (_ethernetServer.hasClient()) {
+		EthernetClient newClient;
+		while ((newClient = _ethernetServer.available())) {
+			uint8_t i = 0;
+			while (i < ARRAY_SIZE(clients) && clients[i]) {
+				i++;
+			}
+			if (i == ARRAY_SIZE(clients)) {
+				GATEWAY_DEBUG(PSTR("!GWT:TSA:NO FREE SLOT\n"));
+				newClient.stop();
+				continue;
+			}
+			clients[i] = newClient;
+			inputString[i].idx = 0;
+			GATEWAY_DEBUG(PSTR("GWT:TSA:C=%" PRIu8 ",CONNECTED\n"), i);
+			gatewayTransportSend(buildGw(_msgTmp, I_GATEWAY_READY).set(MSG_GW_STARTUP_COMPLETE));
+			// Send presentation of locally attached sensors (and node if applicable)
+			presentNode();
+		}
+	}
+	int sock;
+	while ((sock = _ethernetServer.readable()) != -1) {
+		uint8_t i = 0;
+		while (i < ARRAY_SIZE(clients) && clients[i].getSocketNumber() != sock) {
+			i++;
+		}
+		if (i == ARRAY_SIZE(clients)) {
+			continue;
+		}
+		if (_readFromClient(i)) {
+			// more data is reported again by the next poll
+			replyClient = i;
+			setIndication(INDICATION_GW_RX);
+			_w5100_spi_en(false);
+			return true;
+		}
+		if (!clients[i].connected()) {
+			GATEWAY_DEBUG(PSTR("GWT:TSA:C=%" PRIu8 ",DISCONNECTED\n"), i);
+			clients[i].stop();
+		}
+	}
+#elif defined(MY_GATEWAY_ESP8266) || defined(MY_GATEWAY_ESP32)
 	// ESP8266/ESP32: Go over list of clients and stop any that are no longer connected.
 	// If the server has a new client connection it will be assigned to a free slot.
 	bool allSlotsOccupied = true;
@@ -448,6 +549,7 @@ bool gatewayTransportAvailable(void)
 	// Loop over clients connect and read available data
 	for (uint8_t i = 0; i < ARRAY_SIZE(clients); i++) {
 		if (_readFromClient(i)) {
+			replyClient = i;
 			setIndication(INDICATION_GW_RX);
 			_w5100_spi_en(false);
 			return true;
@@ -489,7 +591,15 @@ bool gatewayTransportAvailable(void)
 MyMessage& gatewayTransportReceive(void)
 {
 	// Return the last parsed message
+	MY_TRACE_MSG(gw__receive, _ethernetMsg, 0);
 	return _ethernetMsg;
 }
 
+#if defined(MY_GATEWAY_LINUX) && defined(MY_USE_UDP) && !defined(MY_GATEWAY_CLIENT_MODE)
+void gatewayTransportFlush(void)
+{
+	_ethernetServer.flush();
+}
+#endif
+
 
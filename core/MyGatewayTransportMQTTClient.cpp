@@ -112,6 +112,7 @@ static MyMessage _MQTT_msg;
 
 bool gatewayTransportSend(MyMessage &message)
 {
+	MY_TRACE_MSG(gw__send, message, 0);
 	if (!_MQTT_client.connected()) {
 		return false;
 	}
@@ -127,6 +128,12 @@ bool gatewayTransportSend(MyMessage &message)
 	return _MQTT_client.publish(topic, message.getString(_convBuffer), retain);
 }
 
+bool gatewayTransportReply(MyMessage &message)
+{
+	// a single controller is connected
+	return gatewayTransportSend(message);
+}
+
 void incomingMQTT(char *topic, uint8_t *payload, unsigned int length)
 {
 	GATEWAY_DEBUG(PSTR("GWT:IMQ:TOPIC=%s, MSG RECEIVED\n"), topic);
@@ -294,5 +301,6 @@ MyMessage & gatewayTransportReceive(void)
 {
 	// Return the last parsed message
 	_MQTT_available = false;
+	MY_TRACE_MSG(gw__receive, _MQTT_msg, 0);
 	return _MQTT_msg;
 }
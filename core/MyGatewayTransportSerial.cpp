@@ -32,12 +32,19 @@ MyMessage _serialMsg;
 
 bool gatewayTransportSend(MyMessage &message)
 {
+	MY_TRACE_MSG(gw__send, message, 0);
 	setIndication(INDICATION_GW_TX);
 	MY_SERIALDEVICE.print(protocolMyMessage2Serial(message));
 	// Serial print is always successful
 	return true;
 }
 
+bool gatewayTransportReply(MyMessage &message)
+{
+	// a single controller is connected
+	return gatewayTransportSend(message);
+}
+
 bool gatewayTransportInit(void)
 {
 	(void)gatewayTransportSend(buildGw(_msgTmp, I_GATEWAY_READY).set(MSG_GW_STARTUP_COMPLETE));
@@ -78,5 +85,6 @@ bool gatewayTransportAvailable(void)
 MyMessage & gatewayTransportReceive(void)
 {
 	// Return the last parsed message
+	MY_TRACE_MSG(gw__receive, _serialMsg, 0);
 	return _serialMsg;
 }
@@ -0,0 +1,151 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "MyIdAllocator.h"
+
+// global variables
+extern MyMessage _msgTmp;
+
+#define ID_LEASE_DAY_MS			(86400000ul)
+
+static uint16_t _idLeaseSeen[MY_ID_LEASE_COUNT];	//!< copy of the seen days in EEPROM
+static uint16_t _idLeaseDay;						//!< days of gateway uptime, persistent
+static uint32_t _idLeaseDayStart;					//!< hwMillis() the current day started
+
+static void idAllocatorWrite(const uint8_t lease, const uint32_t token)
+{
+	idLease_t entry;
+	entry.token = token;
+	entry.seen = _idLeaseDay;
+	hwWriteConfigBlock((void *)&entry, (void *)(EEPROM_ID_LEASE_TABLE_ADDRESS + lease * sizeof(
+	                       idLease_t)), sizeof(idLease_t));
+	_idLeaseSeen[lease] = _idLeaseDay;
+}
+
+static uint32_t idAllocatorToken(const uint8_t lease)
+{
+	uint32_t token;
+	hwReadConfigBlock((void *)&token, (void *)(EEPROM_ID_LEASE_TABLE_ADDRESS + lease * sizeof(
+	                      idLease_t)), sizeof(token));
+	return token;
+}
+
+void idAllocatorInit(void)
+{
+	hwReadConfigBlock((void *)&_idLeaseDay, (void *)EEPROM_ID_LEASE_DAY_ADDRESS, sizeof(_idLeaseDay));
+	if (_idLeaseDay == ID_LEASE_FREE) {
+		// erased EEPROM, start counting
+		_idLeaseDay = 0;
+		hwWriteConfigBlock((void *)&_idLeaseDay, (void *)EEPROM_ID_LEASE_DAY_ADDRESS,
+		                   sizeof(_idLeaseDay));
+	}
+	for (uint8_t lease = 0; lease < MY_ID_LEASE_COUNT; lease++) {
+		hwReadConfigBlock((void *)&_idLeaseSeen[lease],
+		                  (void *)(EEPROM_ID_LEASE_TABLE_ADDRESS + lease * sizeof(idLease_t) + sizeof(uint32_t)),
+		                  sizeof(uint16_t));
+	}
+	_idLeaseDayStart = hwMillis();
+}
+
+void idAllocatorProcess(void)
+{
+	if (hwMillis() - _idLeaseDayStart >= ID_LEASE_DAY_MS) {
+		_idLeaseDayStart += ID_LEASE_DAY_MS;
+		_idLeaseDay++;
+		if (_idLeaseDay == ID_LEASE_FREE) {
+			_idLeaseDay = 0;
+		}
+		hwWriteConfigBlock((void *)&_idLeaseDay, (void *)EEPROM_ID_LEASE_DAY_ADDRESS,
+		                   sizeof(_idLeaseDay));
+	}
+}
+
+void idAllocatorSeen(const uint8_t nodeId)
+{
+	if (nodeId < MY_ID_LEASE_FIRST || nodeId >= MY_ID_LEASE_FIRST + MY_ID_LEASE_COUNT) {
+		return;
+	}
+	const uint8_t lease = nodeId - MY_ID_LEASE_FIRST;
+	if (_idLeaseSeen[lease] == _idLeaseDay) {
+		// at most one EEPROM write per node and day
+		return;
+	}
+	if (_idLeaseSeen[lease] == ID_LEASE_FREE) {
+		// ID given out by the controller, keep it
+		GATEWAY_DEBUG(PSTR("GWT:IDA:ADOPT,ID=%" PRIu8 "\n"), nodeId);
+		idAllocatorWrite(lease, 0);
+	} else {
+		idAllocatorWrite(lease, idAllocatorToken(lease));
+	}
+}
+
+bool idAllocatorRequest(const MyMessage &request)
+{
+	const uint32_t token = (mGetPayloadType(request) == P_ULONG32) ? request.getULong() : 0;
+	if (!token) {
+		// a retry could not be told from a new node, every request would take another lease
+		return false;
+	}
+	uint8_t found = MY_ID_LEASE_COUNT;
+
+	// known node, e.g. after its EEPROM was cleared or retrying its request
+	for (uint8_t lease = 0; lease < MY_ID_LEASE_COUNT && found == MY_ID_LEASE_COUNT; lease++) {
+		if (_idLeaseSeen[lease] != ID_LEASE_FREE && idAllocatorToken(lease) == token) {
+			found = lease;
+		}
+	}
+	for (uint8_t lease = 0; lease < MY_ID_LEASE_COUNT && found == MY_ID_LEASE_COUNT; lease++) {
+		if (_idLeaseSeen[lease] == ID_LEASE_FREE) {
+#if defined(MY_REPEATER_FEATURE)
+			if (transportGetRoute(MY_ID_LEASE_FIRST + lease) != BROADCAST_ADDRESS) {
+				// routed but never heard since the table exists, do not hand it out
+				continue;
+			}
+#endif
+			found = lease;
+		}
+	}
+	if (found == MY_ID_LEASE_COUNT) {
+		// reclaim the lease not heard from for the longest time, if expired
+		uint16_t oldest = MY_ID_LEASE_EXPIRY_DAYS - 1;
+		for (uint8_t lease = 0; lease < MY_ID_LEASE_COUNT; lease++) {
+			const uint16_t age = _idLeaseDay - _idLeaseSeen[lease];
+			if (_idLeaseSeen[lease] != ID_LEASE_FREE && age > oldest) {
+				oldest = age;
+				found = lease;
+			}
+		}
+	}
+	if (found == MY_ID_LEASE_COUNT) {
+		GATEWAY_DEBUG(PSTR("!GWT:IDA:FULL\n"));
+		return false;
+	}
+
+	const uint8_t nodeId = MY_ID_LEASE_FIRST + found;
+	idAllocatorWrite(found, token);
+	GATEWAY_DEBUG(PSTR("GWT:IDA:ID=%" PRIu8 ",TK=%08" PRIX32 "\n"), nodeId, token);
+	// the node waits for a response to AUTO carrying its request token as sensor id
+	(void)transportRouteMessage(build(_msgTmp, AUTO, request.sensor, C_INTERNAL,
+	                                  I_ID_RESPONSE).set(nodeId));
+	// let the controller know, journaled on Linux if it is not connected
+	char info[MAX_PAYLOAD + 1];
+	(void)snprintf_P(info, sizeof(info), PSTR("IDA:ID=%" PRIu8 ",TK=%08" PRIX32), nodeId, token);
+	(void)gatewayTransportDeliver(buildGw(_msgTmp, I_LOG_MESSAGE).set(info));
+	return true;
+}
@@ -0,0 +1,70 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+/**
+* @file MyIdAllocator.h
+*
+* @brief Gateway side node ID allocation
+*
+* With @ref MY_GATEWAY_ID_ALLOCATION_FEATURE the gateway answers I_ID_REQUEST itself. IDs are
+* leased from the range @ref MY_ID_LEASE_FIRST .. @ref MY_ID_LEASE_FIRST + @ref MY_ID_LEASE_COUNT - 1,
+* the lease table in EEPROM maps each ID to the hardware token of its node and the day it was
+* last heard. Days count gateway uptime. Only requests carrying a token are answered, nodes send
+* one with @ref MY_ID_REQUEST_TOKEN_FEATURE. A node asking again with the same token gets its
+* old ID back, a lease not heard for @ref MY_ID_LEASE_EXPIRY_DAYS may be reclaimed if no ID is
+* free. The controller is told about every allocation with a log message "IDA:ID=<id>,TK=<token>".
+* Requests without token, or if no lease can be given, are handed over to the controller as before.
+*/
+
+#ifndef MyIdAllocator_h
+#define MyIdAllocator_h
+
+#include "MySensorsCore.h"
+
+#define ID_LEASE_FREE			(0xFFFFu)	//!< seen day of an unused lease, erased EEPROM
+
+/**
+ * @brief Lease table entry, as stored in EEPROM
+ */
+typedef struct {
+	uint32_t token;							//!< hardware token of the node, 0 if unknown
+	uint16_t seen;							//!< day the node was last heard, ID_LEASE_FREE if unused
+} __attribute__((packed)) idLease_t;
+
+/**
+ * @brief Load the lease table
+ */
+void idAllocatorInit(void);
+/**
+ * @brief Advance the day counter
+ */
+void idAllocatorProcess(void);
+/**
+ * @brief Note that a node was heard, IDs in the lease range without lease are adopted
+ * @param nodeId of the node
+ */
+void idAllocatorSeen(const uint8_t nodeId);
+/**
+ * @brief Answer an I_ID_REQUEST
+ * @param request received from the node
+ * @return true if answered, false if the controller has to answer it
+ */
+bool idAllocatorRequest(const MyMessage &request);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "MyLinkHealth.h"
+
+// global variables
+extern MyMessage _msgTmp;
+
+static linkHealth_t _linkHealth[BROADCAST_ADDRESS];	//!< indexed by node ID
+
+void linkHealthReport(const MyMessage &message)
+{
+	const uint8_t nodeId = message.sender;
+	if (nodeId == GATEWAY_ADDRESS || nodeId >= BROADCAST_ADDRESS) {
+		return;
+	}
+	transportStats_t stats;
+	if (mGetLength(message) != sizeof(stats)) {
+		GATEWAY_DEBUG(PSTR("!GWT:LNK:ID=%" PRIu8 ",INVALID\n"), nodeId);
+		return;
+	}
+	(void)memcpy((void *)&stats, message.getCustom(), sizeof(stats));
+	if (stats.version != TRANSPORT_STATS_VERSION) {
+		GATEWAY_DEBUG(PSTR("!GWT:LNK:ID=%" PRIu8 ",INVALID\n"), nodeId);
+		return;
+	}
+	linkHealth_t &health = _linkHealth[nodeId];
+	if (!health.reported || !stats.sequence) {
+		// first report or node restarted, counters start from here
+		health.txAttempts = 0;
+		health.txFailures = 0;
+		health.failureSeconds = 0;
+		health.parentChanges = 0;
+		if (!health.reported) {
+			health.quality = LINK_HEALTH_UNKNOWN;
+			health.reported = true;
+		}
+	}
+	const uint16_t txAttempts = stats.txAttempts - health.txAttempts;
+	const uint16_t txFailures = stats.txFailures - health.txFailures;
+	const uint16_t failureSeconds = stats.failureSeconds - health.failureSeconds;
+	const uint8_t parentChanges = stats.parentChanges - health.parentChanges;
+	if (txAttempts && txFailures <= txAttempts) {
+		const uint8_t rate = (uint8_t)(((uint32_t)(txAttempts - txFailures) * 100u) / txAttempts);
+		if (health.quality == LINK_HEALTH_UNKNOWN) {
+			health.quality = rate;
+		} else {
+			health.quality = (uint8_t)(((uint16_t)health.quality * 3u + rate) / 4u);
+		}
+	}
+	health.txAttempts = stats.txAttempts;
+	health.txFailures = stats.txFailures;
+	health.failureSeconds = stats.failureSeconds;
+	health.parentChanges = stats.parentChanges;
+
+	GATEWAY_DEBUG(PSTR("GWT:LNK:ID=%" PRIu8 ",Q=%" PRIu8 ",TX=%" PRIu16 ",F=%" PRIu16 "\n"), nodeId,
+	              health.quality, txAttempts, txFailures);
+	if (health.quality == LINK_HEALTH_UNKNOWN) {
+		return;	// no traffic between two reports yet
+	}
+	char info[MAX_PAYLOAD + 1];
+	(void)snprintf_P(info, sizeof(info), PSTR("LNK:%" PRIu8 ",Q%" PRIu8 ",P%" PRIu8 ",F%" PRIu16), nodeId,
+	                 health.quality, parentChanges, failureSeconds);
+	(void)gatewayTransportDeliver(buildGw(_msgTmp, I_LOG_MESSAGE).set(info));
+}
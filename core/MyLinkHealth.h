@@ -0,0 +1,63 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+/**
+* @file MyLinkHealth.h
+*
+* @brief Gateway side link health of nodes
+*
+* With @ref MY_GATEWAY_LINK_HEALTH_FEATURE the gateway keeps the last statistics report
+* (@ref transportStats_t) of every node and turns the difference to the next one into link
+* health metrics. Counters of a node wrap, differences stay valid as long as fewer than 65536
+* frames are sent between two reports. A report with sequence 0 follows a restart of the node
+* and only sets the baseline of the counters.
+*
+* The controller gets a log message "LNK:<id>,Q<q>,P<p>,F<f>" for every report:
+* - q: TX success rate in %, averaged over reports with traffic
+* - p: parent changes since the previous report
+* - f: seconds spent in failure state since the previous report
+*/
+
+#ifndef MyLinkHealth_h
+#define MyLinkHealth_h
+
+#include "MySensorsCore.h"
+
+#define LINK_HEALTH_UNKNOWN		(0xFFu)	//!< quality of a node without traffic yet
+
+/**
+ * @brief Link health of a node
+ */
+typedef struct {
+	uint16_t txAttempts;		//!< counter of the last report
+	uint16_t txFailures;		//!< counter of the last report
+	uint16_t failureSeconds;	//!< counter of the last report
+	uint8_t parentChanges;		//!< counter of the last report
+	uint8_t quality;			//!< averaged TX success rate in %, LINK_HEALTH_UNKNOWN if not known
+	bool reported : 1;			//!< flag a report was received
+	uint8_t reserved : 7;		//!< reserved
+} linkHealth_t;
+
+/**
+ * @brief Update the link health of a node from its statistics report
+ * @param message I_TRANSPORT_STATS received from the node
+ */
+void linkHealthReport(const MyMessage &message);
+
+#endif
@@ -209,7 +209,7 @@ MyMessage& MyMessage::setSensor(const uint8_t _sensor)
 	return *this;
 }
 
-MyMessage& MyMessage::setDestination(const uint8_t _destination)
+MyMessage& MyMessage::setDestination(const nodeId_t _destination)
 {
 	destination = _destination;
 	return *this;
@@ -311,3 +311,58 @@ MyMessage& MyMessage::set(const int16_t value)
 	iValue = value;
 	return *this;
 }
+
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+uint8_t MyMessage::getFrame(uint8_t *frame, const bool extended) const
+{
+	const bool version3 = extended || last > 0xFFu || sender > 0xFFu || destination > 0xFFu;
+	const uint8_t headerSize = version3 ? HEADER_SIZE + HEADER_EXTENSION_SIZE : HEADER_SIZE;
+	// signed messages carry the signature behind the payload
+	const uint8_t payloadLength = miGetSigned() ? MAX_PAYLOAD : miGetLength();
+	if (headerSize + payloadLength > MAX_MESSAGE_LENGTH) {
+		return 0;
+	}
+	frame[0] = (uint8_t)last;
+	frame[1] = (uint8_t)sender;
+	frame[2] = (uint8_t)destination;
+	frame[3] = version_length;
+	BF_SET(frame[3], version3 ? PROTOCOL_VERSION_EXTENDED : PROTOCOL_VERSION, 0, 2);
+	frame[4] = command_ack_payload;
+	frame[5] = type;
+	frame[6] = sensor;
+	if (version3) {
+		frame[7] = (uint8_t)(last >> 8);
+		frame[8] = (uint8_t)(sender >> 8);
+		frame[9] = (uint8_t)(destination >> 8);
+	}
+	(void)memcpy(&frame[headerSize], data, payloadLength);
+	return headerSize + payloadLength;
+}
+
+uint8_t MyMessage::setFrame(const uint8_t *frame, const uint8_t length)
+{
+	if (length < HEADER_SIZE) {
+		return 0;
+	}
+	last = frame[0];
+	sender = frame[1];
+	destination = frame[2];
+	version_length = frame[3];
+	command_ack_payload = frame[4];
+	type = frame[5];
+	sensor = frame[6];
+	uint8_t headerSize = HEADER_SIZE;
+	if (miGetVersion() == PROTOCOL_VERSION_EXTENDED) {
+		if (length < HEADER_SIZE + HEADER_EXTENSION_SIZE) {
+			return 0;
+		}
+		last |= (nodeId_t)frame[7] << 8;
+		sender |= (nodeId_t)frame[8] << 8;
+		destination |= (nodeId_t)frame[9] << 8;
+		headerSize += HEADER_EXTENSION_SIZE;
+	}
+	const uint8_t payloadLength = min((uint8_t)(length - headerSize), (uint8_t)MAX_PAYLOAD);
+	(void)memcpy(data, &frame[headerSize], payloadLength);
+	return HEADER_SIZE + payloadLength;
+}
+#endif
@@ -37,9 +37,25 @@
 #endif
 
 #define PROTOCOL_VERSION	(2u)	//!< The version of the protocol
+#define PROTOCOL_VERSION_EXTENDED	(3u)	//!< The version of frames with an extended header
 #define MAX_MESSAGE_LENGTH	(32u)	//!< The maximum size of a message (including header)
 #define HEADER_SIZE			(7u)	//!< The size of the header
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+#define HEADER_EXTENSION_SIZE	(3u)	//!< High bytes of last, sender and destination, follow the header in version 3 frames
+typedef uint16_t nodeId_t;			//!< Node ID, 16 bit with extended addresses
+#define PRIuNodeId PRIu16			//!< printf format of a node ID
+#else
+#define HEADER_EXTENSION_SIZE	(0u)	//!< No header extension
+typedef uint8_t nodeId_t;			//!< Node ID
+#define PRIuNodeId PRIu8			//!< printf format of a node ID
+#endif
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+#define AEAD_TRAILER_SIZE	(8u)	//!< Frame counter and tag appended to every frame
+#define MAX_PAYLOAD (MAX_MESSAGE_LENGTH - HEADER_SIZE - AEAD_TRAILER_SIZE) //!< The maximum size of a payload depends on #MAX_MESSAGE_LENGTH, #HEADER_SIZE and #AEAD_TRAILER_SIZE
+#else
 #define MAX_PAYLOAD (MAX_MESSAGE_LENGTH - HEADER_SIZE) //!< The maximum size of a payload depends on #MAX_MESSAGE_LENGTH and #HEADER_SIZE
+#endif
+#define MAX_PAYLOAD_EXTENDED (MAX_PAYLOAD - HEADER_EXTENSION_SIZE) //!< The maximum size of a payload in a version 3 frame
 
 /// @brief The command field (message-type) defines the overall properties of a message
 typedef enum {
@@ -197,7 +213,9 @@ typedef enum {
 	I_SIGNAL_REPORT_REVERSE		= 30,	//!< Internal
 	I_SIGNAL_REPORT_RESPONSE	= 31,	//!< Device signal strength response (RSSI)
 	I_PRE_SLEEP_NOTIFICATION	= 32,	//!< Message sent before node is going to sleep
-	I_POST_SLEEP_NOTIFICATION	= 33	//!< Message sent after node woke up (if enabled)
+	I_POST_SLEEP_NOTIFICATION	= 33,	//!< Message sent after node woke up (if enabled)
+	I_TRANSPORT_STATS			= 34,	//!< Link statistics of a node (packed transportStats_t, if enabled)
+	I_SERIES_QUERY				= 35	//!< Query of the sensor history kept by the Linux gateway, and its answer
 } mysensors_internal_t;
 
 
@@ -269,6 +287,8 @@ typedef enum {
 #define miSetVersion(_version) BF_SET(version_length, _version, 0, 2) //!< Internal setter for version field
 #define miGetVersion() ((uint8_t)BF_GET(version_length, 0, 2)) //!< Internal getter for version field
 
+#define miGetSigned() ((bool)BF_GET(version_length, 2, 1)) //!< Internal getter for signed field
+
 #define miSetRequestAck(_rack) BF_SET(command_ack_payload, _rack, 3, 1) //!< Internal setter for ack-request field
 #define miGetRequestAck() ((bool)BF_GET(command_ack_payload, 3, 1)) //!< Internal getter for ack-request field
 
@@ -401,7 +421,7 @@ public:
 	 * @brief Set final destination node id for this message
 	 * @param destination
 	 */
-	MyMessage& setDestination(const uint8_t destination);
+	MyMessage& setDestination(const nodeId_t destination);
 
 	/**
 	 * @brief Set entire payload
@@ -466,15 +486,36 @@ public:
 	 */
 	MyMessage& set(const int16_t value);
 
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	/**
+	 * @brief Write the message as radio frame
+	 *
+	 * A version 3 frame is written if @p extended is set or a node ID does not fit 8 bits,
+	 * otherwise a version 2 frame.
+	 * @param frame buffer of at least #MAX_MESSAGE_LENGTH bytes
+	 * @param extended write a version 3 frame
+	 * @return frame length, 0 if the payload does not fit a version 3 frame
+	 */
+	uint8_t getFrame(uint8_t *frame, const bool extended) const;
+
+	/**
+	 * @brief Read the message from a version 2 or version 3 radio frame
+	 * @param frame received frame
+	 * @param length of the frame
+	 * @return length of the frame without header extension, 0 if it is too short
+	 */
+	uint8_t setFrame(const uint8_t *frame, const uint8_t length);
+#endif
+
 #else
 
 typedef union {
 	struct {
 
 #endif
-	uint8_t last;							//!< 8 bit - Id of last node this message passed
-	uint8_t sender;						//!< 8 bit - Id of sender node (origin)
-	uint8_t destination;			//!< 8 bit - Id of destination node
+	nodeId_t last;						//!< 8 bit (16 bit extended) - Id of last node this message passed
+	nodeId_t sender;					//!< 8 bit (16 bit extended) - Id of sender node (origin)
+	nodeId_t destination;				//!< 8 bit (16 bit extended) - Id of destination node
 
 	/**
 	 * 2 bit - Protocol version<br>
@@ -519,7 +560,7 @@ typedef union {
 } __attribute__((packed));
 #else
 };
-uint8_t array[HEADER_SIZE + MAX_PAYLOAD + 1]; //!< buffer for entire message
+uint8_t array[HEADER_SIZE + HEADER_EXTENSION_SIZE + MAX_PAYLOAD + 1]; //!< buffer for entire message
 } __attribute__((packed)) MyMessage;
 #endif
 
@@ -0,0 +1,158 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "MyNodeLiveness.h"
+
+// global variables
+extern MyMessage _msgTmp;
+
+#if MY_LIVENESS_WHEEL_SLOTS > 256
+#error MY_LIVENESS_WHEEL_SLOTS > 256
+#endif
+
+#define LIVENESS_BURST_TICKS	(2u)	//!< shorter gaps belong to the same report
+
+#if MY_LIVENESS_INTERVAL_S == 0
+// longer intervals are followed by at most doubling per report
+static uint16_t livenessGrow(const uint16_t interval, const uint32_t gap)
+{
+	const uint16_t step = (uint16_t)min(gap - interval, (uint32_t)interval);
+	return (interval > 0xFFFFu - step) ? 0xFFFFu : interval + step;
+}
+#endif
+
+static livenessTimer_t _livenessTimers[BROADCAST_ADDRESS];	//!< indexed by node ID
+static uint8_t _livenessWheel[MY_LIVENESS_WHEEL_SLOTS];		//!< first node of every slot
+static uint8_t _livenessCursor;								//!< slot of the current tick
+static uint32_t _livenessTick;								//!< ticks since start, wraps after 136 years
+static uint32_t _livenessTickStart;							//!< hwMillis() the current tick started
+
+static void livenessUnlink(const uint8_t nodeId)
+{
+	livenessTimer_t &timer = _livenessTimers[nodeId];
+	if (timer.prev == LIVENESS_NIL) {
+		_livenessWheel[timer.slot] = timer.next;
+	} else {
+		_livenessTimers[timer.prev].next = timer.next;
+	}
+	if (timer.next != LIVENESS_NIL) {
+		_livenessTimers[timer.next].prev = timer.prev;
+	}
+}
+
+static void livenessArm(const uint8_t nodeId)
+{
+	livenessTimer_t &timer = _livenessTimers[nodeId];
+	uint32_t ticks = (uint32_t)timer.interval * MY_LIVENESS_TOLERANCE;
+	if (ticks > 0xFFFFu) {
+		ticks = 0xFFFFu;
+	}
+	timer.slot = (_livenessCursor + ticks) % MY_LIVENESS_WHEEL_SLOTS;
+	timer.rounds = (ticks - 1) / MY_LIVENESS_WHEEL_SLOTS;
+	timer.prev = LIVENESS_NIL;
+	timer.next = _livenessWheel[timer.slot];
+	if (timer.next != LIVENESS_NIL) {
+		_livenessTimers[timer.next].prev = nodeId;
+	}
+	_livenessWheel[timer.slot] = nodeId;
+	timer.state = LIVENESS_ONLINE;
+}
+
+static void livenessReport(const uint8_t nodeId, const bool online)
+{
+	char info[MAX_PAYLOAD + 1];
+	(void)snprintf_P(info, sizeof(info), PSTR("LIV:ID=%" PRIu8 ",%s"), nodeId,
+	                 online ? "ON" : "OFF");
+	(void)gatewayTransportDeliver(buildGw(_msgTmp, I_LOG_MESSAGE).set(info));
+}
+
+void livenessInit(void)
+{
+	(void)memset((void *)_livenessTimers, 0, sizeof(_livenessTimers));
+	(void)memset((void *)_livenessWheel, LIVENESS_NIL, sizeof(_livenessWheel));
+	_livenessCursor = 0;
+	_livenessTick = 0;
+	_livenessTickStart = hwMillis();
+}
+
+void livenessProcess(void)
+{
+	while (hwMillis() - _livenessTickStart >= LIVENESS_TICK_MS) {
+		_livenessTickStart += LIVENESS_TICK_MS;
+		_livenessTick++;
+		_livenessCursor = (_livenessCursor + 1) % MY_LIVENESS_WHEEL_SLOTS;
+		uint8_t nodeId = _livenessWheel[_livenessCursor];
+		while (nodeId != LIVENESS_NIL) {
+			livenessTimer_t &timer = _livenessTimers[nodeId];
+			const uint8_t next = timer.next;
+			if (timer.rounds) {
+				timer.rounds--;
+			} else {
+				livenessUnlink(nodeId);
+				timer.state = LIVENESS_OFFLINE;
+				GATEWAY_DEBUG(PSTR("GWT:LIV:OFF,ID=%" PRIu8 ",I=%" PRIu16 "\n"), nodeId, timer.interval);
+				livenessReport(nodeId, false);
+			}
+			nodeId = next;
+		}
+	}
+}
+
+void livenessSeen(const uint8_t nodeId)
+{
+	if (nodeId == LIVENESS_NIL || nodeId >= BROADCAST_ADDRESS) {
+		return;
+	}
+	livenessTimer_t &timer = _livenessTimers[nodeId];
+	if (timer.state == LIVENESS_ONLINE) {
+		livenessUnlink(nodeId);
+	}
+#if MY_LIVENESS_INTERVAL_S > 0
+	timer.interval = MY_LIVENESS_INTERVAL_S;
+#else
+	const uint32_t gap = _livenessTick - timer.heard;
+	if (timer.state == LIVENESS_OFFLINE) {
+		// the gap is the outage, not the interval. Offline again before a regular report means
+		// the node reports slower than learned, longer than the tolerance can cover
+		if (timer.returned) {
+			timer.interval = livenessGrow(timer.interval, 0xFFFFu);
+		}
+		timer.returned = true;
+	} else if (timer.state != LIVENESS_UNKNOWN && gap >= LIVENESS_BURST_TICKS) {
+		if (!timer.interval) {
+			timer.interval = (uint16_t)min(gap, (uint32_t)0xFFFFu);
+		} else if (gap > timer.interval) {
+			timer.interval = livenessGrow(timer.interval, gap);
+		} else {
+			timer.interval -= (timer.interval - gap) / 8;
+		}
+		timer.returned = false;
+	}
+#endif
+	if (timer.state == LIVENESS_OFFLINE) {
+		GATEWAY_DEBUG(PSTR("GWT:LIV:ON,ID=%" PRIu8 ",I=%" PRIu16 "\n"), nodeId, timer.interval);
+		livenessReport(nodeId, true);
+	}
+	timer.heard = _livenessTick;
+	if (timer.interval) {
+		livenessArm(nodeId);
+	} else {
+		timer.state = LIVENESS_LEARNING;
+	}
+}
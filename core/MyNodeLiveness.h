@@ -0,0 +1,82 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+/**
+* @file MyNodeLiveness.h
+*
+* @brief Gateway side node liveness tracking
+*
+* With @ref MY_GATEWAY_LIVENESS_FEATURE every frame received from a node re-arms a timer of
+* @ref MY_LIVENESS_TOLERANCE times its reporting interval. The interval is either
+* @ref MY_LIVENESS_INTERVAL_S or learned from the gaps between reports, a node is tracked once
+* its interval is known. Timers live in a hashed timer wheel of @ref MY_LIVENESS_WHEEL_SLOTS
+* one second slots: re-arming unlinks and links a node in O(1), each tick only visits the
+* timers hashed to the current slot. A learned interval at most doubles per report, the gap that
+* ends an offline period measures the outage and is not learned. Only a node going offline again
+* before its next regular report doubles its interval. When a timer expires the controller gets a log message
+* "LIV:ID=<id>,OFF", the next frame from that node sends "LIV:ID=<id>,ON".
+*/
+
+#ifndef MyNodeLiveness_h
+#define MyNodeLiveness_h
+
+#include "MySensorsCore.h"
+
+#define LIVENESS_NIL			(0u)	//!< end of a wheel slot list, the gateway is not tracked
+#define LIVENESS_TICK_MS		(1000ul)	//!< length of a wheel slot
+
+/**
+ * @brief Liveness state of a node
+ */
+typedef enum {
+	LIVENESS_UNKNOWN,	//!< not heard yet
+	LIVENESS_LEARNING,	//!< heard, interval not known yet
+	LIVENESS_ONLINE,	//!< timer armed
+	LIVENESS_OFFLINE	//!< timer expired, controller told
+} livenessState_t;
+
+/**
+ * @brief Liveness timer of a node
+ */
+typedef struct {
+	uint8_t next;			//!< next node in the same wheel slot
+	uint8_t prev;			//!< previous node in the same wheel slot, LIVENESS_NIL if first
+	uint8_t slot;			//!< wheel slot the timer is in
+	uint8_t state : 7;		//!< livenessState_t
+	bool returned : 1;		//!< back from offline, no regular report since
+	uint16_t rounds;		//!< wheel turns left before the timer expires
+	uint16_t interval;		//!< reporting interval in ticks, 0 if not known yet
+	uint32_t heard;			//!< tick the node was last heard
+} livenessTimer_t;
+
+/**
+ * @brief Start the wheel
+ */
+void livenessInit(void);
+/**
+ * @brief Advance the wheel and report expired timers
+ */
+void livenessProcess(void);
+/**
+ * @brief Note that a frame was received from a node
+ * @param nodeId of the node
+ */
+void livenessSeen(const uint8_t nodeId);
+
+#endif
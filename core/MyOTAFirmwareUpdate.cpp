@@ -49,23 +49,91 @@ LOCAL bool _firmwareUpdateOngoing = false;
 LOCAL uint32_t _firmwareLastRequest;
 LOCAL uint16_t _firmwareBlock;
 LOCAL uint8_t _firmwareRetry;
+LOCAL uint16_t _firmwareCRC;
+LOCAL firmwareCheckpoint_t _firmwareCheckpoint;
+LOCAL bool _firmwareResumePending = false;
+LOCAL uint32_t _firmwareResumeDelay = MY_OTA_RESUME_DELAY;
 LOCAL bool _firmwareResponse(uint16_t block, uint8_t *data);
 
 LOCAL void readFirmwareSettings(void)
 {
 	hwReadConfigBlock((void*)&_nodeFirmwareConfig, (void*)EEPROM_FIRMWARE_TYPE_ADDRESS,
 	                  sizeof(nodeFirmwareConfig_t));
+#if defined(MY_OTA_RESUME_FEATURE)
+	hwReadConfigBlock((void*)&_firmwareCheckpoint, (void*)EEPROM_OTA_CHECKPOINT_ADDRESS,
+	                  sizeof(firmwareCheckpoint_t));
+#endif
+}
+
+LOCAL uint16_t firmwareCRC16(uint16_t crc, const uint8_t data)
+{
+	crc ^= data;
+	for (int8_t j = 0; j < 8; ++j) {
+		if (crc & 1) {
+			crc = (crc >> 1) ^ 0xA001;
+		} else {
+			crc = (crc >> 1);
+		}
+	}
+	return crc;
+}
+
+LOCAL void firmwareOTACheckpoint(void)
+{
+	(void)memcpy(&_firmwareCheckpoint.config, &_nodeFirmwareConfig, sizeof(nodeFirmwareConfig_t));
+	_firmwareCheckpoint.block = _firmwareBlock;
+	_firmwareCheckpoint.crc = _firmwareCRC;
+#if defined(MY_OTA_RESUME_FEATURE)
+	hwWriteConfigBlock((void*)&_firmwareCheckpoint, (void*)EEPROM_OTA_CHECKPOINT_ADDRESS,
+	                   sizeof(firmwareCheckpoint_t));
+#endif
+}
+
+LOCAL bool firmwareOTACanResume(void)
+{
+	if (memcmp(&_firmwareCheckpoint.config, &_nodeFirmwareConfig, sizeof(nodeFirmwareConfig_t)) ||
+	        !_firmwareCheckpoint.block || _firmwareCheckpoint.block >= _nodeFirmwareConfig.blocks) {
+		return false;
+	}
+	// blocks are received from the top, crc them in the same order
+	uint16_t crc = ~0;
+	for (uint16_t block = _nodeFirmwareConfig.blocks; block > _firmwareCheckpoint.block; block--) {
+		const uint32_t addr = ((uint32_t)(block - 1) * FIRMWARE_BLOCK_SIZE) + FIRMWARE_START_OFFSET;
+		for (uint8_t i = 0; i < FIRMWARE_BLOCK_SIZE; i++) {
+			crc = firmwareCRC16(crc, _flash_readByte(addr + i));
+		}
+	}
+	return crc == _firmwareCheckpoint.crc;
+}
+
+LOCAL void firmwareOTAFailed(void)
+{
+	_firmwareUpdateOngoing = false;
+	// the node still runs the installed FW, resume later
+	readFirmwareSettings();
+	_firmwareResumePending = true;
+	_firmwareLastRequest = hwMillis();
 }
 
 LOCAL void firmwareOTAUpdateRequest(void)
 {
 	const uint32_t enterMS = hwMillis();
+	if (_firmwareResumePending && (enterMS - _firmwareLastRequest > _firmwareResumeDelay)) {
+		_firmwareLastRequest = enterMS;
+		_firmwareResumeDelay = (_firmwareResumeDelay > MY_OTA_RESUME_DELAY_MAX / 2) ?
+		                       MY_OTA_RESUME_DELAY_MAX : _firmwareResumeDelay * 2;
+		OTA_DEBUG(PSTR("OTA:FRQ:RESUME,D=%" PRIu32 "\n"), _firmwareResumeDelay);
+		// ask for the FW config again, the update continues from the last checkpoint
+		presentBootloaderInformation();
+		return;
+	}
 	if (_firmwareUpdateOngoing && (enterMS - _firmwareLastRequest > MY_OTA_RETRY_DELAY)) {
 		if (!_firmwareRetry) {
 			setIndication(INDICATION_ERR_FW_TIMEOUT);
 			OTA_DEBUG(PSTR("!OTA:FRQ:FW UPD FAIL\n"));	// fw update failed
-			// Give up. We have requested MY_OTA_RETRY times without any packet in return.
-			_firmwareUpdateOngoing = false;
+			// Give up for now. We have requested MY_OTA_RETRY times without any packet in return.
+			firmwareOTACheckpoint();
+			firmwareOTAFailed();
 			return;
 		}
 		_firmwareRetry--;
@@ -90,6 +158,7 @@ LOCAL bool firmwareOTAUpdateProcess(void)
 			OTA_DEBUG(PSTR("!OTA:FWP:UPDO\n"));	// FW config response received, FW update already ongoing
 			return true;
 		}
+		_firmwareResumePending = false;
 		nodeFirmwareConfig_t *firmwareConfigResponse = (nodeFirmwareConfig_t *)_msg.data;
 		// compare with current node configuration, if they differ, start FW fetch process
 		if (memcmp(&_nodeFirmwareConfig, firmwareConfigResponse, sizeof(nodeFirmwareConfig_t))) {
@@ -103,11 +172,20 @@ LOCAL bool firmwareOTAUpdateProcess(void)
 				OTA_DEBUG(PSTR("!OTA:FWP:FLASH INIT FAIL\n"));	// failed to initialise flash
 				_firmwareUpdateOngoing = false;
 			} else {
-				// erase lower 32K -> max flash size for ATMEGA328
-				_flash_blockErase32K(0);
-				// wait until flash erased
-				while ( _flash_busy() ) {}
-				_firmwareBlock = _nodeFirmwareConfig.blocks;
+				if (firmwareOTACanResume()) {
+					// blocks already in flash are intact, continue after them
+					_firmwareBlock = _firmwareCheckpoint.block;
+					_firmwareCRC = _firmwareCheckpoint.crc;
+					OTA_DEBUG(PSTR("OTA:FWP:RESUME B=%04" PRIX16 "\n"), _firmwareBlock);
+				} else {
+					// erase lower 32K -> max flash size for ATMEGA328
+					_flash_blockErase32K(0);
+					// wait until flash erased
+					while ( _flash_busy() ) {}
+					_firmwareBlock = _nodeFirmwareConfig.blocks;
+					_firmwareCRC = ~0;
+					firmwareOTACheckpoint();
+				}
 				_firmwareUpdateOngoing = true;
 				// reset flags
 				_firmwareRetry = MY_OTA_RETRY + 1;
@@ -198,14 +276,7 @@ LOCAL bool transportIsValidFirmware(void)
 	// init crc
 	uint16_t crc = ~0;
 	for (uint32_t i = 0; i < _nodeFirmwareConfig.blocks * FIRMWARE_BLOCK_SIZE; ++i) {
-		crc ^= _flash_readByte(i + FIRMWARE_START_OFFSET);
-		for (int8_t j = 0; j < 8; ++j) {
-			if (crc & 1) {
-				crc = (crc >> 1) ^ 0xA001;
-			} else {
-				crc = (crc >> 1);
-			}
-		}
+		crc = firmwareCRC16(crc, _flash_readByte(i + FIRMWARE_START_OFFSET));
 	}
 	OTA_DEBUG(PSTR("OTA:CRC:B=%04" PRIX16 ",C=%04" PRIX16 ",F=%04" PRIX16 "\n"),
 	          _nodeFirmwareConfig.blocks,crc,
@@ -238,6 +309,25 @@ LOCAL bool _firmwareResponse(uint16_t block, uint8_t *data)
 #endif
 		// wait until flash written
 		while (_flash_busy()) {}
+		// read the block back, a block counts once it is verified
+		{
+			const uint32_t addr = ((uint32_t)(_firmwareBlock - 1) * FIRMWARE_BLOCK_SIZE) +
+			                      FIRMWARE_START_OFFSET;
+			uint16_t crc = _firmwareCRC;
+			bool verified = true;
+			for (uint8_t i = 0; i < FIRMWARE_BLOCK_SIZE; i++) {
+				const uint8_t value = _flash_readByte(addr + i);
+				verified &= (value == data[i]);
+				crc = firmwareCRC16(crc, value);
+			}
+			if (!verified) {
+				OTA_DEBUG(PSTR("!OTA:FWP:VERIFY FAIL\n"));
+				setIndication(INDICATION_FW_UPDATE_RX_ERR);
+				// requested again after MY_OTA_RETRY_DELAY
+				return true;
+			}
+			_firmwareCRC = crc;
+		}
 #ifdef OTA_EXTRA_FLASH_DEBUG
 		{
 			char prbuf[8];
@@ -254,10 +344,16 @@ LOCAL bool _firmwareResponse(uint16_t block, uint8_t *data)
 		}
 #endif
 		_firmwareBlock--;
+		_firmwareResumeDelay = MY_OTA_RESUME_DELAY;
+		if (_firmwareBlock && !(_firmwareBlock % MY_OTA_CHECKPOINT_BLOCKS)) {
+			firmwareOTACheckpoint();
+		}
 		if (!_firmwareBlock) {
 			// We're done! Do a checksum and reboot.
 			OTA_DEBUG(PSTR("OTA:FWP:FW END\n"));	// received FW block
 			_firmwareUpdateOngoing = false;
+			// nothing to resume, whatever the outcome
+			firmwareOTACheckpoint();
 			if (transportIsValidFirmware()) {
 				OTA_DEBUG(PSTR("OTA:FWP:CRC OK\n"));	// FW checksum ok
 				// Write the new firmware config to eeprom
@@ -275,6 +371,9 @@ LOCAL bool _firmwareResponse(uint16_t block, uint8_t *data)
 			} else {
 				setIndication(INDICATION_ERR_FW_CHECKSUM);
 				OTA_DEBUG(PSTR("!OTA:FWP:CRC FAIL\n"));
+				// start over later
+				firmwareOTAFailed();
+				return true;
 			}
 		}
 		// reset flags
@@ -37,16 +37,19 @@
 * |E| SYS | SUB | Message                     | Comment
 * |-|-----|-----|-----------------------------|----------------------------------------------------------------------------
 * | | OTA | FWP | UPDATE                      | FW update initiated
+* | | OTA | FWP | RESUME B=%04X               | FW update resumed at block (B), blocks above verified
 * |!| OTA | FWP | UPDO                        | FW config response received, FW update already ongoing
 * |!| OTA | FWP | FLASH INIT FAIL             | Failed to initialise flash
 * | | OTA | FWP | UPDATE SKIPPED              | FW update skipped, no newer version available
 * | | OTA | FWP | RECV B=%04X                 | Received FW block (B)
 * |!| OTA | FWP | WRONG FWB                   | Wrong FW block received
+* |!| OTA | FWP | VERIFY FAIL                 | FW block read back from flash differs, block requested again
 * | | OTA | FWP | FW END                      | FW received, proceed to CRC verification
 * | | OTA | FWP | CRC OK                      | FW CRC verification OK
 * |!| OTA | FWP | CRC FAIL                    | FW CRC verification failed
 * | | OTA | FRQ | FW REQ,T=%04X,V=%04X,B=%04X | Request FW update, FW type (T), version (V), block (B)
-* |!| OTA | FRQ | FW UPD FAIL                 | FW update failed
+* |!| OTA | FRQ | FW UPD FAIL                 | FW update failed, progress kept
+* | | OTA | FRQ | RESUME,D=%lu                | Ask for the FW config again to resume, next delay (D) ms
 * | | OTA | CRC | B=%04X,C=%04X,F=%04X        | FW CRC verification. FW blocks (B), calculated CRC (C), FW CRC (F)
 *
 *
@@ -79,6 +82,12 @@
 #ifndef MY_OTA_RETRY_DELAY
 #define MY_OTA_RETRY_DELAY		(500u)				//!< Number of milliseconds before re-requesting a FW block
 #endif
+#ifndef MY_OTA_RESUME_DELAY
+#define MY_OTA_RESUME_DELAY		(10000ul)			//!< Milliseconds after a failed FW update before it is resumed
+#endif
+#ifndef MY_OTA_RESUME_DELAY_MAX
+#define MY_OTA_RESUME_DELAY_MAX	(3600000ul)			//!< Resume delay doubles after every failure up to this limit
+#endif
 #ifndef MCUBOOT_PRESENT
 #define FIRMWARE_START_OFFSET	(10u)				//!< Start offset for firmware in flash (DualOptiboot wants to keeps a signature first)
 #else
@@ -121,6 +130,15 @@ typedef struct {
 	uint16_t crc;								//!< CRC of block data
 } __attribute__((packed)) nodeFirmwareConfig_t;
 
+/**
+* @brief FW update progress, stored in eeprom with MY_OTA_RESUME_FEATURE
+*/
+typedef struct {
+	nodeFirmwareConfig_t config;				//!< FW being received
+	uint16_t block;								//!< Blocks left, blocks above are in flash
+	uint16_t crc;								//!< CRC of the blocks in flash, in the order received
+} __attribute__((packed)) firmwareCheckpoint_t;
+
 /**
 * @brief FW config request structure
 */
@@ -190,6 +208,16 @@ LOCAL bool firmwareOTAUpdateProcess(void);
  * This function verifies if uploaded FW CRC is valid
  */
 LOCAL bool transportIsValidFirmware(void);
+/**
+ * @brief Save the FW update progress
+ * This function saves the progress to eeprom with MY_OTA_RESUME_FEATURE
+ */
+LOCAL void firmwareOTACheckpoint(void);
+/**
+ * @brief Check the FW blocks in flash against the progress checkpoint
+ * @return true if the FW update can be resumed
+ */
+LOCAL bool firmwareOTACanResume(void);
 /**
  * @brief Present bootloader/FW information upon startup
  */
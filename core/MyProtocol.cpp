@@ -90,7 +90,7 @@ bool protocolSerial2MyMessage(MyMessage &message, char *inputString)
 char *protocolMyMessage2Serial(MyMessage &message)
 {
 	(void)snprintf_P(_fmtBuffer, MY_GATEWAY_MAX_SEND_LENGTH,
-	                 PSTR("%" PRIu8 ";%" PRIu8 ";%" PRIu8 ";%" PRIu8 ";%" PRIu8 ";%s\n"), message.sender,
+	                 PSTR("%" PRIuNodeId ";%" PRIu8 ";%" PRIu8 ";%" PRIu8 ";%" PRIu8 ";%s\n"), message.sender,
 	                 message.sensor, mGetCommand(message), mGetAck(message), message.type,
 	                 message.getString(_convBuffer));
 	return _fmtBuffer;
@@ -99,7 +99,7 @@ char *protocolMyMessage2Serial(MyMessage &message)
 char *protocolMyMessage2MQTT(const char *prefix, MyMessage &message)
 {
 	(void)snprintf_P(_fmtBuffer, MY_GATEWAY_MAX_SEND_LENGTH,
-	                 PSTR("%s/%" PRIu8 "/%" PRIu8 "/%" PRIu8 "/%" PRIu8 "/%" PRIu8 ""), prefix,
+	                 PSTR("%s/%" PRIuNodeId "/%" PRIu8 "/%" PRIu8 "/%" PRIu8 "/%" PRIu8 ""), prefix,
 	                 message.sender, message.sensor, mGetCommand(message), mGetAck(message), message.type);
 	return _fmtBuffer;
 }
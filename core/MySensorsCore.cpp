@@ -39,6 +39,15 @@ MyMessage _msgTmp;		// Buffer for temporary messages (acks and nonces among othe
 // core configuration
 static coreConfig_t _coreConfig;
 
+// send queue, messages queued by sendAsync() are sent from _process()
+#if defined(MY_SEND_QUEUE_FEATURE)
+#include "drivers/CircularBuffer/CircularBuffer.h"
+static sendQueueEntry_t _sendQueueStorage[MY_SEND_QUEUE_SIZE];
+static CircularBuffer<sendQueueEntry_t> _sendQueue(_sendQueueStorage, MY_SEND_QUEUE_SIZE);
+static sendQueueEntry_t _sendQueueAcks[MY_SEND_QUEUE_SIZE];	//!< sent, waiting for ack, free if no callback
+static bool _sendQueueBusy = false;	//!< sending from the queue, e.g. waiting for a nonce
+#endif
+
 #if defined(MY_DEBUG_VERBOSE_CORE)
 static uint8_t waitLock = 0;
 #endif
@@ -67,6 +76,14 @@ void _process(void)
 	inclusionProcess();
 #endif
 
+#if defined(MY_GATEWAY_ID_ALLOCATION_FEATURE)
+	idAllocatorProcess();
+#endif
+
+#if defined(MY_GATEWAY_LIVENESS_FEATURE)
+	livenessProcess();
+#endif
+
 #if defined(MY_GATEWAY_FEATURE)
 	gatewayTransportProcess();
 #endif
@@ -75,8 +92,17 @@ void _process(void)
 	transportProcess();
 #endif
 
-#if defined(__linux__)
-	// To avoid high cpu usage
+#if defined(MY_SEND_QUEUE_FEATURE)
+	_sendQueueProcess();
+#endif
+
+#if defined(MY_GATEWAY_LINUX) && defined(MY_USE_UDP) && !defined(MY_GATEWAY_CLIENT_MODE)
+	// one sendmmsg() for everything queued for the controllers in this iteration
+	gatewayTransportFlush();
+#endif
+
+#if defined(__linux__) && !defined(MY_SIMULATION)
+	// To avoid high cpu usage (the simulated transport idles in virtual time instead)
 	usleep(10000); // 10ms
 #endif
 }
@@ -147,6 +173,15 @@ void _begin(void)
 	readFirmwareSettings();
 #endif
 
+#if defined(MY_GATEWAY_ID_ALLOCATION_FEATURE)
+	// Read node ID leases from EEPROM
+	idAllocatorInit();
+#endif
+
+#if defined(MY_GATEWAY_LIVENESS_FEATURE)
+	livenessInit();
+#endif
+
 #if defined(MY_SENSOR_NETWORK)
 	// Save static parent ID in eeprom (used by bootloader)
 	hwWriteConfig(EEPROM_PARENT_NODE_ID_ADDRESS, MY_PARENT_NODE_ID);
@@ -252,9 +287,9 @@ void presentNode(void)
 }
 
 
-uint8_t getNodeId(void)
+nodeId_t getNodeId(void)
 {
-	uint8_t result;
+	nodeId_t result;
 #if defined(MY_GATEWAY_FEATURE)
 	result = GATEWAY_ADDRESS;
 #elif defined(MY_SENSOR_NETWORK)
@@ -265,9 +300,9 @@ uint8_t getNodeId(void)
 	return result;
 }
 
-uint8_t getParentNodeId(void)
+nodeId_t getParentNodeId(void)
 {
-	uint8_t result;
+	nodeId_t result;
 #if defined(MY_GATEWAY_FEATURE)
 	result = VALUE_NOT_DEFINED;	// GW doesn't have a parent
 #elif defined(MY_SENSOR_NETWORK)
@@ -306,7 +341,7 @@ bool _sendRoute(MyMessage &message)
 	if (message.destination == getNodeId()) {
 		// This is a message sent from a sensor attached on the gateway node.
 		// Pass it directly to the gateway transport layer.
-		return gatewayTransportSend(message);
+		return gatewayTransportDeliver(message);
 	}
 #endif
 #if defined(MY_SENSOR_NETWORK)
@@ -316,12 +351,8 @@ bool _sendRoute(MyMessage &message)
 #endif
 }
 
-bool send(MyMessage &message, const bool enableAck)
+bool _sendRegistered(MyMessage &message)
 {
-	message.sender = getNodeId();
-	mSetCommand(message, C_SET);
-	mSetRequestAck(message, enableAck);
-
 #if defined(MY_REGISTRATION_FEATURE) && !defined(MY_GATEWAY_FEATURE)
 	if (_coreConfig.nodeRegistered) {
 		return _sendRoute(message);
@@ -334,6 +365,131 @@ bool send(MyMessage &message, const bool enableAck)
 #endif
 }
 
+bool send(MyMessage &message, const bool enableAck)
+{
+	message.sender = getNodeId();
+	mSetCommand(message, C_SET);
+	mSetRequestAck(message, enableAck);
+	return _sendRegistered(message);
+}
+
+#if defined(MY_SEND_QUEUE_FEATURE)
+bool sendAsync(MyMessage &message, const bool enableAck, const sendCallback_t callback)
+{
+	message.sender = getNodeId();
+	mSetCommand(message, C_SET);
+	mSetRequestAck(message, enableAck);
+
+	sendQueueEntry_t *entry = _sendQueue.getFront();
+	if (entry == NULL) {
+		CORE_DEBUG(PSTR("!MCO:SNQ:OVF\n"));	// queue full
+		return false;
+	}
+	entry->message = message;
+	entry->callback = callback;
+	(void)_sendQueue.pushFront(entry);
+	CORE_DEBUG(PSTR("MCO:SNQ:ADD,N=%" PRIu8 "\n"), _sendQueue.available());
+	return true;
+}
+#endif
+
+void _sendQueueProcess(void)
+{
+#if defined(MY_SEND_QUEUE_FEATURE)
+	if (_sendQueueBusy) {
+		// queue is serviced again when the current message is out
+		return;
+	}
+	_sendQueueBusy = true;
+	// callbacks may queue messages, but are not called again while one of them runs
+	for (uint8_t i = 0; i < MY_SEND_QUEUE_SIZE; i++) {
+		sendQueueEntry_t *ack = &_sendQueueAcks[i];
+		if (ack->callback != NULL &&
+		        hwMillis() - ack->sent > (uint32_t)MY_SEND_QUEUE_ACK_TIMEOUT_MS) {
+			const sendCallback_t callback = ack->callback;
+			ack->callback = NULL;
+			CORE_DEBUG(PSTR("!MCO:SNQ:ACK TMO\n"));	// no ack in time
+			callback(ack->message, SEND_NO_ACK);
+		}
+	}
+	sendQueueEntry_t *entry = _sendQueue.getBack();
+	if (entry != NULL) {
+		sendQueueEntry_t *ack = NULL;
+		if (entry->callback != NULL && mGetRequestAck(entry->message)) {
+			for (uint8_t i = 0; i < MY_SEND_QUEUE_SIZE && ack == NULL; i++) {
+				if (_sendQueueAcks[i].callback == NULL) {
+					ack = &_sendQueueAcks[i];
+				}
+			}
+			if (ack == NULL) {
+				// all acks outstanding, keep the message queued
+				_sendQueueBusy = false;
+				return;
+			}
+		}
+		MyMessage message = entry->message;
+		const sendCallback_t callback = entry->callback;
+		// free the entry first, the sketch can queue while the message is sent
+		(void)_sendQueue.popBack();
+		const bool delivered = _sendRegistered(message);
+		CORE_DEBUG(PSTR("MCO:SNQ:SND,S=%" PRIu8 "\n"), (uint8_t)(delivered ? SEND_OK : SEND_FAILED));
+		if (delivered && ack != NULL) {
+			// the sent message, signing may have altered it
+			ack->message = message;
+			ack->callback = callback;
+			ack->sent = hwMillis();
+		} else if (callback != NULL) {
+			callback(message, delivered ? SEND_OK : SEND_FAILED);
+		}
+	}
+	_sendQueueBusy = false;
+#endif
+}
+
+void _sendQueueFlush(void)
+{
+#if defined(MY_SEND_QUEUE_FEATURE)
+	if (_sendQueueBusy) {
+		// called from a callback, the queue cannot drain
+		return;
+	}
+	bool pending = true;
+	while (pending) {
+		pending = !_sendQueue.empty();
+		for (uint8_t i = 0; i < MY_SEND_QUEUE_SIZE && !pending; i++) {
+			pending = _sendQueueAcks[i].callback != NULL;
+		}
+		if (pending) {
+			_process();
+		}
+	}
+#endif
+}
+
+void _sendQueueAck(const MyMessage &message)
+{
+#if defined(MY_SEND_QUEUE_FEATURE)
+	// oldest message waiting for an ack from the sender with the same child sensor and type
+	sendQueueEntry_t *ack = NULL;
+	for (uint8_t i = 0; i < MY_SEND_QUEUE_SIZE; i++) {
+		sendQueueEntry_t *entry = &_sendQueueAcks[i];
+		if (entry->callback != NULL && entry->message.destination == message.sender &&
+		        entry->message.sensor == message.sensor && entry->message.type == message.type &&
+		        mGetCommand(entry->message) == mGetCommand(message) &&
+		        (ack == NULL || (int32_t)(entry->sent - ack->sent) < 0)) {
+			ack = entry;
+		}
+	}
+	if (ack != NULL) {
+		const sendCallback_t callback = ack->callback;
+		ack->callback = NULL;
+		callback(ack->message, SEND_ACKED);
+	}
+#else
+	(void)message;
+#endif
+}
+
 bool sendBatteryLevel(const uint8_t value, const bool ack)
 {
 	return _sendRoute(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL, I_BATTERY_LEVEL,
@@ -344,8 +500,13 @@ bool sendHeartbeat(const bool ack)
 {
 #if defined(MY_SENSOR_NETWORK)
 	const uint32_t heartbeat = transportGetHeartbeat();
-	return _sendRoute(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL, I_HEARTBEAT_RESPONSE,
-	                        ack).set(heartbeat));
+	const bool result = _sendRoute(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL,
+	                                     I_HEARTBEAT_RESPONSE, ack).set(heartbeat));
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+	// link statistics follow every heartbeat
+	(void)transportReportStats();
+#endif
+	return result;
 #else
 	(void)ack;
 	return false;
@@ -403,7 +564,7 @@ bool sendSketchInfo(const __FlashStringHelper *name, const __FlashStringHelper *
 }
 #endif
 
-bool request(const uint8_t childSensorId, const uint8_t variableType, const uint8_t destination)
+bool request(const uint8_t childSensorId, const uint8_t variableType, const nodeId_t destination)
 {
 	return _sendRoute(build(_msgTmp, destination, childSensorId, C_REQ, variableType).set(""));
 }
@@ -512,6 +673,23 @@ bool _processInternalCoreMessage(void)
 #else
 			return false;	// processing of this request via controller
 #endif
+#endif
+		} else if (type == I_TIME || type == I_CONFIG) {
+#if defined(MY_GATEWAY_FEATURE)
+			// answered from the clock and configuration of the gateway, if the platform can
+			uint32_t localTime;
+			char localConfig[2] = { 0, 0 };
+			if (type == I_TIME && hwLocalTime(&localTime)) {
+				(void)_sendRoute(build(_msgTmp, _msg.sender, NODE_SENSOR_ID, C_INTERNAL,
+				                       I_TIME).set(localTime));
+			} else if (type == I_CONFIG && hwLocalConfig(&localConfig[0])) {
+				(void)_sendRoute(build(_msgTmp, _msg.sender, NODE_SENSOR_ID, C_INTERNAL,
+				                       I_CONFIG).set(localConfig));
+			} else {
+				return false;	// processing of this request via controller
+			}
+#else
+			return false;	// processing of this request via controller
 #endif
 		} else {
 			return false; // further processing required
@@ -628,6 +806,20 @@ int8_t _sleep(const uint32_t sleepingMS, const bool smartSleep, const uint8_t in
 		sleepingTimeMS = sleepingTimeMS >= 1000ul ? sleepingTimeMS - 1000ul : 1000ul;
 	}
 #endif // MY_OTA_FIRMWARE_FEATURE
+#if defined(MY_SEND_QUEUE_FEATURE)
+	// send what the sketch queued, acks would be lost while sleeping
+	const uint32_t flushEnterMS = hwMillis();
+	_sendQueueFlush();
+	const uint32_t flushDeltaMS = hwMillis() - flushEnterMS;
+	if (sleepingTimeMS) {
+		if (flushDeltaMS >= sleepingTimeMS) {
+			// no sleeping time left
+			CORE_DEBUG(PSTR("!MCO:SLP:NTL\n"));
+			return MY_SLEEP_NOT_POSSIBLE;
+		}
+		sleepingTimeMS -= flushDeltaMS;		// calculate remaining sleeping time
+	}
+#endif
 	if (smartSleep) {
 		// sleeping time left?
 		if (sleepingTimeMS > 0 && sleepingTimeMS < ((uint32_t)MY_SMART_SLEEP_WAIT_DURATION_MS)) {
@@ -32,6 +32,7 @@
 *  - MCO:<b>BGN</b>	from @ref _begin()
 *  - MCO:<b>REG</b>	from @ref _registerNode()
 *  - MCO:<b>SND</b>	from @ref send()
+*  - MCO:<b>SNQ</b>	from @ref sendAsync() and @ref _sendQueueProcess(), send queue (only with @ref MY_SEND_QUEUE_FEATURE)
 *  - MCO:<b>PIM</b>	from @ref _processInternalCoreMessage()
 *  - MCO:<b>NLK</b>	from @ref _nodeLock()
 *
@@ -49,6 +50,10 @@
 * | | MCO | REG | REQ																					| Registration request
 * | | MCO | REG | NOT NEEDED																	| No registration needed (i.e. GW)
 * |!| MCO | SND | NODE NOT REG																| Node is not registered, cannot send message
+* | | MCO | SNQ | ADD,N=%%d																		| Message queued, messages in queue (N)
+* |!| MCO | SNQ | OVF																					| Send queue full, message not queued
+* | | MCO | SNQ | SND,S=%%d																		| Queued message sent, status (S), see @ref sendStatus_t
+* |!| MCO | SNQ | ACK TMO																			| No ack for a queued message within @ref MY_SEND_QUEUE_ACK_TIMEOUT_MS
 * | | MCO | PIM | NODE REG=%%d																| Registration response received, registration status (REG)
 * |!| MCO | WAI | RC=%%d																			| Recursive call detected in wait(), level (RC)
 * | | MCO | SLP | MS=%%lu,SMS=%%d,I1=%%d,M1=%%d,I2=%%d,M2=%%d	| Sleep node, time (MS), smartSleep (SMS), Int1/M1, Int2/M2
@@ -107,18 +112,44 @@ typedef struct {
 	uint8_t reserved : 6;					//!< reserved
 } coreConfig_t;
 
+/**
+ * @brief Outcome of a queued message, reported to the callback of @ref sendAsync()
+ */
+typedef enum {
+	SEND_OK,		//!< message reached the first stop on its way to destination, no ack requested
+	SEND_ACKED,		//!< destination acknowledged the message
+	SEND_NO_ACK,	//!< message reached the first stop, but no ack within MY_SEND_QUEUE_ACK_TIMEOUT_MS
+	SEND_FAILED		//!< message not sent, e.g. first stop not reached or node not registered
+} sendStatus_t;
+
+/**
+ * @brief Completion callback of a queued message
+ * @param message the message as sent
+ * @param status outcome
+ */
+typedef void (*sendCallback_t)(const MyMessage &message, const sendStatus_t status);
+
+/**
+ * @brief Send queue entry
+ */
+typedef struct {
+	MyMessage message;						//!< message to send
+	sendCallback_t callback;				//!< completion callback, NULL if none
+	uint32_t sent;							//!< timepoint the message was sent, while waiting for the ack
+} sendQueueEntry_t;
+
 
 // **** public functions ********
 
 /**
  * Return this nodes id.
  */
-uint8_t getNodeId(void);
+nodeId_t getNodeId(void);
 
 /**
  * Return the parent node id.
  */
-uint8_t getParentNodeId(void);
+nodeId_t getParentNodeId(void);
 
 /**
 * Sends node information to the gateway.
@@ -164,6 +195,20 @@ bool sendSketchInfo(const __FlashStringHelper *name, const __FlashStringHelper *
 */
 bool send(MyMessage &msg, const bool ack = false);
 
+#if defined(MY_SEND_QUEUE_FEATURE) || defined(DOXYGEN)
+/**
+* Queues a message to gateway or one of the other nodes in the radio network and returns
+* right away. The core sends queued messages in order from _process(), i.e. between loop()
+* calls and during wait(). sleep() sends all queued messages before the node goes to sleep.
+* Only with @ref MY_SEND_QUEUE_FEATURE.
+* @param msg Message to send, copied into the queue
+* @param ack Set this to true if you want destination node to send ack back to this node. Default is not to request any ack.
+* @param callback Called from _process() once the outcome is known, with ack requested after the ack arrived or timed out. Default is no callback.
+* @return true Returns true if the message was queued, false if the queue is full.
+*/
+bool sendAsync(MyMessage &msg, const bool ack = false, const sendCallback_t callback = NULL);
+#endif
+
 /**
  * Send this nodes battery level to gateway.
  * @param level Level between 0-100(%)
@@ -206,7 +251,7 @@ bool sendTXPowerLevel(const uint8_t level, const bool ack = false);
 * @return true Returns true if message reached the first stop on its way to destination.
 */
 bool request(const uint8_t childSensorId, const uint8_t variableType,
-             const uint8_t destination = GATEWAY_ADDRESS);
+             const nodeId_t destination = GATEWAY_ADDRESS);
 
 /**
  * Requests time from controller. Answer will be delivered to receiveTime function in sketch.
@@ -407,6 +452,25 @@ void _registerNode(void);
 * @return true Returns true if message reached the first stop on its way to destination.
 */
 bool _sendRoute(MyMessage &message);
+/**
+* @brief Sends message according to routing table if the node is registered
+* @param message
+* @return true Returns true if message reached the first stop on its way to destination.
+*/
+bool _sendRegistered(MyMessage &message);
+/**
+* @brief Sends the oldest queued message and expires acks (only with @ref MY_SEND_QUEUE_FEATURE)
+*/
+void _sendQueueProcess(void);
+/**
+* @brief Sends all queued messages and waits for their acks (only with @ref MY_SEND_QUEUE_FEATURE)
+*/
+void _sendQueueFlush(void);
+/**
+* @brief Completes the queued message an incoming ack belongs to (only with @ref MY_SEND_QUEUE_FEATURE)
+* @param message received ack
+*/
+void _sendQueueAck(const MyMessage &message);
 
 /**
 * @brief Callback for incoming messages
@@ -440,9 +504,12 @@ void loop(void) __attribute__((weak));
 
 
 // Inline function and macros
-static inline MyMessage& build(MyMessage &msg, const uint8_t destination, const uint8_t sensor,
+static inline MyMessage& build(MyMessage &msg, const nodeId_t destination, const uint8_t sensor,
                                const uint8_t command, const uint8_t type, const bool ack = false)
 {
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	mSetVersion(msg, PROTOCOL_VERSION);	// the extended request marker is set per message
+#endif
 	msg.sender = getNodeId();
 	msg.destination = destination;
 	msg.sensor = sensor;
@@ -455,6 +522,9 @@ static inline MyMessage& build(MyMessage &msg, const uint8_t destination, const
 
 static inline MyMessage& buildGw(MyMessage &msg, const uint8_t type)
 {
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	mSetVersion(msg, PROTOCOL_VERSION);
+#endif
 	msg.sender = GATEWAY_ADDRESS;
 	msg.destination = GATEWAY_ADDRESS;
 	msg.sensor = NODE_SENSOR_ID;
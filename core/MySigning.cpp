@@ -196,6 +196,7 @@ bool signerCheckTimer(void)
 bool signerSignMsg(MyMessage &msg)
 {
 	bool ret;
+	MY_TRACE_MSG(sign__sign, msg, 0);
 #if defined(MY_SIGNING_FEATURE)
 	// If destination is known to require signed messages and we are the sender,
 	// sign this message unless it is identified as an exception
@@ -259,12 +260,14 @@ bool signerSignMsg(MyMessage &msg)
 	(void)msg;
 	ret = true;
 #endif // MY_SIGNING_FEATURE
+	MY_TRACE_MSG(sign__sign__done, msg, ret);
 	return ret;
 }
 
 bool signerVerifyMsg(MyMessage &msg)
 {
 	bool verificationResult = true;
+	MY_TRACE_MSG(sign__verify, msg, 0);
 	// Before processing message, reject unsigned messages if signing is required and check signature
 	// (if it is signed and addressed to us)
 	// Note that we do not care at all about any signature found if we do not require signing
@@ -315,6 +318,7 @@ bool signerVerifyMsg(MyMessage &msg)
 #else
 	(void)msg;
 #endif // MY_SIGNING_REQUEST_SIGNATURES
+	MY_TRACE_MSG(sign__verify__done, msg, verificationResult);
 	return verificationResult;
 }
 
@@ -61,7 +61,7 @@ static uint8_t _signing_hmac_key[SIZE_SIGNING_SOFT_HMAC_KEY];
 static uint8_t _signing_hmac[32];
 static uint8_t _signing_node_serial_info[SIZE_SIGNING_SOFT_SERIAL];
 
-#ifdef MY_SIGNING_NODE_WHITELISTING
+#if defined(MY_SIGNING_NODE_WHITELISTING) && !defined(MY_SIGNING_RUNTIME_WHITELIST)
 static const whitelist_entry_t _signing_whitelist[] = MY_SIGNING_NODE_WHITELISTING;
 #endif
 
@@ -245,26 +245,31 @@ bool signerAtsha204SoftVerifyMsg(MyMessage &msg)
 
 #ifdef MY_SIGNING_NODE_WHITELISTING
 		// Look up the senders nodeId in our whitelist and salt the signature with that data
-		size_t j;
-		for (j = 0; j < NUM_OF(_signing_whitelist); j++) {
+		const uint8_t *serial = NULL;
+#if defined(MY_SIGNING_RUNTIME_WHITELIST)
+		serial = hwSigningWhitelist(msg.sender);
+#else
+		for (size_t j = 0; j < NUM_OF(_signing_whitelist); j++) {
 			if (_signing_whitelist[j].nodeId == msg.sender) {
-				// We can reuse the nonce buffer now since it is no longer needed
-				(void)memcpy((void *)_signing_verifying_nonce, (const void *)_signing_hmac, 32);
-				_signing_verifying_nonce[32] = msg.sender;
-				(void)memcpy((void *)&_signing_verifying_nonce[33], (const void *)_signing_whitelist[j].serial, 9);
-				SHA256(_signing_hmac, _signing_verifying_nonce, 32+1+9);
-				SIGN_DEBUG(PSTR("SGN:BND:VER WHI,ID=%" PRIu8 "\n"), msg.sender);
-#ifdef MY_DEBUG_VERBOSE_SIGNING
-				buf2str(_signing_whitelist[j].serial, 9);
-				SIGN_DEBUG(PSTR("SGN:BND:VER WHI,SERIAL=%s\n"), printStr);
-#endif
+				serial = _signing_whitelist[j].serial;
 				break;
 			}
 		}
-		if (j == NUM_OF(_signing_whitelist)) {
+#endif
+		if (serial == NULL) {
 			SIGN_DEBUG(PSTR("!SGN:BND:VER WHI,ID=%" PRIu8 " MISSING\n"), msg.sender);
 			return false;
 		}
+		// We can reuse the nonce buffer now since it is no longer needed
+		(void)memcpy((void *)_signing_verifying_nonce, (const void *)_signing_hmac, 32);
+		_signing_verifying_nonce[32] = msg.sender;
+		(void)memcpy((void *)&_signing_verifying_nonce[33], (const void *)serial, 9);
+		SHA256(_signing_hmac, _signing_verifying_nonce, 32+1+9);
+		SIGN_DEBUG(PSTR("SGN:BND:VER WHI,ID=%" PRIu8 "\n"), msg.sender);
+#ifdef MY_DEBUG_VERBOSE_SIGNING
+		buf2str(serial, 9);
+		SIGN_DEBUG(PSTR("SGN:BND:VER WHI,SERIAL=%s\n"), printStr);
+#endif
 #endif
 
 		// Overwrite the first byte in the signature with the signing identifier
@@ -0,0 +1,115 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+/**
+* @file MyTrace.h
+*
+* @defgroup MyTracegrp MyTrace
+* @ingroup internals
+* @{
+*
+* Static tracepoints (USDT) on the message hot path, provider <b>mysensors</b>.
+* Enabled with @ref MY_TRACE_PROBES on Linux, each probe compiles to a single NOP and is
+* activated at runtime by bpftrace, perf or SystemTap, e.g.
+* @code
+* bpftrace -e 'usdt:/usr/local/bin/mysgw:mysensors:msg__rx { @[arg1] = count(); }'
+* @endcode
+* Without @ref MY_TRACE_PROBES, all probes expand to nothing.
+*
+* Message probes carry the header fields: arg0=sender, arg1=last, arg2=destination, arg3=sensor,
+* arg4=command, arg5=type, arg6=length, arg7=probe-specific value.
+*
+* | Probe              | Location                    | arg7
+* |--------------------|-----------------------------|-------------------------------------
+* | msg__rx            | transportProcessMessage()   | received payload length
+* | sign__verify       | signerVerifyMsg() entry     | 0
+* | sign__verify__done | signerVerifyMsg() exit      | verification result
+* | sign__sign         | signerSignMsg() entry       | 0
+* | sign__sign__done   | signerSignMsg() exit        | signing result
+* | route              | transportRouteMessage()     | next hop
+* | route__done        | transportRouteMessage()     | send result
+* | gw__send           | gatewayTransportSend()      | 0
+* | gw__receive        | gatewayTransportReceive()   | 0
+*
+* Radio probes carry arg0=recipient, arg1=length, arg2=probe-specific value.
+*
+* | Probe              | Location                        | arg2
+* |--------------------|---------------------------------|---------------------------------
+* | radio__send        | transportSendWrite(), HAL send  | 0
+* | radio__send__done  | transportSendWrite(), HAL send  | result, i.e. ACK received
+* | radio__retry       | RFM69/RFM95 *_sendWithRetry()   | retry counter of attempt
+*
+* With @ref MY_TRACE_RECORDER or @ref MY_TRACE_PROBES, every probe is also kept in the flight
+* recorder of the stall detector (stall.h) and shows up in its dumps.
+*
+* @brief API declaration for MyTrace
+*/
+
+#ifndef MyTrace_h
+#define MyTrace_h
+
+#if defined(MY_TRACE_PROBES) && !defined(__linux__)
+#error MY_TRACE_PROBES is only supported on Linux
+#endif
+#if defined(MY_TRACE_PROBES) && !defined(MY_TRACE_RECORDER)
+#define MY_TRACE_RECORDER
+#endif
+
+#if defined(MY_TRACE_RECORDER)
+#if !defined(__linux__)
+#error MY_TRACE_RECORDER is only supported on Linux
+#endif
+#include "stall.h"
+/**
+ * @brief Keep a message probe in the flight recorder
+ */
+#define MY_TRACE_RECORD_MSG(probe, msg, arg) stallRecord(STALL_EVENT_MSG, #probe, (msg).sender, \
+        (msg).destination, mGetCommand(msg), (msg).type, (int32_t)(arg))
+/**
+ * @brief Keep a radio probe in the flight recorder
+ */
+#define MY_TRACE_RECORD_RADIO(probe, recipient, length, arg) stallRecord(STALL_EVENT_RADIO, \
+        #probe, (recipient), (length), 0, 0, (int32_t)(arg))
+#else
+#define MY_TRACE_RECORD_MSG(probe, msg, arg)					//!< recorder NULL
+#define MY_TRACE_RECORD_RADIO(probe, recipient, length, arg)	//!< recorder NULL
+#endif
+
+#if defined(MY_TRACE_PROBES)
+#include <sys/sdt.h>
+
+/**
+ * @brief Message probe, arguments are the header fields of msg and arg
+ */
+#define MY_TRACE_MSG(probe, msg, arg) do { DTRACE_PROBE8(mysensors, probe, (msg).sender, (msg).last, \
+        (msg).destination, (msg).sensor, mGetCommand(msg), (msg).type, mGetLength(msg), (arg)); \
+        MY_TRACE_RECORD_MSG(probe, msg, arg); } while (0)
+/**
+ * @brief Radio driver probe
+ */
+#define MY_TRACE_RADIO(probe, recipient, length, arg) do { DTRACE_PROBE3(mysensors, probe, \
+        (recipient), (length), (arg)); MY_TRACE_RECORD_RADIO(probe, recipient, length, arg); } while (0)
+#else
+#define MY_TRACE_MSG(probe, msg, arg) MY_TRACE_RECORD_MSG(probe, msg, arg)		//!< recorder or NULL
+#define MY_TRACE_RADIO(probe, recipient, length, arg) MY_TRACE_RECORD_RADIO(probe, recipient, \
+        length, arg)	//!< recorder or NULL
+#endif
+
+#endif // MyTrace_h
+/** @}*/
@@ -27,6 +27,12 @@ extern char _convBuf[MAX_PAYLOAD * 2 + 1];
 #define TRANSPORT_DEBUG(x,...)	//!< debug NULL
 #endif
 
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+#define TRANSPORT_STATS_INC(x) (_transportStats.x++)	//!< count link statistics
+#else
+#define TRANSPORT_STATS_INC(x)	//!< count link statistics NULL
+#endif
+
 
 // SM: transitions and update states
 static transportState_t stInit = { stInitTransition, stInitUpdate };
@@ -59,6 +65,39 @@ static routingTable_t _transportRoutingTable;		//!< routing table
 static uint32_t _lastRoutingTableSave;			//!< last routing table dump
 #endif
 
+// route cache in front of the routing table in EEPROM, most recently used first
+#if defined(MY_ROUTE_CACHE_FEATURE)
+static routeCacheEntry_t _transportRouteCache[MY_ROUTE_CACHE_SIZE];
+static uint32_t _lastRoutingTableSave;			//!< last write-back of changed routes
+#endif
+
+// routes to or via extended node IDs, hashed by node
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+static transportExtendedRoute_t _transportExtendedRoutes[MY_EXTENDED_ROUTES];
+#endif
+
+// ingress rate limiting, one token bucket per sender
+#if defined(MY_TRANSPORT_RX_RATE_LIMIT_FEATURE)
+static transportRxBucket_t _transportRxBuckets[SIZE_ROUTES];	//!< ingress token buckets
+#endif
+
+// link statistics, reported to the GW
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+static transportStats_t _transportStats;
+static nodeId_t _transportStatsParent = AUTO;	//!< parent when transport was last ready
+static uint32_t _transportStatsReport;			//!< last periodic report
+#endif
+
+// forwarding queue, relayed messages are sent between receptions
+#if defined(MY_REPEATER_FEATURE) && defined(MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+#include "drivers/CircularBuffer/CircularBuffer.h"
+static transportForwardEntry_t _transportForwardStorage[MY_TRANSPORT_FORWARD_QUEUE_SIZE];
+static CircularBuffer<transportForwardEntry_t> _transportForwardQueue(_transportForwardStorage,
+        MY_TRANSPORT_FORWARD_QUEUE_SIZE);
+static transportForwardStats_t _transportForwardStats;
+static bool _transportForwarding = false;	//!< relaying from the queue, e.g. waiting for a nonce
+#endif
+
 // regular sanity check, activated by default on GW and repeater nodes
 #if defined(MY_TRANSPORT_SANITY_CHECK)
 static uint32_t _lastSanityCheck;		//!< last sanity check
@@ -85,13 +124,24 @@ void stInitTransition(void)
 #if defined(MY_GATEWAY_FEATURE)
 	_lastNetworkDiscovery = 0;
 #endif
-#if defined(MY_RAM_ROUTING_TABLE_ENABLED)
+#if defined(MY_RAM_ROUTING_TABLE_ENABLED) || defined(MY_ROUTE_CACHE_FEATURE)
 	_lastRoutingTableSave = hwMillis();
 #endif
 
 	// Read node settings (ID, parent ID, GW distance) from EEPROM
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	// the 8 bit settings stay in place, the high byte of the ID is stored separately
+	_transportConfig.nodeId = hwReadConfig(EEPROM_NODE_ID_ADDRESS);
+	const uint8_t nodeIdHigh = hwReadConfig(EEPROM_NODE_ID_HIGH_ADDRESS);
+	if (nodeIdHigh != 0xFF) {
+		_transportConfig.nodeId |= (nodeId_t)nodeIdHigh << 8;
+	}
+	_transportConfig.parentNodeId = hwReadConfig(EEPROM_PARENT_NODE_ID_ADDRESS);
+	_transportConfig.distanceGW = hwReadConfig(EEPROM_DISTANCE_ADDRESS);
+#else
 	hwReadConfigBlock((void *)&_transportConfig, (void *)EEPROM_NODE_ID_ADDRESS,
 	                  sizeof(transportConfig_t));
+#endif
 }
 
 void stInitUpdate(void)
@@ -121,9 +171,9 @@ void stInitUpdate(void)
 		transportSwitchSM(stReady);
 #else
 		if (MY_NODE_ID != AUTO) {
-			TRANSPORT_DEBUG(PSTR("TSM:INIT:STATID=%" PRIu8 "\n"),(uint8_t)MY_NODE_ID);
+			TRANSPORT_DEBUG(PSTR("TSM:INIT:STATID=%" PRIuNodeId "\n"),(nodeId_t)MY_NODE_ID);
 			// Set static ID
-			_transportConfig.nodeId = (uint8_t)MY_NODE_ID;
+			_transportConfig.nodeId = (nodeId_t)MY_NODE_ID;
 			// Save static ID to eeprom (for bootloader)
 			hwWriteConfig(EEPROM_NODE_ID_ADDRESS, (uint8_t)MY_NODE_ID);
 		}
@@ -150,17 +200,24 @@ void stParentTransition(void)
 	TRANSPORT_DEBUG(PSTR("TSM:FPAR:STATP=%" PRIu8 "\n"), (uint8_t)MY_PARENT_NODE_ID);	// static parent
 	_transportSM.findingParentNode = false;
 	_transportConfig.distanceGW = 1u;	// assumption, CHKUPL:GWDC will update this variable
-	_transportConfig.parentNodeId = (uint8_t)MY_PARENT_NODE_ID;
+	_transportConfig.parentNodeId = (nodeId_t)MY_PARENT_NODE_ID;
 	// save parent ID to eeprom (for bootloader)
 	hwWriteConfig(EEPROM_PARENT_NODE_ID_ADDRESS, (uint8_t)MY_PARENT_NODE_ID);
 #else
 	_transportSM.findingParentNode = true;
 	_transportConfig.distanceGW = DISTANCE_INVALID;	// Set distance to max and invalidate parent node ID
 	_transportConfig.parentNodeId = AUTO;
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	_transportSM.parentExtended = false;
+	// Broadcast find parent request, the payload asks parents relaying extended IDs to say so
+	(void)transportRouteMessage(build(_msgTmp, BROADCAST_ADDRESS, NODE_SENSOR_ID, C_INTERNAL,
+	                                  I_FIND_PARENT_REQUEST).set((uint8_t)PROTOCOL_VERSION_EXTENDED));
+#else
 	// Broadcast find parent request
 	(void)transportRouteMessage(build(_msgTmp, BROADCAST_ADDRESS, NODE_SENSOR_ID, C_INTERNAL,
 	                                  I_FIND_PARENT_REQUEST).set(""));
 #endif
+#endif
 }
 
 // stParentUpdate
@@ -215,8 +272,25 @@ void stIDTransition(void)
 		const uint8_t sensorID = NODE_SENSOR_ID;
 #endif
 		TRANSPORT_DEBUG(PSTR("TSM:ID:REQ\n"));	// request node ID
-		(void)transportRouteMessage(build(_msgTmp, GATEWAY_ADDRESS, sensorID, C_INTERNAL,
-		                                  I_ID_REQUEST).set(""));
+		(void)build(_msgTmp, GATEWAY_ADDRESS, sensorID, C_INTERNAL, I_ID_REQUEST).set("");
+#if !defined(MY_GATEWAY_FEATURE) && defined(MY_ID_REQUEST_TOKEN_FEATURE)
+		unique_id_t uniqueID;
+		if (hwUniqueID(&uniqueID)) {
+			// hardware token, a gateway allocating IDs hands out the same ID again
+			uint32_t token = 2166136261ul;	// FNV-1a
+			for (uint8_t i = 0; i < sizeof(unique_id_t); i++) {
+				token = (token ^ uniqueID[i]) * 16777619ul;
+			}
+			(void)_msgTmp.set(token);
+		}
+#endif
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+		if (_transportSM.parentExtended) {
+			// stays a version 3 frame only if every hop to the GW relays extended IDs
+			mSetVersion(_msgTmp, PROTOCOL_VERSION_EXTENDED);
+		}
+#endif
+		(void)transportRouteMessage(_msgTmp);
 	}
 }
 
@@ -289,12 +363,18 @@ void stUplinkUpdate(void)
 void stReadyTransition(void)
 {
 	// transport is ready and fully operational
-	TRANSPORT_DEBUG(PSTR("TSM:READY:ID=%" PRIu8 ",PAR=%" PRIu8 ",DIS=%" PRIu8 "\n"),
+	TRANSPORT_DEBUG(PSTR("TSM:READY:ID=%" PRIuNodeId ",PAR=%" PRIuNodeId ",DIS=%" PRIu8 "\n"),
 	                _transportConfig.nodeId,
 	                _transportConfig.parentNodeId, _transportConfig.distanceGW);
 	_transportSM.uplinkOk = true;
 	_transportSM.failureCounter = 0u;			// reset failure counter
 	_transportSM.failedUplinkTransmissions = 0u;	// reset failed uplink TX counter
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+	if (_transportStatsParent != AUTO && _transportStatsParent != _transportConfig.parentNodeId) {
+		_transportStats.parentChanges++;
+	}
+	_transportStatsParent = _transportConfig.parentNodeId;
+#endif
 	// callback
 	if (_transportReady_cb) {
 		_transportReady_cb();
@@ -326,12 +406,17 @@ void stReadyUpdate(void)
 	}
 #endif
 
-#if defined(MY_RAM_ROUTING_TABLE_ENABLED)
+#if defined(MY_RAM_ROUTING_TABLE_ENABLED) || defined(MY_ROUTE_CACHE_FEATURE)
 	if (hwMillis() - _lastRoutingTableSave > MY_ROUTING_TABLE_SAVE_INTERVAL_MS) {
 		_lastRoutingTableSave = hwMillis();
 		transportSaveRoutingTable();
 	}
 #endif
+#if defined(MY_TRANSPORT_STATS_FEATURE) && (MY_TRANSPORT_STATS_INTERVAL_MS > 0)
+	if (hwMillis() - _transportStatsReport > MY_TRANSPORT_STATS_INTERVAL_MS) {
+		(void)transportReportStats();
+	}
+#endif
 }
 
 // stFailure: entered upon HW init failure or max retries exceeded
@@ -362,6 +447,13 @@ void stFailureUpdate(void)
 
 void transportSwitchSM(transportState_t &newState)
 {
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+	if (_transportSM.currentState == &stParent) {
+		_transportStats.parentSeconds += (uint16_t)((transportTimeInState() + 500) / 1000);
+	} else if (_transportSM.currentState == &stFailure) {
+		_transportStats.failureSeconds += (uint16_t)((transportTimeInState() + 500) / 1000);
+	}
+#endif
 	if (_transportSM.currentState != &newState) {
 		_transportSM.stateRetries = 0u;	// state change, reset retry counter
 		_transportSM.currentState = &newState;	// change state
@@ -415,6 +507,28 @@ void transportInitialise(void)
 {
 	_transportSM.failureCounter = 0u;	// reset failure counter
 	transportLoadRoutingTable();		// load routing table to RAM (if feature enabled)
+#if defined(MY_TRANSPORT_RX_RATE_LIMIT_FEATURE)
+	// all buckets start full, node class is learned from traffic
+	for (uint16_t i = 0; i < SIZE_ROUTES; i++) {
+		_transportRxBuckets[i].lastRefill = hwMillis();
+		_transportRxBuckets[i].tokens = MY_TRANSPORT_RX_RATE_LIMIT_BURST;
+		_transportRxBuckets[i].repeater = false;
+		_transportRxBuckets[i].throttled = false;
+	}
+#endif
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+	(void)memset((void *)&_transportStats, 0, sizeof(_transportStats));
+	_transportStats.version = TRANSPORT_STATS_VERSION;
+	_transportStatsReport = hwMillis();
+#endif
+#if defined(MY_REPEATER_FEATURE) && defined(MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+	_transportForwardQueue.clear();
+	(void)memset((void *)&_transportForwardStats, 0, sizeof(_transportForwardStats));
+#endif
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+	// load frame key and counter once, transport re-initialisations keep the reservation
+	aeadInit();
+#endif
 	// initial state
 	_transportSM.currentState = NULL;
 	transportSwitchSM(stInit);
@@ -492,18 +606,25 @@ bool transportCheckUplink(const bool force)
 	}
 }
 
-bool transportAssignNodeID(const uint8_t newNodeId)
+bool transportAssignNodeID(const nodeId_t newNodeId)
 {
 	// verify if ID valid
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	if (newNodeId != GATEWAY_ADDRESS && newNodeId != AUTO && newNodeId <= EXTENDED_NODE_ID_LAST) {
+#else
 	if (newNodeId != GATEWAY_ADDRESS && newNodeId != AUTO) {
+#endif
 		_transportConfig.nodeId = newNodeId;
 		transportSetAddress(newNodeId);
 		// Write ID to EEPROM
-		hwWriteConfig(EEPROM_NODE_ID_ADDRESS, newNodeId);
-		TRANSPORT_DEBUG(PSTR("TSF:SID:OK,ID=%" PRIu8 "\n"),newNodeId);	// Node ID assigned
+		hwWriteConfig(EEPROM_NODE_ID_ADDRESS, (uint8_t)newNodeId);
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+		hwWriteConfig(EEPROM_NODE_ID_HIGH_ADDRESS, (uint8_t)(newNodeId >> 8));
+#endif
+		TRANSPORT_DEBUG(PSTR("TSF:SID:OK,ID=%" PRIuNodeId "\n"),newNodeId);	// Node ID assigned
 		return true;
 	} else {
-		TRANSPORT_DEBUG(PSTR("!TSF:SID:FAIL,ID=%" PRIu8 "\n"),newNodeId);	// ID is invalid, cannot assign ID
+		TRANSPORT_DEBUG(PSTR("!TSF:SID:FAIL,ID=%" PRIuNodeId "\n"),newNodeId);	// ID is invalid, cannot assign ID
 		setIndication(INDICATION_ERR_NET_FULL);
 		_transportConfig.nodeId = AUTO;
 		return false;
@@ -512,14 +633,22 @@ bool transportAssignNodeID(const uint8_t newNodeId)
 
 bool transportRouteMessage(MyMessage &message)
 {
-	const uint8_t destination = message.destination;
-	uint8_t route = _transportConfig.parentNodeId;	// by default, all traffic is routed via parent node
+	const nodeId_t destination = message.destination;
+	nodeId_t route = _transportConfig.parentNodeId;	// by default, all traffic is routed via parent node
 
 	if (_transportSM.findingParentNode && destination != BROADCAST_ADDRESS) {
 		TRANSPORT_DEBUG(PSTR("!TSF:RTE:FPAR ACTIVE\n")); // find parent active, message not sent
 		// request to send a non-BC message while finding parent active, abort
 		return false;
 	}
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	if ((message.sender > 0xFFu || destination > 0xFFu || _transportConfig.nodeId > 0xFFu) &&
+	        mGetLength(message) > MAX_PAYLOAD_EXTENDED) {
+		// needs a version 3 frame, which has no room for the payload
+		TRANSPORT_DEBUG(PSTR("!TSF:RTE:LEN=%" PRIu8 ",EXT\n"), mGetLength(message));
+		return false;
+	}
+#endif
 
 	if (destination == GATEWAY_ADDRESS) {
 		route = _transportConfig.parentNodeId;		// message to GW always routes via parent
@@ -530,7 +659,7 @@ bool transportRouteMessage(MyMessage &message)
 		// destination not GW & not BC, get route
 		route = transportGetRoute(destination);
 		if (route == AUTO) {
-			TRANSPORT_DEBUG(PSTR("!TSF:RTE:%" PRIu8 " UNKNOWN\n"), destination);	// route unknown
+			TRANSPORT_DEBUG(PSTR("!TSF:RTE:%" PRIuNodeId " UNKNOWN\n"), destination);	// route unknown
 #if !defined(MY_GATEWAY_FEATURE)
 			if (message.last != _transportConfig.parentNodeId) {
 				// message not from parent, i.e. child node - route it to parent
@@ -552,12 +681,15 @@ bool transportRouteMessage(MyMessage &message)
 				return true;
 			}
 			TRANSPORT_DEBUG(PSTR("!TSF:RTE:N2N FAIL\n"));
+			TRANSPORT_STATS_INC(txReroutes);
 		}
 		route = _transportConfig.parentNodeId;	// not a repeater, all traffic routed via parent
 #endif
 	}
 	// send message
+	MY_TRACE_MSG(route, message, route);
 	const bool result = transportSendWrite(route, message);
+	MY_TRACE_MSG(route__done, message, result);
 #if !defined(MY_GATEWAY_FEATURE)
 	// update counter
 	if (route == _transportConfig.parentNodeId) {
@@ -613,10 +745,10 @@ bool transportWait(const uint32_t waitingMS, const uint8_t cmd, const uint8_t ms
 	return expectedResponse;
 }
 
-uint8_t transportPingNode(const uint8_t targetId)
+uint8_t transportPingNode(const nodeId_t targetId)
 {
 	if(!_transportSM.pingActive) {
-		TRANSPORT_DEBUG(PSTR("TSF:PNG:SEND,TO=%" PRIu8 "\n"), targetId);
+		TRANSPORT_DEBUG(PSTR("TSF:PNG:SEND,TO=%" PRIuNodeId "\n"), targetId);
 		if(targetId == _transportConfig.nodeId) {
 			// pinging self
 			_transportSM.pingResponse = 0u;
@@ -648,8 +780,32 @@ void transportProcessMessage(void)
 	(void)signerCheckTimer();
 	// receive message
 	setIndication(INDICATION_RX);
-	uint8_t payloadLength = transportReceive((uint8_t *)
-	                        &_msg.last); // last is the first byte of the payload buffer
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+	// a sealed frame is longer than a message
+	uint8_t frame[MAX_MESSAGE_LENGTH];
+#elif defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	// the header extension is unpacked into the wider node ID fields
+	uint8_t frame[MAX_MESSAGE_LENGTH];
+#else
+	uint8_t *frame = (uint8_t *)&_msg.last; // last is the first byte of the payload buffer
+#endif
+	uint8_t payloadLength = transportReceive(frame);
+	if (hwCaptureActive()) {
+		hwCaptureFrame(HW_CAPTURE_RX, frame[0], transportGetSignalReport(SR_RX_RSSI),
+		               transportGetSignalReport(SR_RX_SNR), frame, payloadLength);
+	}
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+	// Reject frames failing authentication or replayed
+	payloadLength = aeadOpen(frame, payloadLength);
+	if (!payloadLength) {
+		setIndication(INDICATION_ERR_SIGN);
+		TRANSPORT_STATS_INC(rxDrops);
+		return;
+	}
+	(void)memcpy((void *)&_msg.last, (const void *)frame, payloadLength);
+#elif defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	payloadLength = _msg.setFrame(frame, payloadLength);
+#endif
 	// get message length and limit size
 	const uint8_t msgLength = min(mGetLength(_msg), (uint8_t)MAX_PAYLOAD);
 	// calculate expected length
@@ -660,11 +816,12 @@ void transportProcessMessage(void)
 #endif
 	const uint8_t command = mGetCommand(_msg);
 	const uint8_t type = _msg.type;
-	const uint8_t sender = _msg.sender;
-	const uint8_t last = _msg.last;
-	const uint8_t destination = _msg.destination;
+	const nodeId_t sender = _msg.sender;
+	const nodeId_t last = _msg.last;
+	const nodeId_t destination = _msg.destination;
 
-	TRANSPORT_DEBUG(PSTR("TSF:MSG:READ,%" PRIu8 "-%" PRIu8 "-%" PRIu8 ",s=%" PRIu8 ",c=%" PRIu8 ",t=%"
+	MY_TRACE_MSG(msg__rx, _msg, payloadLength);
+	TRANSPORT_DEBUG(PSTR("TSF:MSG:READ,%" PRIuNodeId "-%" PRIuNodeId "-%" PRIuNodeId ",s=%" PRIu8 ",c=%" PRIu8 ",t=%"
 	                     PRIu8 ",pt=%" PRIu8 ",l=%" PRIu8 ",sg=%" PRIu8 ":%s\n"),
 	                sender, last, destination, _msg.sensor, command, type, mGetPayloadType(_msg), msgLength,
 	                mGetSigned(_msg), ((command == C_INTERNAL &&
@@ -675,14 +832,22 @@ void transportProcessMessage(void)
 		setIndication(INDICATION_ERR_LENGTH);
 		TRANSPORT_DEBUG(PSTR("!TSF:MSG:LEN=%" PRIu8 ",EXP=%" PRIu8 "\n"), payloadLength,
 		                expectedMessageLength); // invalid payload length
+		TRANSPORT_STATS_INC(rxDrops);
 		return;
 	}
 
 	// Reject messages with incorrect protocol version
-	if (mGetVersion(_msg) != PROTOCOL_VERSION) {
+	if (!isValidProtocolVersion(mGetVersion(_msg))) {
 		setIndication(INDICATION_ERR_VERSION);
 		TRANSPORT_DEBUG(PSTR("!TSF:MSG:PVER,%" PRIu8 "!=%" PRIu8 "\n"), mGetVersion(_msg),
 		                PROTOCOL_VERSION);	// protocol version mismatch
+		TRANSPORT_STATS_INC(rxDrops);
+		return;
+	}
+
+	// Drop messages of senders exceeding their rate, before spending time on verification and routing
+	if (!transportCheckRxRateLimit(sender, last)) {
+		TRANSPORT_STATS_INC(rxDrops);
 		return;
 	}
 
@@ -690,6 +855,7 @@ void transportProcessMessage(void)
 	if (!signerVerifyMsg(_msg)) {
 		setIndication(INDICATION_ERR_SIGN);
 		TRANSPORT_DEBUG(PSTR("!TSF:MSG:SIGN VERIFY FAIL\n"));
+		TRANSPORT_STATS_INC(rxDrops);
 		return;
 	}
 
@@ -711,6 +877,16 @@ void transportProcessMessage(void)
 
 	// set message received flag
 	_transportSM.msgReceived = true;
+#if defined(MY_GATEWAY_ID_ALLOCATION_FEATURE)
+	if (isLegacyNodeId(sender)) {
+		idAllocatorSeen(sender);
+	}
+#endif
+#if defined(MY_GATEWAY_LIVENESS_FEATURE)
+	if (isLegacyNodeId(sender)) {
+		livenessSeen(sender);
+	}
+#endif
 
 	// Is message addressed to this node?
 	if (destination == _transportConfig.nodeId) {
@@ -725,6 +901,9 @@ void transportProcessMessage(void)
 			mSetRequestAck(_msgTmp,
 			               false); // Reply without ack flag (otherwise we would end up in an eternal loop)
 			mSetAck(_msgTmp, true); // set ACK flag
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+			mSetVersion(_msgTmp, PROTOCOL_VERSION);	// the version of the request is not echoed
+#endif
 			_msgTmp.sender = _transportConfig.nodeId;
 			_msgTmp.destination = sender;
 			// send ACK, use transportSendRoute since ACK reply is not internal, i.e. if !transportOK do not reply
@@ -742,7 +921,16 @@ void transportProcessMessage(void)
 #if (MY_NODE_ID == AUTO)
 					// only active if node ID dynamic
 					if ((_msg.sensor == _transportToken) || (_msg.sensor == AUTO)) {
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+						const nodeId_t newNodeId = mGetPayloadType(_msg) == P_BYTE ? _msg.getByte() : _msg.getUInt();
+						if (isLegacyNodeId(newNodeId) || _transportSM.parentExtended) {
+							(void)transportAssignNodeID(newNodeId);
+						} else {
+							TRANSPORT_DEBUG(PSTR("!TSF:MSG:ID EXT,ID=%" PRIuNodeId "\n"), newNodeId);	// parent cannot relay extended IDs
+						}
+#else
 						(void)transportAssignNodeID(_msg.getByte());
+#endif
 					} else {
 						TRANSPORT_DEBUG(PSTR("!TSF:MSG:ID TK INVALID\n"));
 					}
@@ -758,15 +946,18 @@ void transportProcessMessage(void)
 							distance++;	// Distance to gateway is one more for us w.r.t. parent
 							// update settings if distance shorter or preferred parent found
 							if (((isValidDistance(distance) && distance < _transportConfig.distanceGW) || (!_autoFindParent &&
-							        sender == (uint8_t)MY_PARENT_NODE_ID)) && !_transportSM.preferredParentFound) {
+							        sender == (nodeId_t)MY_PARENT_NODE_ID)) && !_transportSM.preferredParentFound) {
 								// Found a neighbor closer to GW than previously found
-								if (!_autoFindParent && sender == (uint8_t)MY_PARENT_NODE_ID) {
+								if (!_autoFindParent && sender == (nodeId_t)MY_PARENT_NODE_ID) {
 									_transportSM.preferredParentFound = true;
 									TRANSPORT_DEBUG(PSTR("TSF:MSG:FPAR PREF\n"));	// find parent, preferred parent found
 								}
 								_transportConfig.distanceGW = distance;
 								_transportConfig.parentNodeId = sender;
-								TRANSPORT_DEBUG(PSTR("TSF:MSG:FPAR OK,ID=%" PRIu8 ",D=%" PRIu8 "\n"), _transportConfig.parentNodeId,
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+								_transportSM.parentExtended = mGetVersion(_msg) == PROTOCOL_VERSION_EXTENDED;
+#endif
+								TRANSPORT_DEBUG(PSTR("TSF:MSG:FPAR OK,ID=%" PRIuNodeId ",D=%" PRIu8 "\n"), _transportConfig.parentNodeId,
 								                _transportConfig.distanceGW);
 							}
 						}
@@ -779,7 +970,7 @@ void transportProcessMessage(void)
 #endif // !defined(MY_GATEWAY_FEATURE)
 				// general
 				if (type == I_PING) {
-					TRANSPORT_DEBUG(PSTR("TSF:MSG:PINGED,ID=%" PRIu8 ",HP=%" PRIu8 "\n"), sender,
+					TRANSPORT_DEBUG(PSTR("TSF:MSG:PINGED,ID=%" PRIuNodeId ",HP=%" PRIu8 "\n"), sender,
 					                _msg.getByte()); // node pinged
 #if defined(MY_GATEWAY_FEATURE) && (F_CPU>16000000)
 					// delay for fast GW and slow nodes
@@ -822,6 +1013,22 @@ void transportProcessMessage(void)
 					                                  I_SIGNAL_REPORT_RESPONSE).set(value));
 					return; // no further processing required
 				}
+#if defined(MY_GATEWAY_ID_ALLOCATION_FEATURE)
+				if (type == I_ID_REQUEST && idAllocatorRequest(_msg)) {
+					return; // answered by the gateway, no further processing required
+				}
+#endif
+#if defined(MY_GATEWAY_FEATURE) && defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+				if (type == I_ID_REQUEST && mGetVersion(_msg) == PROTOCOL_VERSION_EXTENDED && !mGetLength(_msg)) {
+					// every hop relays extended IDs, the controller may assign one
+					(void)_msg.set((uint8_t)PROTOCOL_VERSION_EXTENDED);
+				}
+#endif
+#if defined(MY_GATEWAY_LINK_HEALTH_FEATURE)
+				if (type == I_TRANSPORT_STATS && isLegacyNodeId(sender)) {
+					linkHealthReport(_msg);	// report is handed over to the controller as well
+				}
+#endif
 				if (_processInternalCoreMessage()) {
 					return; // no further processing required
 				}
@@ -835,6 +1042,9 @@ void transportProcessMessage(void)
 		} else {
 			TRANSPORT_DEBUG(
 			    PSTR("TSF:MSG:ACK\n")); // received message is ACK, no internal processing, handover to msg callback
+#if defined(MY_SEND_QUEUE_FEATURE)
+			_sendQueueAck(_msg);
+#endif
 		}
 #if defined(MY_OTA_LOG_RECEIVER_FEATURE)
 		if ((type == I_LOG_MESSAGE) && (command == C_INTERNAL)) {
@@ -844,7 +1054,7 @@ void transportProcessMessage(void)
 #endif //defined(MY_OTA_LOG_RECEIVER_FEATURE)
 #if defined(MY_GATEWAY_FEATURE)
 		// Hand over message to controller
-		(void)gatewayTransportSend(_msg);
+		(void)gatewayTransportDeliver(_msg);
 #endif
 		// Call incoming message callback if available
 		if (receive) {
@@ -858,7 +1068,12 @@ void transportProcessMessage(void)
 				if (type == I_FIND_PARENT_REQUEST) {
 #if defined(MY_REPEATER_FEATURE)
 					if (sender != _transportConfig.parentNodeId) {	// no circular reference
-						TRANSPORT_DEBUG(PSTR("TSF:MSG:FPAR REQ,ID=%" PRIu8 "\n"), sender);	// FPAR: find parent request
+						TRANSPORT_DEBUG(PSTR("TSF:MSG:FPAR REQ,ID=%" PRIuNodeId "\n"), sender);	// FPAR: find parent request
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+						// the uplink check below receives into _msg
+						const bool extendedRequest = mGetPayloadType(_msg) == P_BYTE &&
+						                             _msg.getByte() == PROTOCOL_VERSION_EXTENDED;
+#endif
 						// check if uplink functional - node can only be parent node if link to GW functional
 						// this also prevents circular references in case GW ooo
 						if (transportCheckUplink()) {
@@ -866,8 +1081,15 @@ void transportProcessMessage(void)
 							TRANSPORT_DEBUG(PSTR("TSF:MSG:GWL OK\n")); // GW uplink ok
 							// random delay minimizes collisions
 							delay(hwMillis() & 0x3ff);
-							(void)transportRouteMessage(build(_msgTmp, sender, NODE_SENSOR_ID, C_INTERNAL,
-							                                  I_FIND_PARENT_RESPONSE).set(_transportConfig.distanceGW));
+							(void)build(_msgTmp, sender, NODE_SENSOR_ID, C_INTERNAL,
+							            I_FIND_PARENT_RESPONSE).set(_transportConfig.distanceGW);
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+							if (extendedRequest) {
+								// a version 3 answer tells the node this parent relays extended IDs
+								mSetVersion(_msgTmp, PROTOCOL_VERSION_EXTENDED);
+							}
+#endif
+							(void)transportRouteMessage(_msgTmp);
 						} else {
 							TRANSPORT_DEBUG(PSTR("!TSF:MSG:GWL FAIL\n")); // GW uplink fail, do not respond to parent request
 						}
@@ -897,7 +1119,7 @@ void transportProcessMessage(void)
 		if(last == _transportConfig.parentNodeId && sender != _transportConfig.nodeId &&
 		        isTransportReady()) {
 			TRANSPORT_DEBUG(PSTR("TSF:MSG:FWD BC MSG\n")); // controlled broadcast msg forwarding
-			(void)transportRouteMessage(_msg);
+			transportForwardMessage(_msg);
 		}
 #endif
 
@@ -911,7 +1133,7 @@ void transportProcessMessage(void)
 #endif
 #if defined(MY_GATEWAY_FEATURE)
 			// Hand over message to controller
-			(void)gatewayTransportSend(_msg);
+			(void)gatewayTransportDeliver(_msg);
 #endif
 			if (receive) {
 				TRANSPORT_DEBUG(PSTR("TSF:MSG:RCV CB\n")); // hand over message to receive callback function
@@ -935,7 +1157,7 @@ void transportProcessMessage(void)
 			}
 			// Relay this message to another node
 			TRANSPORT_DEBUG(PSTR("TSF:MSG:REL MSG\n"));	// relay msg
-			(void)transportRouteMessage(_msg);
+			transportForwardMessage(_msg);
 		}
 #else
 		TRANSPORT_DEBUG(PSTR("!TSF:MSG:REL MSG,NREP\n"));	// message relaying request, but not a repeater
@@ -975,6 +1197,13 @@ void transportProcessFIFO(void)
 	while (transportAvailable() && _processedMessages--) {
 		transportProcessMessage();
 	}
+#if defined(MY_REPEATER_FEATURE) && defined(MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+	// relay queued messages, one per pass and more while no frame is waiting
+	if (transportForwardNext()) {
+		while (!transportAvailable() && transportForwardNext()) {
+		}
+	}
+#endif
 #if defined(MY_OTA_FIRMWARE_FEATURE)
 	if (isTransportReady()) {
 		// only process if transport ok
@@ -983,7 +1212,7 @@ void transportProcessFIFO(void)
 #endif
 }
 
-bool transportSendWrite(const uint8_t to, MyMessage &message)
+bool transportSendWrite(const nodeId_t to, MyMessage &message)
 {
 	message.last = _transportConfig.nodeId; // Update last
 	// sign message if required
@@ -997,14 +1226,57 @@ bool transportSendWrite(const uint8_t to, MyMessage &message)
 	const uint8_t totalMsgLength = HEADER_SIZE + ( mGetSigned(message) ? MAX_PAYLOAD : mGetLength(
 	                                   message) );
 
+#if defined(MY_TRANSPORT_AEAD_FEATURE)
+	// encrypt and authenticate
+	uint8_t frame[MAX_MESSAGE_LENGTH];
+	(void)memcpy((void *)frame, (const void *)&message, totalMsgLength);
+	const uint8_t frameLength = aeadSeal(frame, totalMsgLength);
+	if (!frameLength) {
+		setIndication(INDICATION_ERR_SIGN);
+		return false;
+	}
+#elif defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	// a version 3 request only goes to a parent relaying extended IDs, other nodes get version 2
+	// frames unless a node ID needs the header extension
+	uint8_t frame[MAX_MESSAGE_LENGTH];
+	const uint8_t frameLength = message.getFrame(frame,
+	                            mGetVersion(message) == PROTOCOL_VERSION_EXTENDED &&
+	                            (to != _transportConfig.parentNodeId || _transportSM.parentExtended));
+	if (!frameLength) {
+		TRANSPORT_DEBUG(PSTR("!TSF:MSG:LEN=%" PRIu8 ",EXT\n"), totalMsgLength);	// payload exceeds version 3 frame
+		return false;
+	}
+#else
+	const uint8_t *frame = (const uint8_t *)&message;
+	const uint8_t frameLength = min((uint8_t)MAX_MESSAGE_LENGTH, totalMsgLength);
+#endif
+
 	// send
 	setIndication(INDICATION_TX);
-	bool result = transportSend(to, &message, min((uint8_t)MAX_MESSAGE_LENGTH, totalMsgLength),
-	                            _transportConfig.passiveMode);
+	MY_TRACE_RADIO(radio__send, to, frameLength, 0);
+	bool result = transportSend(to, frame, frameLength, _transportConfig.passiveMode);
+	MY_TRACE_RADIO(radio__send__done, to, frameLength, result);
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+	const int16_t txPower = transportGetTxPowerPercent();
+	if (!_transportStats.txAttempts) {
+		_transportStats.txPowerPercent = (uint8_t)constrain(txPower, 0, 100);
+	} else {
+		_transportStats.txPowerPercent += (constrain(txPower, 0, 100) - _transportStats.txPowerPercent) / 8;
+	}
+	_transportStats.txAttempts++;
+	if (!result && to != BROADCAST_ADDRESS && !_transportConfig.passiveMode) {
+		_transportStats.txFailures++;
+	}
+#endif
+	if (hwCaptureActive()) {
+		hwCaptureFrame(_transportConfig.passiveMode ? HW_CAPTURE_TX_NO_ACK : result ? HW_CAPTURE_TX_OK :
+		               HW_CAPTURE_TX_NACK, (uint8_t)to, transportGetSignalReport(SR_TX_RSSI),
+		               transportGetSignalReport(SR_TX_SNR), frame, frameLength);
+	}
 	// broadcasting (workaround counterfeits)
 	result |= (to == BROADCAST_ADDRESS);
 
-	TRANSPORT_DEBUG(PSTR("%sTSF:MSG:SEND,%" PRIu8 "-%" PRIu8 "-%" PRIu8 "-%" PRIu8 ",s=%" PRIu8 ",c=%"
+	TRANSPORT_DEBUG(PSTR("%sTSF:MSG:SEND,%" PRIuNodeId "-%" PRIuNodeId "-%" PRIuNodeId "-%" PRIuNodeId ",s=%" PRIu8 ",c=%"
 	                     PRIu8 ",t=%" PRIu8 ",pt=%" PRIu8 ",l=%" PRIu8 ",sg=%" PRIu8 ",ft=%" PRIu8 ",st=%s:%s\n"),
 	                (_transportConfig.passiveMode ? "?" : result ? "" : "!"), message.sender, message.last, to,
 	                message.destination,
@@ -1024,11 +1296,11 @@ void transportRegisterReadyCallback(transportCallback_t cb)
 	_transportReady_cb = cb;
 }
 
-uint8_t transportGetNodeId(void)
+nodeId_t transportGetNodeId(void)
 {
 	return _transportConfig.nodeId;
 }
-uint8_t transportGetParentNodeId(void)
+nodeId_t transportGetParentNodeId(void)
 {
 	return _transportConfig.parentNodeId;
 }
@@ -1038,20 +1310,65 @@ uint8_t transportGetDistanceGW(void)
 }
 
 
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+// extended routes are kept in RAM only and learned again after a restart
+static void transportClearExtendedRoutes(void)
+{
+	for (uint16_t i = 0; i < MY_EXTENDED_ROUTES; i++) {
+		_transportExtendedRoutes[i].node = AUTO;
+		_transportExtendedRoutes[i].route = AUTO;
+	}
+}
+
+// open addressing over a few slots, a full neighbourhood gives up the route in the home slot
+static transportExtendedRoute_t *transportExtendedRouteEntry(const nodeId_t node, const bool insert)
+{
+	const uint16_t home = node & (MY_EXTENDED_ROUTES - 1u);
+	transportExtendedRoute_t *unused = NULL;
+	for (uint8_t probe = 0; probe < EXTENDED_ROUTE_PROBES; probe++) {
+		transportExtendedRoute_t *entry = &_transportExtendedRoutes[(home + probe) & (MY_EXTENDED_ROUTES -
+		                                  1u)];
+		if (entry->node == node) {
+			return entry;
+		}
+		if (unused == NULL && entry->route == AUTO) {
+			unused = entry;
+		}
+	}
+	if (!insert) {
+		return NULL;
+	}
+	if (unused == NULL) {
+		unused = &_transportExtendedRoutes[home];
+	}
+	unused->node = node;
+	return unused;
+}
+#endif
+
 void transportClearRoutingTable(void)
 {
 	for (uint16_t i = 0; i < SIZE_ROUTES; i++) {
 		transportSetRoute((uint8_t)i, BROADCAST_ADDRESS);
 	}
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+	transportClearExtendedRoutes();
+#endif
 	transportSaveRoutingTable();	// save cleared routing table to EEPROM (if feature enabled)
 	TRANSPORT_DEBUG(PSTR("TSF:CRT:OK\n"));	// clear routing table
 }
 
 void transportLoadRoutingTable(void)
 {
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+	transportClearExtendedRoutes();
+#endif
 #if defined(MY_RAM_ROUTING_TABLE_ENABLED)
 	hwReadConfigBlock((void*)&_transportRoutingTable.route, (void*)EEPROM_ROUTES_ADDRESS, SIZE_ROUTES);
 	TRANSPORT_DEBUG(PSTR("TSF:LRT:OK\n"));	//  load routing table
+#elif defined(MY_ROUTE_CACHE_FEATURE)
+	// routes are read from EEPROM when first used
+	(void)memset((void *)_transportRouteCache, 0, sizeof(_transportRouteCache));
 #endif
 }
 
@@ -1060,42 +1377,287 @@ void transportSaveRoutingTable(void)
 #if defined(MY_RAM_ROUTING_TABLE_ENABLED)
 	hwWriteConfigBlock((void*)&_transportRoutingTable.route, (void*)EEPROM_ROUTES_ADDRESS, SIZE_ROUTES);
 	TRANSPORT_DEBUG(PSTR("TSF:SRT:OK\n"));	//  save routing table
+#elif defined(MY_ROUTE_CACHE_FEATURE)
+	for (uint8_t i = 0; i < MY_ROUTE_CACHE_SIZE; i++) {
+		routeCacheEntry_t &entry = _transportRouteCache[i];
+		if (entry.valid && entry.dirty) {
+			hwWriteConfig(EEPROM_ROUTES_ADDRESS + entry.node, entry.route);
+			entry.dirty = false;
+		}
+	}
+	TRANSPORT_DEBUG(PSTR("TSF:SRT:OK\n"));	//  save routing table
 #endif
 }
 
-void transportSetRoute(const uint8_t node, const uint8_t route)
+#if defined(MY_ROUTE_CACHE_FEATURE)
+// move the route of node to the front of the cache, loaded from EEPROM if not cached
+static routeCacheEntry_t &transportRouteCacheEntry(const uint8_t node)
+{
+	uint8_t index = 0;
+	while (index < MY_ROUTE_CACHE_SIZE - 1 && !(_transportRouteCache[index].valid &&
+	        _transportRouteCache[index].node == node)) {
+		index++;
+	}
+	routeCacheEntry_t entry = _transportRouteCache[index];
+	if (!entry.valid || entry.node != node) {
+		// miss, the least recently used entry is replaced, a changed route is written back
+		if (entry.valid && entry.dirty) {
+			hwWriteConfig(EEPROM_ROUTES_ADDRESS + entry.node, entry.route);
+		}
+		entry.node = node;
+		entry.route = hwReadConfig(EEPROM_ROUTES_ADDRESS + node);
+		entry.valid = true;
+		entry.dirty = false;
+	}
+	(void)memmove((void *)&_transportRouteCache[1], (void *)&_transportRouteCache[0],
+	              index * sizeof(routeCacheEntry_t));
+	_transportRouteCache[0] = entry;
+	return _transportRouteCache[0];
+}
+#endif
+
+void transportSetRoute(const nodeId_t node, const nodeId_t route)
 {
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+	// a route to or via an extended ID is hashed, an 8 bit node has its route in one table only
+	if (isLegacyNodeId(node) && !isLegacyNodeId(route)) {
+		transportSetRoute(node, BROADCAST_ADDRESS);
+	}
+	if (!isLegacyNodeId(node) || !isLegacyNodeId(route)) {
+		transportExtendedRouteEntry(node, true)->route = route;
+		return;
+	}
+	transportExtendedRoute_t *extended = transportExtendedRouteEntry(node, false);
+	if (extended != NULL) {
+		extended->route = AUTO;
+	}
+#endif
 #if defined(MY_RAM_ROUTING_TABLE_ENABLED)
 	_transportRoutingTable.route[node] = route;
+#elif defined(MY_ROUTE_CACHE_FEATURE)
+	routeCacheEntry_t &entry = transportRouteCacheEntry(node);
+	if (entry.route != route) {
+		entry.route = route;
+		entry.dirty = true;
+	}
 #else
 	hwWriteConfig(EEPROM_ROUTES_ADDRESS + node, route);
 #endif
 }
 
-uint8_t transportGetRoute(const uint8_t node)
+nodeId_t transportGetRoute(const nodeId_t node)
 {
-	uint8_t result;
+	nodeId_t result;
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+	if (!isLegacyNodeId(node)) {
+		const transportExtendedRoute_t *extended = transportExtendedRouteEntry(node, false);
+		return (extended != NULL) ? extended->route : (nodeId_t)AUTO;
+	}
+#endif
 #if defined(MY_RAM_ROUTING_TABLE_ENABLED)
 	result = _transportRoutingTable.route[node];
+#elif defined(MY_ROUTE_CACHE_FEATURE)
+	result = transportRouteCacheEntry(node).route;
 #else
 	result = hwReadConfig(EEPROM_ROUTES_ADDRESS + node);
 #endif
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE) && defined(MY_REPEATER_FEATURE)
+	if (result == AUTO) {
+		// 8 bit node behind an extended repeater
+		const transportExtendedRoute_t *extended = transportExtendedRouteEntry(node, false);
+		if (extended != NULL) {
+			result = extended->route;
+		}
+	}
+#endif
+	return result;
+}
+
+bool transportCheckRxRateLimit(const nodeId_t sender, const nodeId_t last)
+{
+#if defined(MY_TRANSPORT_RX_RATE_LIMIT_FEATURE)
+	if (sender == _transportConfig.nodeId) {
+		// never throttle own messages, e.g. relayed BC
+		return true;
+	}
+	// charge the last hop, it is the neighbour spending airtime on this link, i.e. relayed
+	// traffic counts against the repeater and its (larger) repeater bucket
+	transportRxBucket_t &bucket = _transportRxBuckets[transportNodeSlot(last)];
+	if (last != sender) {
+		// last hop relayed this message, classify as repeater
+		bucket.repeater = true;
+	}
+	const uint32_t interval = bucket.repeater ? MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_INTERVAL_MS :
+	                          MY_TRANSPORT_RX_RATE_LIMIT_INTERVAL_MS;
+	const uint8_t burst = bucket.repeater ? MY_TRANSPORT_RX_RATE_LIMIT_REPEATER_BURST :
+	                      MY_TRANSPORT_RX_RATE_LIMIT_BURST;
+	// refill
+	const uint32_t refill = (hwMillis() - bucket.lastRefill) / interval;
+	if (bucket.tokens >= burst || refill >= (uint32_t)(burst - bucket.tokens)) {
+		bucket.tokens = burst;
+		bucket.lastRefill = hwMillis();
+		if (bucket.throttled) {
+			bucket.throttled = false;
+			TRANSPORT_DEBUG(PSTR("TSF:MSG:THR END,ID=%" PRIuNodeId "\n"), last);	// throttle lifted
+		}
+	} else {
+		bucket.tokens += (uint8_t)refill;
+		bucket.lastRefill += refill * interval;
+	}
+	if (bucket.tokens) {
+		bucket.tokens--;
+		return true;
+	}
+	// bucket empty, report once per throttle period
+	if (!bucket.throttled) {
+		bucket.throttled = true;
+		TRANSPORT_DEBUG(PSTR("!TSF:MSG:THR,ID=%" PRIuNodeId "\n"), last);	// neighbour throttled
+		char logBuf[MAX_PAYLOAD + 1];
+		(void)snprintf_P(logBuf, sizeof(logBuf), PSTR("TSF:MSG:THR,ID=%" PRIuNodeId), last);
+#if defined(MY_GATEWAY_FEATURE)
+		(void)gatewayTransportSend(buildGw(_msgTmp, I_LOG_MESSAGE).set(logBuf));
+#else
+		if (isTransportReady()) {
+			(void)transportRouteMessage(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL,
+			                                  I_LOG_MESSAGE).set(logBuf));
+		}
+#endif
+	}
+	return false;
+#else
+	(void)sender;
+	(void)last;
+	return true;
+#endif
+}
+
+#if defined(MY_REPEATER_FEATURE) && defined(MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+static void transportForwardReport(const char *logBuf)
+{
+#if defined(MY_GATEWAY_FEATURE)
+	(void)gatewayTransportSend(buildGw(_msgTmp, I_LOG_MESSAGE).set(logBuf));
+#else
+	if (isTransportReady()) {
+		(void)transportRouteMessage(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL,
+		                                  I_LOG_MESSAGE).set(logBuf));
+	}
+#endif
+}
+#endif
+
+void transportForwardMessage(MyMessage &message)
+{
+#if defined(MY_REPEATER_FEATURE) && defined(MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+	transportForwardEntry_t *entry = _transportForwardQueue.getFront();
+	if (entry != NULL) {
+		entry->queued = hwMillis();
+		entry->message = message;
+		(void)_transportForwardQueue.pushFront(entry);
+		TRANSPORT_DEBUG(PSTR("TSF:FWQ:ADD,N=%" PRIu8 "\n"), _transportForwardQueue.available());
+		return;
+	}
+	if (_transportForwardStats.dropped < 0xFFFFu) {
+		_transportForwardStats.dropped++;
+	}
+	TRANSPORT_DEBUG(PSTR("!TSF:FWQ:OVF,D=%" PRIu16 "\n"), _transportForwardStats.dropped);
+	// report once per overflow, details follow when the queue drained
+	if (!_transportForwardStats.overflow) {
+		_transportForwardStats.overflow = true;
+		char logBuf[MAX_PAYLOAD + 1];
+		(void)snprintf_P(logBuf, sizeof(logBuf), PSTR("TSF:FWQ:OVF"));
+		transportForwardReport(logBuf);
+	}
+#else
+	(void)transportRouteMessage(message);
+#endif
+}
+
+bool transportForwardNext(void)
+{
+#if defined(MY_REPEATER_FEATURE) && defined(MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+	if (_transportForwarding || !isTransportReady()) {
+		// queue is serviced again when the current message is out or transport is back
+		return false;
+	}
+	transportForwardEntry_t *entry = _transportForwardQueue.getBack();
+	if (entry == NULL) {
+		return false;
+	}
+	MyMessage message = entry->message;
+	uint32_t latency = hwMillis() - entry->queued;
+	// free the entry first, messages received meanwhile can be queued
+	(void)_transportForwardQueue.popBack();
+	TRANSPORT_DEBUG(PSTR("TSF:FWQ:FWD,L=%" PRIu32 "\n"), latency);
+	_transportForwarding = true;
+	(void)transportRouteMessage(message);
+	_transportForwarding = false;
+	if (latency > 0xFFFFu) {
+		latency = 0xFFFFu;
+	}
+	if (latency > _transportForwardStats.maxLatency) {
+		_transportForwardStats.maxLatency = (uint16_t)latency;
+	}
+	if (_transportForwardStats.forwarded < 0xFFFFu) {
+		_transportForwardStats.forwarded++;
+	}
+	if (_transportForwardStats.overflow && _transportForwardQueue.empty()) {
+		_transportForwardStats.overflow = false;
+		TRANSPORT_DEBUG(PSTR("TSF:FWQ:DRAINED,D=%" PRIu16 ",L=%" PRIu16 "\n"),
+		                _transportForwardStats.dropped, _transportForwardStats.maxLatency);
+		char logBuf[MAX_PAYLOAD + 1];
+		(void)snprintf_P(logBuf, sizeof(logBuf), PSTR("TSF:FWQ:D=%" PRIu16 ",L=%" PRIu16),
+		                 _transportForwardStats.dropped, _transportForwardStats.maxLatency);
+		transportForwardReport(logBuf);
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool transportReportStats(void)
+{
+#if defined(MY_TRANSPORT_STATS_FEATURE)
+	_transportStatsReport = hwMillis();
+	TRANSPORT_DEBUG(PSTR("TSF:STS:SEQ=%" PRIu8 ",TX=%" PRIu16 ",FAIL=%" PRIu16 "\n"),
+	                _transportStats.sequence, _transportStats.txAttempts, _transportStats.txFailures);
+	const bool result = _sendRoute(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL,
+	                                     I_TRANSPORT_STATS).set((void *)&_transportStats, sizeof(transportStats_t)));
+	// 0 marks the first report after boot only
+	if (!++_transportStats.sequence) {
+		_transportStats.sequence = 1;
+	}
 	return result;
+#else
+	return false;
+#endif
 }
 
 void transportReportRoutingTable(void)
 {
 #if defined(MY_REPEATER_FEATURE)
 	for (uint16_t cnt = 0; cnt < SIZE_ROUTES; cnt++) {
-		const uint8_t route = transportGetRoute(cnt);
+		const nodeId_t route = transportGetRoute(cnt);
 		if (route != BROADCAST_ADDRESS) {
-			TRANSPORT_DEBUG(PSTR("TSF:RRT:ROUTE N=%" PRIu8 ",R=%" PRIu8 "\n"), cnt, route);
-			uint8_t outBuf[2] = { (uint8_t)cnt,route };
+			TRANSPORT_DEBUG(PSTR("TSF:RRT:ROUTE N=%" PRIu8 ",R=%" PRIuNodeId "\n"), cnt, route);
+			nodeId_t outBuf[2] = { (nodeId_t)cnt,route };
 			(void)_sendRoute(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL, I_DEBUG).set(outBuf,
-			                 2));
+			                 sizeof(outBuf)));
 			wait(200);
 		}
 	}
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	for (uint16_t cnt = 0; cnt < MY_EXTENDED_ROUTES; cnt++) {
+		const transportExtendedRoute_t &entry = _transportExtendedRoutes[cnt];
+		if (!isLegacyNodeId(entry.node) && entry.route != AUTO) {
+			TRANSPORT_DEBUG(PSTR("TSF:RRT:ROUTE N=%" PRIuNodeId ",R=%" PRIuNodeId "\n"), entry.node, entry.route);
+			nodeId_t outBuf[2] = { entry.node, entry.route };
+			(void)_sendRoute(build(_msgTmp, GATEWAY_ADDRESS, NODE_SENSOR_ID, C_INTERNAL, I_DEBUG).set(outBuf,
+			                 sizeof(outBuf)));
+			wait(200);
+		}
+	}
+#endif
 #endif
 }
 
@@ -48,10 +48,13 @@
 *   - TSF:<b>MSG</b>		from @ref transportProcessMessage(), processes incoming message
 *   - TSF:<b>SAN</b>		from @ref transportInvokeSanityCheck(), calls transport-specific sanity check
 *   - TSF:<b>RTE</b>		from @ref transportRouteMessage(), sends message
+*   - TSF:<b>STS</b>		from @ref transportReportStats(), link statistics (only with @ref MY_TRANSPORT_STATS_FEATURE)
+*   - TSF:<b>FWQ</b>		from @ref transportForwardMessage() and @ref transportForwardNext(), forwarding queue (only with @ref MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
 *   - TSF:<b>SND</b>		from @ref transportSendRoute(), sends message if transport is ready (exposed)
 *   - TSF:<b>TDI</b>		from @ref transportDisable()
 *   - TSF:<b>TRI</b>		from @ref transportReInitialise()
 *   - TSF:<b>SIR</b>		from @ref transportSignalReport()
+*   - TSF:<b>AED</b>		from aeadSeal() and aeadOpen(), frame encryption (only with @ref MY_TRANSPORT_AEAD_FEATURE)
 *
 * Transport debug log messages:
 *
@@ -106,19 +109,34 @@
 * | | TSF | MSG   | RCV CB										| Hand over message to @ref receive() callback function
 * | | TSF | MSG   | REL MSG										| Relay message
 * | | TSF | MSG   | REL PxNG,HP=%%d						| Relay PING/PONG message, increment hop counter (HP)
+* | | TSF | STS   | SEQ=%%d,TX=%%d,FAIL=%%d				| Link statistics report (SEQ) sent, (TX) frames sent, (FAIL) not acknowledged
+* | | TSF | FWQ   | ADD,N=%%d									| Message queued for relaying, (N) messages queued
+* | | TSF | FWQ   | FWD,L=%%lu								| Queued message relayed after (L) ms
+* |!| TSF | FWQ   | OVF,D=%%d									| Forwarding queue full, message dropped, (D) messages dropped so far
+* | | TSF | FWQ   | DRAINED,D=%%d,L=%%d				| Forwarding queue drained after an overflow, (D) messages dropped, max. latency (L) ms
 * |!| TSF | MSG   | LEN=%%d,EXP=%%d						| Invalid message length (LEN), exptected length (EXP)
 * |!| TSF | MSG   | PVER,%%d!=%%d							| Message protocol version mismatch (actual!=expected)
 * |!| TSF | MSG   | SIGN VERIFY FAIL					| Signing verification failed
+* |!| TSF | MSG   | THR,ID=%%d								| Neighbour (ID) exceeded ingress rate limit, messages dropped until bucket refilled
+* | | TSF | MSG   | THR END,ID=%%d						| Ingress rate limit of neighbour (ID) lifted
 * |!| TSF | MSG   | REL MSG,NORP							| Node received a message for relaying, but node is not a repeater, message skipped
 * |!| TSF | MSG   | SIGN FAIL									| Signing message failed
 * |!| TSF | MSG   | GWL FAIL									| GW uplink failed
 * |!| TSF | MSG   | ID TK INVALID							| Token for ID request invalid
+* | | TSF | AED   | RSV=%%lu										| Frame counters reserved in EEPROM up to (RSV)
+* |!| TSF | AED   | CNT EXHAUSTED							| No frame counter left, frame not sent, a new key is required
+* |!| TSF | AED   | LEN=%%d										| Received frame (LEN) too short for its payload and trailer
+* |!| TSF | AED   | TAG FAIL,ID=%%d						| Frame from node (ID) failed authentication
+* |!| TSF | AED   | REPLAY,ID=%%d,C=%%lu				| Frame counter (C) of node (ID) seen before or too old, frame dropped
+* | | TSF | AED   | EPOCH,ID=%%d,C=%%lu					| Node (ID) started a new epoch at frame counter (C), replay window restarted
+* |!| TSF | AED   | NO WINDOW,ID=%%d						| All replay windows in use, frame from node (ID) dropped
 * | | TSF | SAN   | OK												| Sanity check passed
 * |!| TSF | SAN   | FAIL											| Sanity check failed, attempt to re-initialize radio
 * | | TSF | CRT   | OK												| Clearing routing table successful
 * | | TSF | LRT   | OK												| Loading routing table successful
 * | | TSF | SRT   | OK												| Saving routing table successful
 * |!| TSF | RTE   | FPAR ACTIVE								| Finding parent active, message not sent
+* |!| TSF | RTE   | LEN=%%d,EXT								| Payload length (LEN) exceeds a version 3 frame, message not sent
 * |!| TSF | RTE   | DST %%d UNKNOWN						| Routing for destination (DST) unknown, send message to parent
 * | | TSF | RTE   | N2N OK										| Node-to-node communication succeeded
 * |!| TSF | RTE   | N2N FAIL									| Node-to-node communication failed, handing over to parent for re-routing
@@ -209,6 +227,17 @@
 #define _autoFindParent (bool)(MY_PARENT_NODE_ID == AUTO)				//!<  returns true if static parent id is undefined
 #define isValidDistance(_distance) (bool)(_distance!=DISTANCE_INVALID)	//!<  returns true if distance is valid
 #define isValidParent(_parent) (bool)(_parent != AUTO)					//!<  returns true if parent is valid
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+#define EXTENDED_NODE_ID_LAST		(0xFEFFu)		//!< highest extended node ID, 0xFF marks an erased high byte in EEPROM
+#define EXTENDED_ROUTE_PROBES		(4u)			//!< slots searched for an extended route
+#define isValidProtocolVersion(_version) (bool)((_version) == PROTOCOL_VERSION || (_version) == PROTOCOL_VERSION_EXTENDED)	//!< returns true if frames of this version are processed
+#define isLegacyNodeId(_nodeId) (bool)((_nodeId) < SIZE_ROUTES)			//!< returns true if node ID fits 8 bits, i.e. the per-node tables
+#define transportNodeSlot(_nodeId) (uint8_t)((_nodeId) ^ ((_nodeId) >> 8))	//!< per-node table slot, extended IDs share slots
+#else
+#define isValidProtocolVersion(_version) (bool)((_version) == PROTOCOL_VERSION)	//!< returns true if frames of this version are processed
+#define isLegacyNodeId(_nodeId) (true)									//!< returns true if node ID fits 8 bits, i.e. the per-node tables
+#define transportNodeSlot(_nodeId) (_nodeId)							//!< per-node table slot
+#endif
 
 /**
  * @brief Callback type
@@ -221,8 +250,8 @@ typedef void(*transportCallback_t)(void);
  * This structure stores node-related configurations
  */
 typedef struct {
-	uint8_t nodeId;								//!< Current node id
-	uint8_t parentNodeId;						//!< Where this node sends its messages
+	nodeId_t nodeId;							//!< Current node id
+	nodeId_t parentNodeId;						//!< Where this node sends its messages
 	uint8_t distanceGW;							//!< This nodes distance to sensor net gateway (number of hops)
 	uint8_t passiveMode : 1;					//!< Passive mode
 	uint8_t reserved : 7;						//!< Reserved
@@ -268,6 +297,11 @@ typedef struct {
 	uint8_t failedUplinkTransmissions : 4;	//!< counter failed uplink transmissions (max 15)
 	uint8_t failureCounter : 3;				//!< counter for TSM failures (max 7)
 	bool msgReceived : 1;					//!< flag message received
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	// 8 bits
+	bool parentExtended : 1;				//!< flag parent answered in a version 3 frame, i.e. relays extended IDs
+	uint8_t reserved : 7;					//!< reserved
+#endif
 
 	uint8_t pingResponse;					//!< stores I_PONG hops
 	transportRSSI_t uplinkQualityRSSI;		//!< Uplink quality, internal RSSI representation
@@ -280,6 +314,75 @@ typedef struct {
 	uint8_t route[SIZE_ROUTES];				//!< route for node
 } routingTable_t;
 
+#define TRANSPORT_STATS_VERSION		(1u)	//!< layout of transportStats_t
+
+/**
+* @brief Link statistics of a node, payload of I_TRANSPORT_STATS (little endian)
+*
+* Counters are cumulative since boot and wrap, differences between reports stay valid.
+*/
+typedef struct {
+	uint8_t version;						//!< TRANSPORT_STATS_VERSION
+	uint8_t sequence;						//!< report number, 0 for the first report after boot
+	uint16_t txAttempts;					//!< frames sent
+	uint16_t txFailures;					//!< frames not acknowledged
+	uint16_t txReroutes;					//!< node-to-node messages re-sent via parent
+	uint16_t rxDrops;						//!< received frames dropped (length, version, rate limit, verification)
+	uint8_t parentChanges;					//!< parent differs from the previous one when transport became ready
+	uint8_t txPowerPercent;					//!< TX power level in %, averaged over sent frames
+	uint16_t parentSeconds;					//!< time spent finding a parent
+	uint16_t failureSeconds;				//!< time spent in failure state
+} __attribute__((packed)) transportStats_t;
+
+/**
+* @brief Route cache entry (only with @ref MY_ROUTE_CACHE_FEATURE)
+*/
+typedef struct {
+	uint8_t node;							//!< node ID
+	uint8_t route;							//!< route for node
+	bool valid : 1;							//!< flag entry in use
+	bool dirty : 1;							//!< flag route differs from EEPROM
+	uint8_t reserved : 6;					//!< reserved
+} routeCacheEntry_t;
+
+/**
+* @brief Route to or via an extended node ID (only with @ref MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+*/
+typedef struct {
+	nodeId_t node;							//!< node ID, AUTO if slot unused
+	nodeId_t route;							//!< route for node, AUTO if unknown
+} transportExtendedRoute_t;
+
+/**
+* @brief Ingress token bucket, one per neighbour (last hop)
+*/
+typedef struct {
+	uint32_t lastRefill;					//!< timepoint of last token refill
+	uint8_t tokens;							//!< tokens left, one token per accepted message
+	bool repeater : 1;						//!< flag node relayed traffic, i.e. repeater class
+	bool throttled : 1;						//!< flag node is throttled
+	uint8_t reserved : 6;					//!< reserved
+} transportRxBucket_t;
+
+/**
+* @brief Message queued for relaying
+*/
+typedef struct {
+	uint32_t queued;						//!< timepoint the message was queued
+	MyMessage message;						//!< message to relay
+} transportForwardEntry_t;
+
+/**
+* @brief Forwarding queue statistics
+*/
+typedef struct {
+	uint16_t forwarded;						//!< messages relayed from the queue
+	uint16_t dropped;						//!< messages dropped, queue full
+	uint16_t maxLatency;					//!< highest time (in ms) a message waited in the queue
+	bool overflow : 1;						//!< flag queue overflowed since it last drained
+	uint8_t reserved : 7;					//!< reserved
+} transportForwardStats_t;
+
 // PRIVATE functions
 
 /**
@@ -361,7 +464,7 @@ void transportProcessMessage(void);
 * @param newNodeId New node ID
 * @return true if node ID is valid and successfully assigned
 */
-bool transportAssignNodeID(const uint8_t newNodeId);
+bool transportAssignNodeID(const nodeId_t newNodeId);
 /**
 * @brief Wait and process messages for a defined amount of time until specified message received
 * @param waitingMS Time to wait and process incoming messages in ms
@@ -375,7 +478,7 @@ bool transportWait(const uint32_t waitingMS, const uint8_t cmd, const uint8_t ms
 * @param targetId Node to be pinged
 * @return hops from pinged node or 255 if no answer received within 2000ms
 */
-uint8_t transportPingNode(const uint8_t targetId);
+uint8_t transportPingNode(const nodeId_t targetId);
 /**
 * @brief Send and route message according to destination
 *
@@ -397,7 +500,7 @@ bool transportSendRoute(MyMessage &message);
 * @param message
 * @return true if message sent successfully
 */
-bool transportSendWrite(const uint8_t to, MyMessage &message);
+bool transportSendWrite(const nodeId_t to, MyMessage &message);
 /**
 * @brief Check uplink to GW, includes flooding control
 * @param force to override flood control timer
@@ -461,7 +564,7 @@ uint32_t transportGetHeartbeat(void);
 */
 void transportLoadRoutingTable(void);
 /**
-* @brief Save routing table to EEPROM.
+* @brief Save routing table to EEPROM, i.e. RAM routing table or changed routes in the route cache.
 */
 void transportSaveRoutingTable(void);
 /**
@@ -469,13 +572,36 @@ void transportSaveRoutingTable(void);
 * @param node
 * @param route
 */
-void transportSetRoute(const uint8_t node, const uint8_t route);
+void transportSetRoute(const nodeId_t node, const nodeId_t route);
 /**
 * @brief Load route to node
 * @param node
 * @return route to node
 */
-uint8_t transportGetRoute(const uint8_t node);
+nodeId_t transportGetRoute(const nodeId_t node);
+/**
+* @brief Charge the last hop of a message against its ingress rate limit (only GW/repeaters with
+* @ref MY_TRANSPORT_RX_RATE_LIMIT_FEATURE)
+* @param sender originator, own messages are not limited
+* @param last last hop, charged and classified as repeater if it relayed the message
+* @return true if message is within rate limit and should be processed
+*/
+bool transportCheckRxRateLimit(const nodeId_t sender, const nodeId_t last);
+/**
+* @brief Relay a message, queued with @ref MY_TRANSPORT_FORWARD_QUEUE_FEATURE
+* @param message to relay
+*/
+void transportForwardMessage(MyMessage &message);
+/**
+* @brief Relay the oldest queued message (only with @ref MY_TRANSPORT_FORWARD_QUEUE_FEATURE)
+* @return true if a message was relayed
+*/
+bool transportForwardNext(void);
+/**
+* @brief Send link statistics to GW (only with @ref MY_TRANSPORT_STATS_FEATURE)
+* @return true if report was sent
+*/
+bool transportReportStats(void);
 /**
 * @brief Reports content of routing table
 */
@@ -484,12 +610,12 @@ void transportReportRoutingTable(void);
 * @brief Get node ID
 * @return node ID
 */
-uint8_t transportGetNodeId(void);
+nodeId_t transportGetNodeId(void);
 /**
 * @brief Get parent node ID
 * @return parent node ID
 */
-uint8_t transportGetParentNodeId(void);
+nodeId_t transportGetParentNodeId(void);
 /**
 * @brief Get distance to GW
 * @return distance (=hops) to GW
@@ -0,0 +1,249 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "MyTransportAead.h"
+#if !defined(__AES_H__)
+#include "drivers/AES/AES.cpp"
+#endif
+
+// debug
+#if defined(MY_DEBUG_VERBOSE_TRANSPORT)
+#define AEAD_DEBUG(x,...) DEBUG_OUTPUT(x, ##__VA_ARGS__)	//!< debug
+#else
+#define AEAD_DEBUG(x,...)	//!< debug NULL
+#endif
+
+#define AEAD_BLOCK_SIZE			(16u)
+#define AEAD_COUNTER_ERASED		(0xFFFFFFFFul)
+#define AEAD_COUNTER_LAST		(0xFFFFFFFEul)	//!< never used, an exhausted reservation stays exhausted
+
+static AES _aead;
+static uint32_t _aeadCounter;						//!< next frame counter
+static uint32_t _aeadReserved;						//!< counters below are reserved in EEPROM
+static aeadWindow_t _aeadWindows[MY_AEAD_REPLAY_PEERS];	//!< most recently heard first
+
+static void aeadReserve(void)
+{
+	_aeadReserved = (_aeadCounter > AEAD_COUNTER_LAST - MY_AEAD_COUNTER_RESERVE) ?
+	                AEAD_COUNTER_LAST : _aeadCounter + MY_AEAD_COUNTER_RESERVE;
+	hwWriteConfigBlock((void *)&_aeadReserved, (void *)EEPROM_AEAD_COUNTER_ADDRESS,
+	                   sizeof(_aeadReserved));
+	AEAD_DEBUG(PSTR("TSF:AED:RSV=%" PRIu32 "\n"), _aeadReserved);
+}
+
+// A_i and B_0 share the layout: flags | last | counter | 0.. | i or l(m), L = 2
+static void aeadBlock(uint8_t *block, const uint8_t flags, const uint8_t *frame,
+                      const uint32_t counter, const uint16_t value)
+{
+	(void)memset(block, 0, AEAD_BLOCK_SIZE);
+	block[0] = flags;
+	block[1] = frame[0];	// last
+	block[2] = (uint8_t)(counter >> 24);
+	block[3] = (uint8_t)(counter >> 16);
+	block[4] = (uint8_t)(counter >> 8);
+	block[5] = (uint8_t)counter;
+	block[14] = (uint8_t)(value >> 8);
+	block[15] = (uint8_t)value;
+}
+
+// CBC-MAC over header and plaintext payload, the tag is the first AEAD_TAG_SIZE bytes of mac
+static void aeadMac(uint8_t *mac, const uint8_t *frame, const uint8_t payloadLength,
+                    const uint32_t counter)
+{
+	uint8_t block[AEAD_BLOCK_SIZE];
+	// B_0: Adata, M = 4, L = 2
+	aeadBlock(block, 0x40 | (((AEAD_TAG_SIZE - 2) / 2) << 3) | 0x01, frame, counter, payloadLength);
+	(void)_aead.encrypt(block, mac);
+	// the header as associated data, prefixed with its length
+	(void)memset(block, 0, AEAD_BLOCK_SIZE);
+	block[1] = HEADER_SIZE;
+	(void)memcpy(&block[2], frame, HEADER_SIZE);
+	for (uint8_t i = 0; i < AEAD_BLOCK_SIZE; i++) {
+		mac[i] ^= block[i];
+	}
+	(void)_aead.encrypt(mac, mac);
+	for (uint8_t offset = 0; offset < payloadLength; offset += AEAD_BLOCK_SIZE) {
+		for (uint8_t i = 0; i < AEAD_BLOCK_SIZE && offset + i < payloadLength; i++) {
+			mac[i] ^= frame[HEADER_SIZE + offset + i];
+		}
+		(void)_aead.encrypt(mac, mac);
+	}
+}
+
+// CTR mode with A_1.. over the payload, A_0 over the tag
+static void aeadCrypt(uint8_t *frame, const uint8_t payloadLength, const uint32_t counter,
+                      uint8_t *tag)
+{
+	uint8_t block[AEAD_BLOCK_SIZE];
+	uint8_t stream[AEAD_BLOCK_SIZE];
+	aeadBlock(block, 0x01, frame, counter, 0);
+	(void)_aead.encrypt(block, stream);
+	for (uint8_t i = 0; i < AEAD_TAG_SIZE; i++) {
+		tag[i] ^= stream[i];
+	}
+	for (uint8_t offset = 0; offset < payloadLength; offset += AEAD_BLOCK_SIZE) {
+		block[15]++;
+		(void)_aead.encrypt(block, stream);
+		for (uint8_t i = 0; i < AEAD_BLOCK_SIZE && offset + i < payloadLength; i++) {
+			frame[HEADER_SIZE + offset + i] ^= stream[i];
+		}
+	}
+}
+
+static aeadWindow_t *aeadWindow(const uint8_t peer)
+{
+	uint8_t index = 0;
+	while (index < MY_AEAD_REPLAY_PEERS - 1 && _aeadWindows[index].peer != peer) {
+		index++;
+	}
+	// move to the front, the last window is reused for a new neighbour
+	aeadWindow_t window = _aeadWindows[index];
+	if (window.peer != peer) {
+		// a reused window forgets the counters of its neighbour, which must have gone silent
+		if (window.peer != AUTO &&
+		        (uint16_t)((uint16_t)(hwMillis() >> 16) - window.heard) < AEAD_WINDOW_IDLE) {
+			return NULL;
+		}
+		window.peer = peer;
+		window.top = 0;
+		window.seen = 0;
+		window.retired = AEAD_COUNTER_ERASED;
+	}
+	(void)memmove(&_aeadWindows[1], &_aeadWindows[0], index * sizeof(aeadWindow_t));
+	_aeadWindows[0] = window;
+	return &_aeadWindows[0];
+}
+
+void aeadInit(void)
+{
+	uint8_t key[16];
+#ifdef MY_ENCRYPTION_SIMPLE_PASSWD
+	(void)memset(key, 0, 16);
+	(void)memcpy(key, MY_ENCRYPTION_SIMPLE_PASSWD, strnlen(MY_ENCRYPTION_SIMPLE_PASSWD, 16));
+#else
+	hwReadConfigBlock((void *)key, (void *)EEPROM_RF_ENCRYPTION_AES_KEY_ADDRESS, 16);
+#endif
+	(void)_aead.set_key(key, 16);
+	// Make sure it is purged from memory when set
+	(void)memset(key, 0, 16);
+
+	for (uint8_t i = 0; i < MY_AEAD_REPLAY_PEERS; i++) {
+		_aeadWindows[i].peer = AUTO;
+	}
+	// counters of nodes without an ID are drawn at random
+	hwRandomNumberInit();
+
+	// continue after the last reservation, counters used before the restart are never reused
+	hwReadConfigBlock((void *)&_aeadCounter, (void *)EEPROM_AEAD_COUNTER_ADDRESS,
+	                  sizeof(_aeadCounter));
+	if (_aeadCounter == AEAD_COUNTER_ERASED) {
+		// no counter of this node ID is known, start a new epoch at a random counter
+		_aeadCounter = ((uint32_t)random(0xF000) << 16) | (uint32_t)random(0x10000);
+	}
+	aeadReserve();
+}
+
+uint8_t aeadSeal(uint8_t *frame, const uint8_t length)
+{
+	uint32_t counter;
+	if (frame[0] == AUTO) {
+		// all nodes without an ID share last = AUTO, a reserved counter would repeat their nonces
+		counter = ((uint32_t)random(0x10000) << 16) | (uint32_t)random(0x10000);
+	} else if (_aeadCounter >= AEAD_COUNTER_LAST) {
+		AEAD_DEBUG(PSTR("!TSF:AED:CNT EXHAUSTED\n"));
+		return 0;
+	} else {
+		if (_aeadCounter >= _aeadReserved) {
+			aeadReserve();
+		}
+		counter = _aeadCounter++;
+	}
+	const uint8_t payloadLength = length - HEADER_SIZE;
+	uint8_t mac[AEAD_BLOCK_SIZE];
+	aeadMac(mac, frame, payloadLength, counter);
+	aeadCrypt(frame, payloadLength, counter, mac);
+	uint8_t *trailer = &frame[length];
+	trailer[0] = (uint8_t)(counter >> 24);
+	trailer[1] = (uint8_t)(counter >> 16);
+	trailer[2] = (uint8_t)(counter >> 8);
+	trailer[3] = (uint8_t)counter;
+	(void)memcpy(&trailer[AEAD_COUNTER_SIZE], mac, AEAD_TAG_SIZE);
+	return length + AEAD_TRAILER_SIZE;
+}
+
+uint8_t aeadOpen(uint8_t *frame, const uint8_t length)
+{
+	// the payload length in the header is authenticated, the received length may include padding
+	const uint8_t payloadLength = BF_GET(frame[3], 3, 5);
+	if (payloadLength > MAX_PAYLOAD || length < HEADER_SIZE + payloadLength + AEAD_TRAILER_SIZE) {
+		AEAD_DEBUG(PSTR("!TSF:AED:LEN=%" PRIu8 "\n"), length);
+		return 0;
+	}
+	const uint8_t *trailer = &frame[HEADER_SIZE + payloadLength];
+	const uint32_t counter = ((uint32_t)trailer[0] << 24) | ((uint32_t)trailer[1] << 16) |
+	                         ((uint32_t)trailer[2] << 8) | trailer[3];
+	uint8_t tag[AEAD_TAG_SIZE];
+	(void)memcpy(tag, &trailer[AEAD_COUNTER_SIZE], AEAD_TAG_SIZE);
+	aeadCrypt(frame, payloadLength, counter, tag);
+	uint8_t mac[AEAD_BLOCK_SIZE];
+	aeadMac(mac, frame, payloadLength, counter);
+	uint8_t diff = 0;
+	for (uint8_t i = 0; i < AEAD_TAG_SIZE; i++) {
+		diff |= mac[i] ^ tag[i];
+	}
+	if (diff) {
+		AEAD_DEBUG(PSTR("!TSF:AED:TAG FAIL,ID=%" PRIu8 "\n"), frame[0]);
+		return 0;
+	}
+
+	const uint8_t peer = frame[0];
+	if (peer != AUTO) {
+		aeadWindow_t *window = aeadWindow(peer);
+		if (window == NULL) {
+			AEAD_DEBUG(PSTR("!TSF:AED:NO WINDOW,ID=%" PRIu8 "\n"), peer);
+			return 0;
+		}
+		if (window->retired != AEAD_COUNTER_ERASED && window->retired - counter < AEAD_EPOCH_SPAN) {
+			// counter of the previous epoch
+			AEAD_DEBUG(PSTR("!TSF:AED:REPLAY,ID=%" PRIu8 ",C=%" PRIu32 "\n"), peer, counter);
+			return 0;
+		}
+		const uint32_t distance = (counter <= window->top) ? window->top - counter :
+		                          counter - window->top;
+		if (window->seen && distance >= AEAD_EPOCH_SPAN) {
+			// authenticated, the neighbour lost its counter and started a new epoch
+			AEAD_DEBUG(PSTR("TSF:AED:EPOCH,ID=%" PRIu8 ",C=%" PRIu32 "\n"), peer, counter);
+			window->retired = window->top;
+			window->seen = 0;
+		}
+		if (window->seen && counter <= window->top) {
+			if (distance >= AEAD_WINDOW_SIZE || (window->seen & (1ul << distance))) {
+				AEAD_DEBUG(PSTR("!TSF:AED:REPLAY,ID=%" PRIu8 ",C=%" PRIu32 "\n"), peer, counter);
+				return 0;
+			}
+			window->seen |= 1ul << distance;
+		} else {
+			const uint32_t shift = window->seen ? distance : AEAD_WINDOW_SIZE;
+			window->seen = ((shift >= AEAD_WINDOW_SIZE) ? 0 : (window->seen << shift)) | 1ul;
+			window->top = counter;
+		}
+		window->heard = (uint16_t)(hwMillis() >> 16);
+	}
+	return HEADER_SIZE + payloadLength;
+}
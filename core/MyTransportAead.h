@@ -0,0 +1,90 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+/**
+* @file MyTransportAead.h
+*
+* @brief Per hop authenticated encryption of frames
+*
+* With @ref MY_TRANSPORT_AEAD_FEATURE every frame is sealed with %AES-128 in CCM mode before it
+* is handed to the radio, and opened before the transport looks at it:
+*
+* | header (7) | payload, encrypted (0..17) | frame counter (4) | tag (4) |
+*
+* The header stays readable and is authenticated as associated data. The nonce is made of the
+* node sending the frame (last) and its frame counter, which never repeats: it is reserved in
+* EEPROM @ref MY_AEAD_COUNTER_RESERVE frames ahead. A node without a reservation in EEPROM, i.e.
+* after flashing with an erased EEPROM, a clear or on new hardware taking over a node ID, starts
+* a new epoch at a random counter, so it does not repeat the nonces of the node that used its ID
+* before. Nodes without an ID (last = AUTO) cannot tell their counters apart and use a random one
+* for every frame instead.
+*
+* A receiver keeps a 32 frame replay window for each of up to @ref MY_AEAD_REPLAY_PEERS
+* neighbours and drops frames with a counter it has seen or that fell out of the window. A frame
+* more than @ref AEAD_EPOCH_SPAN counters behind the window starts a new epoch of that neighbour,
+* once its tag is verified: the window restarts at its counter, and frames of the previous epoch
+* stay rejected. The window of a neighbour is only handed to another one when it was not heard
+* for @ref AEAD_WINDOW_IDLE, frames of further neighbours are dropped until then.
+*
+* Replay windows live in RAM. Frames from nodes without an ID (last = AUTO) are not checked
+* for replays, several nodes may send them.
+*/
+
+#ifndef MyTransportAead_h
+#define MyTransportAead_h
+
+#include "MySensorsCore.h"
+
+#define AEAD_TAG_SIZE			(4u)	//!< CCM authentication tag, M
+#define AEAD_COUNTER_SIZE		(4u)	//!< frame counter in the trailer
+#define AEAD_WINDOW_SIZE		(32u)	//!< frames a replay window spans
+#define AEAD_EPOCH_SPAN			(0x01000000ul)	//!< counters behind the window still taken for replays
+#define AEAD_WINDOW_IDLE		(55u)	//!< about one hour in units of 65.536 s, silence before a window is reused
+
+/**
+ * @brief Replay window of a neighbour
+ */
+typedef struct {
+	uint8_t peer;			//!< node ID of the neighbour, AUTO if unused
+	uint32_t top;			//!< highest frame counter received
+	uint32_t seen;			//!< bit n set if top - n was received
+	uint32_t retired;		//!< highest frame counter of the previous epoch
+	uint16_t heard;			//!< hwMillis() of the last accepted frame in units of 65.536 s
+} __attribute__((packed)) aeadWindow_t;
+
+/**
+ * @brief Load the key and reserve frame counters, once at start up
+ */
+void aeadInit(void);
+/**
+ * @brief Encrypt a frame and append counter and tag
+ * @param frame header and payload, room for AEAD_TRAILER_SIZE more bytes
+ * @param length of header and payload
+ * @return length of the sealed frame, 0 if no frame counter is left
+ */
+uint8_t aeadSeal(uint8_t *frame, const uint8_t length);
+/**
+ * @brief Verify and decrypt a received frame
+ * @param frame as received, decrypted in place
+ * @param length as received
+ * @return length of header and payload, 0 if the frame is rejected
+ */
+uint8_t aeadOpen(uint8_t *frame, const uint8_t length);
+
+#endif
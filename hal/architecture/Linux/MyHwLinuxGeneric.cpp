@@ -20,17 +20,26 @@
 #include "MyHwLinuxGeneric.h"
 
 #include <errno.h>
+#include <limits.h>
+#include <poll.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <syscall.h>
+#include <sys/timerfd.h>
+#include <time.h>
 #include <unistd.h>
 #include "SoftEeprom.h"
 #include "log.h"
+#include "clock.h"
 #include "config.h"
+#include "stall.h"
+#include "whitelist.h"
 
 static SoftEeprom eeprom;
+#if !defined(MY_SIMULATION)
 static FILE *randomFp = NULL;
+#endif
 
 bool hwInit(void)
 {
@@ -71,8 +80,19 @@ void hwWriteConfig(const int addr, uint8_t value)
 	eeprom.writeByte(addr, value);
 }
 
+void hwWatchdogReset(void)
+{
+	// every yield, also from wait(), is a heartbeat of the stall detector
+	clockTick();
+	stallLoop();
+}
+
 void hwRandomNumberInit(void)
 {
+#if defined(MY_SIMULATION)
+	// reproducible runs
+	randomSeed(simSelf->seed);
+#else
 	uint32_t seed=0;
 
 	if (randomFp != NULL) {
@@ -85,11 +105,19 @@ void hwRandomNumberInit(void)
 
 	while (hwGetentropy(&seed, sizeof(seed)) != sizeof(seed));
 	randomSeed(seed);
+#endif
 }
 
 ssize_t hwGetentropy(void *__buffer, size_t __length)
 {
+#if defined(MY_SIMULATION)
+	for (size_t i = 0; i < __length; i++) {
+		((uint8_t *)__buffer)[i] = (uint8_t)random(256);
+	}
+	return __length;
+#else
 	return(fread(__buffer, 1, __length, randomFp));
+#endif
 }
 
 uint32_t hwMillis(void)
@@ -97,6 +125,37 @@ uint32_t hwMillis(void)
 	return millis();
 }
 
+bool hwLocalTime(uint32_t *localTime)
+{
+	if (!conf.local_time) {
+		return false;
+	}
+	const time_t now = time(NULL);
+	long offset = conf.local_time_offset * 60L;
+	if (conf.local_time_offset == INT_MIN) {
+		// time zone of the system, follows daylight saving time
+		struct tm local;
+		(void)localtime_r(&now, &local);
+		offset = local.tm_gmtoff;
+	}
+	*localTime = (uint32_t)(now + offset);
+	return true;
+}
+
+bool hwLocalConfig(char *config)
+{
+	if (conf.local_config == NULL) {
+		return false;
+	}
+	*config = conf.local_config[0];
+	return true;
+}
+
+const uint8_t *hwSigningWhitelist(const uint8_t nodeId)
+{
+	return whitelistLookup(nodeId);
+}
+
 bool hwUniqueID(unique_id_t *uniqueID)
 {
 	// not implemented yet
@@ -104,25 +163,18 @@ bool hwUniqueID(unique_id_t *uniqueID)
 	return false;
 }
 
-// Not supported!
 int8_t hwSleep(uint32_t ms)
 {
-	(void)ms;
-
-	return MY_SLEEP_NOT_POSSIBLE;
+	return hwSleep(INTERRUPT_NOT_DEFINED, 0u, INTERRUPT_NOT_DEFINED, 0u, ms);
 }
 
-// Not supported!
 int8_t hwSleep(const uint8_t interrupt, const uint8_t mode, uint32_t ms)
 {
-	(void)interrupt;
-	(void)mode;
-	(void)ms;
-
-	return MY_SLEEP_NOT_POSSIBLE;
+	return hwSleep(interrupt, mode, INTERRUPT_NOT_DEFINED, 0u, ms);
 }
 
-// Not supported!
+#if defined(MY_SIMULATION)
+// No pins to wake up from, the node sleeps in virtual time
 int8_t hwSleep(const uint8_t interrupt1, const uint8_t mode1, const uint8_t interrupt2,
                const uint8_t mode2,
                uint32_t ms)
@@ -131,9 +183,157 @@ int8_t hwSleep(const uint8_t interrupt1, const uint8_t mode1, const uint8_t inte
 	(void)mode1;
 	(void)interrupt2;
 	(void)mode2;
-	(void)ms;
 
-	return MY_SLEEP_NOT_POSSIBLE;
+	if (ms == 0u) {
+		return MY_SLEEP_NOT_POSSIBLE;
+	}
+	simSelf->wait(simSelf, simSelf->now + (uint64_t)ms * 1000, 0);
+	return MY_WAKE_UP_BY_TIMER;
+}
+#else
+// Block on a timer and the value files of the wake up pins, ms = 0 sleeps until a pin changes
+int8_t hwSleep(const uint8_t interrupt1, const uint8_t mode1, const uint8_t interrupt2,
+               const uint8_t mode2,
+               uint32_t ms)
+{
+	const uint8_t pins[2] = { interrupt1, interrupt2 };
+	const uint8_t modes[2] = { mode1, mode2 };
+	struct pollfd fds[3];
+	uint8_t wakePins[2];
+	nfds_t count = 0;
+	int8_t result = MY_SLEEP_NOT_POSSIBLE;
+
+	for (uint8_t i = 0; i < 2; i++) {
+		if (pins[i] == INTERRUPT_NOT_DEFINED) {
+			continue;
+		}
+		const int fd = interruptWakeOpen(pins[i], modes[i]);
+		if (fd < 0) {
+			goto cleanup;
+		}
+		wakePins[count] = pins[i];
+		fds[count].fd = fd;
+		fds[count].events = POLLPRI | POLLERR;
+		count++;
+	}
+	if (ms > 0u) {
+		// boot time keeps counting while the board is suspended, like the watchdog timer of a MCU
+		int fd = timerfd_create(CLOCK_BOOTTIME, TFD_CLOEXEC);
+		if (fd < 0) {
+			fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		}
+		struct itimerspec timer = {};
+		timer.it_value.tv_sec = (time_t)(ms / 1000u);
+		timer.it_value.tv_nsec = (long)(ms % 1000u) * 1000000;
+		if (fd < 0 || timerfd_settime(fd, 0, &timer, NULL) != 0) {
+			logError("Failed to start sleep timer: %s\n", strerror(errno));
+			if (fd >= 0) {
+				close(fd);
+			}
+			goto cleanup;
+		}
+		fds[count].fd = fd;
+		fds[count].events = POLLIN;
+		count++;
+	} else if (count == 0) {
+		// nothing would ever wake us up
+		return MY_SLEEP_NOT_POSSIBLE;
+	}
+
+	stallIdle(1);
+	while (result == MY_SLEEP_NOT_POSSIBLE) {
+		if (poll(fds, count, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			logError("Failed to sleep: %s\n", strerror(errno));
+			break;
+		}
+		for (nfds_t i = 0; i < count; i++) {
+			if (fds[i].revents & (POLLPRI | POLLERR)) {
+				result = (int8_t)wakePins[i];
+				break;
+			}
+			if (fds[i].revents & POLLIN) {
+				result = MY_WAKE_UP_BY_TIMER;
+			}
+		}
+	}
+	stallIdle(0);
+
+	if (ms > 0u) {
+		close(fds[--count].fd);
+	}
+cleanup:
+	for (nfds_t i = 0; i < count; i++) {
+		interruptWakeClose(wakePins[i], fds[i].fd);
+	}
+	return result;
+}
+#endif
+
+bool hwCaptureActive(void)
+{
+	return captureActive() != 0;
+}
+
+void hwCaptureFrame(const uint8_t result, const uint8_t hop, const int16_t rssi, const int16_t snr,
+                    const void *frame, const uint8_t length)
+{
+	if (result == HW_CAPTURE_RX) {
+		captureFrame(CAPTURE_DIRECTION_RX, hop, CAPTURE_TX_NONE, CAPTURE_UNKNOWN, rssi, snr, frame, length);
+	} else {
+		captureFrame(CAPTURE_DIRECTION_TX, hop, result == HW_CAPTURE_TX_OK ? CAPTURE_TX_OK :
+		             result == HW_CAPTURE_TX_NACK ? CAPTURE_TX_NACK : CAPTURE_TX_UNKNOWN, CAPTURE_UNKNOWN, rssi,
+		             snr, frame, length);
+	}
+}
+
+bool hwJournalAppend(const uint32_t key, const void *frame, const uint8_t length)
+{
+	return journalAppend(key, frame, length) == 0;
+}
+
+uint32_t hwJournalPending(void)
+{
+	return journalPending();
+}
+
+bool hwJournalPeek(void *frame, uint8_t *length, uint32_t *timestamp)
+{
+	return journalPeek(frame, length, timestamp) != 0;
+}
+
+void hwJournalPop(void)
+{
+	journalPop();
+}
+
+uint16_t hwJournalReplayBudget(void)
+{
+	const unsigned int budget = journalReplayBudget();
+	return budget > 0xFFFFu ? 0xFFFFu : (uint16_t)budget;
+}
+
+void hwJournalReplayFailed(void)
+{
+	journalReplayFailed();
+}
+
+uint32_t hwSeriesTime(void)
+{
+	return (uint32_t)time(NULL);
+}
+
+bool hwSeriesAppend(const uint32_t key, const uint32_t timestamp, const double value)
+{
+	return seriesAppend(key, timestamp, value) == 0;
+}
+
+int hwSeriesQuery(const uint32_t key, const uint32_t from, const uint32_t to, const char aggregate,
+                  const uint32_t bucket, hwSeriesRow_t row, void *context)
+{
+	return seriesQuery(key, from, to, aggregate, bucket, row, context);
 }
 
 uint16_t hwCPUVoltage(void)
@@ -25,10 +25,16 @@
 #include "SerialPort.h"
 #include "StdInOutStream.h"
 #include <SPI.h>
+#include "capture.h"
+#include "journal.h"
+#include "series.h"
 
 #define CRYPTO_LITTLE_ENDIAN
 
-#ifdef MY_LINUX_SERIAL_PORT
+#if defined(MY_SIMULATION)
+#include "SimStream.h"
+SimStream Serial = SimStream();
+#elif defined(MY_LINUX_SERIAL_PORT)
 #ifdef MY_LINUX_SERIAL_IS_PTY
 SerialPort Serial = SerialPort(MY_LINUX_SERIAL_PORT, true);
 #else
@@ -43,9 +49,10 @@ StdInOutStream Serial = StdInOutStream();
 #endif
 
 // Define these as macros (do nothing)
-#define hwWatchdogReset()
 #define hwReboot()
 
+inline void hwWatchdogReset(void);
+
 inline void hwDigitalWrite(uint8_t, uint8_t);
 inline int hwDigitalRead(uint8_t);
 inline void hwPinMode(uint8_t, uint8_t);
@@ -58,7 +65,17 @@ inline void hwWriteConfig(const int addr, uint8_t value);
 inline void hwRandomNumberInit(void);
 ssize_t hwGetentropy(void *__buffer, size_t __length);
 #define MY_HW_HAS_GETENTROPY
+#define MY_HW_HAS_CAPTURE
+#define MY_HW_HAS_JOURNAL
+#define MY_HW_HAS_LOCAL_TIME
+#define MY_HW_HAS_SERIES
 inline uint32_t hwMillis(void);
+/**
+ * @brief Serial of a trusted node, from signing_whitelist_file (MY_SIGNING_RUNTIME_WHITELIST)
+ * @param nodeId sender of a signed message
+ * @return 9 byte serial, NULL if the node is not on the whitelist
+ */
+const uint8_t *hwSigningWhitelist(const uint8_t nodeId);
 
 // SOFTSPI
 #ifdef MY_SOFTSPI
@@ -29,8 +29,38 @@
 #include <getopt.h>
 #include "log.h"
 #include "config.h"
+#include "capture.h"
+#include "journal.h"
+#include "stall.h"
+#include "whitelist.h"
 #include "MySensorsCore.h"
 
+#if defined(MY_SIMULATION)
+#include "sim.h"
+
+simNode_t *simSelf = NULL;
+
+// Entry point called by the simulator (tools/sim) on the coroutine of this node
+extern "C" __attribute__((visibility("default"))) void simNodeMain(simNode_t *node)
+{
+	simSelf = node;
+
+	conf.verbose = 7;
+	conf.eeprom_file = strdup(node->eeprom_file);
+	conf.eeprom_size = 1024;
+	logSetQuiet(!node->verbose);
+	logSetLevel(conf.verbose);
+
+	_begin(); // Startup MySensors library
+
+	for (;;) {
+		_process();  // Process incoming data
+		if (loop) {
+			loop(); // Call sketch loop
+		}
+	}
+}
+#else
 void handle_sigint(int sig)
 {
 	if (sig == SIGINT) {
@@ -49,11 +79,32 @@ void handle_sigint(int sig)
 	MY_SERIALDEVICE.end();
 #endif
 
+	stallClose();
+	whitelistClose();
+	captureClose();
+	journalClose();
+	seriesClose();
 	logClose();
 
 	exit(EXIT_SUCCESS);
 }
 
+// reloading is done by the main loop, between two messages
+static volatile sig_atomic_t reload_requested = 0;
+
+void handle_sighup(int sig)
+{
+	(void)sig;
+	reload_requested = 1;
+}
+
+#if defined(MY_GATEWAY_FEATURE)
+static unsigned int stall_gateway_tx(void)
+{
+	return gatewayTransportTxPending();
+}
+#endif
+
 static int daemonize(void)
 {
 	pid_t pid, sid;
@@ -354,6 +405,7 @@ int main(int argc, char *argv[])
 	signal(SIGINT, handle_sigint);
 	signal(SIGTERM, handle_sigint);
 	signal(SIGPIPE, handle_sigint);
+	signal(SIGHUP, handle_sighup);
 
 	hwRandomNumberInit();
 
@@ -441,6 +493,25 @@ int main(int argc, char *argv[])
 		logSetSyslog(LOG_CONS, LOG_USER);
 	}
 
+	if (conf.capture) {
+		if (captureOpen(conf.capture_file, conf.capture_file_size, conf.capture_file_count) != 0) {
+			logError("Failed to open capture file.\n");
+		}
+	}
+
+	if (conf.journal) {
+		if (journalOpen(conf.journal_file, conf.journal_size, conf.journal_compact,
+		                conf.journal_replay_rate) != 0) {
+			logError("Failed to open journal.\n");
+		}
+	}
+
+	if (conf.series) {
+		if (seriesOpen(conf.series_file, conf.series_size, conf.series_retention) != 0) {
+			logError("Failed to open series store.\n");
+		}
+	}
+
 	logInfo("Starting gateway...\n");
 	logInfo("Protocol version - %s\n", MYSENSORS_LIBRARY_VERSION);
 
@@ -464,6 +535,17 @@ int main(int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}
 #endif
+#if defined(MY_SIGNING_RUNTIME_WHITELIST)
+	if (conf.signing_whitelist_file) {
+		if (whitelistOpen(conf.signing_whitelist_file) != 0) {
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		logError("signing_whitelist_file was not found in %s\n",
+		         config_file?config_file:MY_LINUX_CONFIG_FILE);
+		exit(EXIT_FAILURE);
+	}
+#endif
 #if defined(MY_ENCRYPTION_FEATURE) && !defined(MY_ENCRYPTION_SIMPLE_PASSWD)
 	// Check if we need to update the encryption key in EEPROM
 	if (conf.aes_key) {
@@ -478,7 +560,22 @@ int main(int argc, char *argv[])
 		free(config_file);
 	}
 
+	if (stallOpen(conf.stall_detector ? conf.stall_file : NULL, conf.stall_threshold,
+	              conf.stall_file_size) != 0) {
+		logError("Failed to start stall detector.\n");
+	}
+	stallGauge("capture", capturePending);
+#if defined(MY_GATEWAY_FEATURE)
+	stallGauge("gateway_tx", stall_gateway_tx);
+#endif
+	stallReady();
+
 	for (;;) {
+		if (reload_requested) {
+			reload_requested = 0;
+			logNotice("Received SIGHUP\n");
+			(void)whitelistReload();
+		}
 		_process();  // Process incoming data
 		if (loop) {
 			loop(); // Call sketch loop
@@ -486,3 +583,4 @@ int main(int argc, char *argv[])
 	}
 	return 0;
 }
+#endif
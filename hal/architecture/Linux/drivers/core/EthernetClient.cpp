@@ -31,13 +31,15 @@
 #include <sys/time.h>
 #include <netinet/tcp.h>
 #include <errno.h>
+#include <poll.h>
 #include "log.h"
+#include "EthernetServer.h"
 
-EthernetClient::EthernetClient() : _sock(-1)
+EthernetClient::EthernetClient() : _sock(-1), _server(NULL)
 {
 }
 
-EthernetClient::EthernetClient(int sock) : _sock(sock)
+EthernetClient::EthernetClient(int sock) : _sock(sock), _server(NULL)
 {
 }
 
@@ -194,17 +196,23 @@ int EthernetClient::peek()
 
 void EthernetClient::flush()
 {
-	int count = 0;
+	if (_sock == -1) {
+		return;
+	}
 
-	if (_sock != -1) {
-		while (true) {
-			ioctl(_sock, SIOCOUTQ, &count);
-			if (count == 0) {
-				return;
-			}
-			usleep(1000);
-		}
+	// With a low water mark of one byte the socket only becomes writable once everything
+	// has been handed to the network, so poll() can wait for that instead of sleeping.
+	int lowat = 1;
+	if (setsockopt(_sock, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat)) == -1) {
+		return;
 	}
+	struct pollfd pfd;
+	pfd.fd = _sock;
+	pfd.events = POLLOUT;
+	poll(&pfd, 1, ETHERNETCLIENT_FLUSH_TIMEOUT_MS);
+	// back to the system default, a low mark would also throttle write()
+	lowat = 0;
+	setsockopt(_sock, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat));
 }
 
 void EthernetClient::stop()
@@ -213,25 +221,14 @@ void EthernetClient::stop()
 		return;
 	}
 
-	// attempt to close the connection gracefully (send a FIN to other side)
-	shutdown(_sock, SHUT_RDWR);
-
-	timeval startTime, curTime;
-	gettimeofday(&startTime, NULL);
-
-	// wait up to a second for the connection to close
-	do {
-		uint8_t s = status();
-		if (s == ETHERNETCLIENT_W5100_CLOSED) {
-			break; // exit the loop
-		}
-		usleep(1000);
-		gettimeofday(&curTime, NULL);
-	} while (((curTime.tv_sec - startTime.tv_sec) * 1000000) + (curTime.tv_usec - startTime.tv_usec) <
-	         1000000);
-
-	// free up the socket descriptor
-	::close(_sock);
+	if (_server != NULL) {
+		_server->_release(_sock);
+	} else {
+		// attempt to close the connection gracefully (send a FIN to other side), with
+		// SO_LINGER off close() returns at once and the kernel finishes the close
+		shutdown(_sock, SHUT_RDWR);
+		::close(_sock);
+	}
 	_sock = -1;
 }
 
@@ -276,15 +273,20 @@ uint8_t EthernetClient::status()
 
 uint8_t EthernetClient::connected()
 {
-	return status() == ETHERNETCLIENT_W5100_ESTABLISHED || available();
+	if (_sock == -1) {
+		return 0;
+	}
+
+	// One syscall: unread data or a live connection without data count as connected,
+	// end of stream or an error do not
+	uint8_t b;
+	const ssize_t rc = recv(_sock, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+	return rc > 0 || (rc == -1 && (errno == EAGAIN || errno == EWOULDBLOCK));
 }
 
 void EthernetClient::close()
 {
-	if (_sock != -1) {
-		::close(_sock);
-		_sock = -1;
-	}
+	stop();
 }
 
 void EthernetClient::bind(IPAddress ip)
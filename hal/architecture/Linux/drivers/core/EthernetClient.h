@@ -37,6 +37,10 @@
 #define ETHERNETCLIENT_W5100_CLOSE_WAIT 0x1C
 #define ETHERNETCLIENT_W5100_LAST_ACK 0x1D
 
+#define ETHERNETCLIENT_FLUSH_TIMEOUT_MS 1000 //!< Maximum time flush() waits for outgoing data.
+
+class EthernetServer;
+
 /**
  * EthernetClient class
  */
@@ -128,12 +132,15 @@ public:
 	virtual int peek();
 	/**
 	 * @brief Waits until all outgoing bytes in buffer have been sent.
+	 *
+	 * Gives up after ETHERNETCLIENT_FLUSH_TIMEOUT_MS.
 	 */
 	virtual void flush();
 	/**
 	 * @brief Close the connection gracefully.
 	 *
-	 * Send a FIN and wait 1s for a response. If no response close it forcefully.
+	 * Returns at once, the kernel sends the remaining data and the FIN in the background.
+	 * A client accepted by an EthernetServer is handed back to it.
 	 */
 	virtual void stop();
 	/**
@@ -205,6 +212,7 @@ public:
 
 private:
 	int _sock; //!< @brief Network socket file descriptor.
+	EthernetServer *_server; //!< @brief Server that accepted this connection, if any.
 	IPAddress _srcip; //!< @brief Local ip to bind to.
 };
 
@@ -20,8 +20,10 @@
  */
 
 #include "EthernetServer.h"
+#include <algorithm>
 #include <cstdio>
 #include <sys/socket.h>
+#include <cstdlib>
 #include <cstring>
 #include <sys/socket.h>
 #include <netdb.h>
@@ -29,13 +31,16 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/epoll.h>
 #include "log.h"
 #include "EthernetClient.h"
 
 EthernetServer::EthernetServer(uint16_t port, uint16_t max_clients) : port(port),
-	max_clients(max_clients), sockfd(-1)
+	max_clients(max_clients), sockfd(-1), epollfd(-1)
 {
 	clients.reserve(max_clients);
+	filters.reserve(max_clients);
+	outputs.reserve(max_clients);
 }
 
 void EthernetServer::begin()
@@ -105,6 +110,24 @@ void EthernetServer::begin(IPAddress address)
 
 	fcntl(sockfd, F_SETFL, O_NONBLOCK);
 
+	if (epollfd != -1) {
+		close(epollfd);
+	}
+	epollfd = epoll_create1(0);
+	if (epollfd == -1) {
+		logError("epoll_create1: %s\n", strerror(errno));
+		return;
+	}
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.fd = sockfd;
+	if (epoll_ctl(epollfd, EPOLL_CTL_ADD, sockfd, &ev) == -1) {
+		logError("epoll_ctl: %s\n", strerror(errno));
+		close(epollfd);
+		epollfd = -1;
+		return;
+	}
+
 	struct sockaddr_in *ipv4 = (struct sockaddr_in *)p->ai_addr;
 	void *addr = &(ipv4->sin_addr);
 	inet_ntop(p->ai_family, addr, ipstr, sizeof ipstr);
@@ -113,37 +136,30 @@ void EthernetServer::begin(IPAddress address)
 
 bool EthernetServer::hasClient()
 {
-	// Check if any client has disconnected
-	for (size_t i = 0; i < clients.size(); ++i) {
-		EthernetClient client(clients[i]);
-		if (!client.connected()) {
-			// Checks if this disconnected client is also on the new clients list
-			for (std::list<int>::iterator it = new_clients.begin(); it != new_clients.end(); ++it) {
-				if (*it == clients[i]) {
-					new_clients.erase(it);
-					break;
-				}
-			}
-			client.stop();
-			clients[i] = clients.back();
-			clients.pop_back();
-			logDebug("Ethernet client disconnected.\n");
-		}
-	}
-
-	_accept();
+	_poll();
 
 	return !new_clients.empty();
 }
 
+int EthernetServer::readable()
+{
+	if (ready.empty()) {
+		return -1;
+	}
+	const int sock = ready.back();
+	ready.pop_back();
+	return sock;
+}
+
 EthernetClient EthernetServer::available()
 {
 	if (new_clients.empty()) {
 		return EthernetClient();
 	} else {
-		int sock = new_clients.front();
+		EthernetClient client(new_clients.front());
 		new_clients.pop_front();
-		return EthernetClient(sock);
+		client._server = this;
+		return client;
 	}
 }
 
@@ -154,16 +170,7 @@ size_t EthernetServer::write(uint8_t b)
 
 size_t EthernetServer::write(const uint8_t *buffer, size_t size)
 {
-	size_t n = 0;
-
-	for (size_t i = 0; i < clients.size(); ++i) {
-		EthernetClient client(clients[i]);
-		if (client.status() == ETHERNETCLIENT_W5100_ESTABLISHED) {
-			n += client.write(buffer, size);
-		}
-	}
-
-	return n;
+	return _write(buffer, size, false, 0, 0, 0, 0);
 }
 
 size_t EthernetServer::write(const char *str)
@@ -179,6 +186,270 @@ size_t EthernetServer::write(const char *buffer, size_t size)
 	return write((const uint8_t *)buffer, size);
 }
 
+size_t EthernetServer::write(const char *buffer, size_t size, uint16_t node, uint8_t sensor,
+                             uint8_t command, uint8_t type)
+{
+	return _write((const uint8_t *)buffer, size, true, node, sensor, command, type);
+}
+
+size_t EthernetServer::write(EthernetClient &client, const char *buffer, size_t size)
+{
+	size_t i = 0;
+	while (i < clients.size() && clients[i] != client.getSocketNumber()) {
+		i++;
+	}
+	if (i == clients.size()) {
+		return 0;
+	}
+	const int sock = clients[i];
+	if (!_send(i, (const uint8_t *)buffer, size)) {
+		// the owner of the client sees it disconnected and stops it
+		shutdown(sock, SHUT_RDWR);
+		_hangup(sock);
+		return 0;
+	}
+	return size;
+}
+
+/**
+ * @brief Parse one field of a subscription, '*' or a list like "1,5-7".
+ *
+ * @param str field, advanced past it and its ';'.
+ * @param values set to true for every value the field accepts.
+ * @param limit highest value allowed in the field.
+ * @return @c true if the field is valid.
+ */
+static bool _parseSubscriptionField(const char *&str, bool values[256], long limit)
+{
+	memset(values, 0, 256 * sizeof(bool));
+	if (*str == '*') {
+		memset(values, 1, (limit + 1) * sizeof(bool));
+		str++;
+	} else {
+		while (true) {
+			char *end;
+			const long first = strtol(str, &end, 10);
+			long last = first;
+			if (end == str) {
+				return false;
+			}
+			str = end;
+			if (*str == '-') {
+				str++;
+				last = strtol(str, &end, 10);
+				if (end == str) {
+					return false;
+				}
+				str = end;
+			}
+			if (first < 0 || last > limit || first > last) {
+				return false;
+			}
+			for (long v = first; v <= last; v++) {
+				values[v] = true;
+			}
+			if (*str != ',') {
+				break;
+			}
+			str++;
+		}
+	}
+	if (*str == ';') {
+		str++;
+	} else if (*str != 0) {
+		return false;
+	}
+	return true;
+}
+
+bool EthernetServer::subscribe(EthernetClient &client, const char *command)
+{
+	const bool unsubscribe = !strcmp(command, "UNSUB");
+	if (!unsubscribe && strncmp(command, "SUB ", 4)) {
+		return false;
+	}
+	size_t i = 0;
+	while (i < clients.size() && clients[i] != client.getSocketNumber()) {
+		i++;
+	}
+	if (i == clients.size()) {
+		return true;
+	}
+	subscription &filter = filters[i];
+
+	if (unsubscribe) {
+		memset(&filter, 0, sizeof(filter));
+		logDebug("Client %d unsubscribed.\n", clients[i]);
+		return true;
+	}
+	if (filter.count == ETHERNETSERVER_MAX_SUBSCRIPTIONS) {
+		logError("Client %d has too many subscriptions.\n", clients[i]);
+		return true;
+	}
+
+	bool node[256], sensor[256], cmd[256], type[256];
+	const char *str = command + 4;
+	if (!_parseSubscriptionField(str, node, 255) || !_parseSubscriptionField(str, sensor, 255) ||
+	        !_parseSubscriptionField(str, cmd, ETHERNETSERVER_MAX_COMMAND) ||
+	        !_parseSubscriptionField(str, type, 255) || *str != 0) {
+		logError("Invalid subscription \"%s\".\n", command);
+		return true;
+	}
+	const uint32_t bit = (uint32_t)1 << filter.count++;
+	bool anyNode = true;
+	for (int v = 0; v < 256; v++) {
+		anyNode = anyNode && node[v];
+		filter.node[v] |= node[v] ? bit : 0;
+		filter.sensor[v] |= sensor[v] ? bit : 0;
+		filter.type[v] |= type[v] ? bit : 0;
+	}
+	filter.anyNode |= anyNode ? bit : 0;
+	for (int v = 0; v <= ETHERNETSERVER_MAX_COMMAND; v++) {
+		filter.command[v] |= cmd[v] ? bit : 0;
+	}
+	logDebug("Client %d subscribed to %s\n", clients[i], command + 4);
+	return true;
+}
+
+size_t EthernetServer::_write(const uint8_t *buffer, size_t size, bool filtered, uint16_t node,
+                              uint8_t sensor, uint8_t command, uint8_t type)
+{
+	size_t n = 0;
+
+	for (size_t i = 0; i < clients.size();) {
+		const subscription &filter = filters[i];
+		const uint32_t nodeMask = node < 256 ? filter.node[node] : filter.anyNode;
+		if (filtered && filter.count && !(nodeMask & filter.sensor[sensor] &
+		                                  filter.command[command & ETHERNETSERVER_MAX_COMMAND] & filter.type[type])) {
+			n += size;
+			i++;
+			continue;
+		}
+		const int sock = clients[i];
+		if (_send(i, buffer, size)) {
+			n += size;
+			i++;
+		} else {
+			// the owner of the client sees it disconnected and stops it
+			shutdown(sock, SHUT_RDWR);
+			_hangup(sock);
+		}
+	}
+
+	return n;
+}
+
+bool EthernetServer::_send(size_t i, const uint8_t *buffer, size_t size)
+{
+	std::string &output = outputs[i];
+	size_t sent = 0;
+	// kept output goes first, the rest waits behind it
+	while (output.empty() && sent < size) {
+		const ssize_t rc = send(clients[i], buffer + sent, size - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (rc == -1) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				logError("send: %s\n", strerror(errno));
+				return false;
+			}
+			break;
+		}
+		sent += rc;
+	}
+	if (sent == size) {
+		return true;
+	}
+	if (output.size() + size - sent > ETHERNETSERVER_MAX_OUTPUT) {
+		logError("Client %d does not take its output.\n", clients[i]);
+		return false;
+	}
+	if (output.empty()) {
+		_watch(clients[i], true);
+	}
+	output.append((const char *)buffer + sent, size - sent);
+	return true;
+}
+
+bool EthernetServer::_flush(int sock)
+{
+	size_t i = 0;
+	while (i < clients.size() && clients[i] != sock) {
+		i++;
+	}
+	if (i == clients.size()) {
+		return false;
+	}
+	std::string &output = outputs[i];
+	size_t sent = 0;
+	while (sent < output.size()) {
+		const ssize_t rc = send(sock, output.data() + sent, output.size() - sent,
+		                        MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (rc == -1) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				logError("send: %s\n", strerror(errno));
+				shutdown(sock, SHUT_RDWR);
+				_hangup(sock);
+				return false;
+			}
+			break;
+		}
+		sent += rc;
+	}
+	output.erase(0, sent);
+	if (output.empty()) {
+		_watch(sock, false);
+	}
+	return true;
+}
+
+void EthernetServer::_watch(int sock, bool writable)
+{
+	struct epoll_event ev;
+	ev.events = writable ? EPOLLIN | EPOLLRDHUP | EPOLLOUT : EPOLLIN | EPOLLRDHUP;
+	ev.data.fd = sock;
+	if (epoll_ctl(epollfd, EPOLL_CTL_MOD, sock, &ev) == -1) {
+		logError("epoll_ctl: %s\n", strerror(errno));
+	}
+}
+
+void EthernetServer::_poll()
+{
+	if (epollfd == -1) {
+		return;
+	}
+
+	struct epoll_event events[ETHERNETSERVER_MAX_EVENTS];
+	int n;
+	do {
+		n = epoll_wait(epollfd, events, ETHERNETSERVER_MAX_EVENTS, 0);
+		for (int i = 0; i < n; i++) {
+			const int sock = events[i].data.fd;
+			if (sock == sockfd) {
+				_accept();
+				continue;
+			}
+			if ((events[i].events & EPOLLOUT) && !_flush(sock)) {
+				continue;
+			}
+			if (!(events[i].events & ~EPOLLOUT)) {
+				continue;
+			}
+			bool owned = true;
+			for (std::list<int>::iterator it = new_clients.begin(); it != new_clients.end(); ++it) {
+				owned &= *it != sock;
+			}
+			if (!owned) {
+				// not handed out yet, data is read once it is, a hang up closes it now
+				if (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+					_hangup(sock);
+				}
+			} else if (std::find(ready.begin(), ready.end(), sock) == ready.end()) {
+				// level triggered, unread data is reported again
+				ready.push_back(sock);
+			}
+		}
+	} while (n == ETHERNETSERVER_MAX_EVENTS);
+}
+
 void EthernetServer::_accept()
 {
 	int new_fd;
@@ -186,26 +457,83 @@ void EthernetServer::_accept()
 	struct sockaddr_storage client_addr;
 	char ipstr[INET_ADDRSTRLEN];
 
-	sin_size = sizeof client_addr;
-	new_fd = accept(sockfd, (struct sockaddr *)&client_addr, &sin_size);
-	if (new_fd == -1) {
-		if (errno != EAGAIN && errno != EWOULDBLOCK) {
-			logError("accept: %s\n", strerror(errno));
+	while (true) {
+		sin_size = sizeof client_addr;
+		new_fd = accept(sockfd, (struct sockaddr *)&client_addr, &sin_size);
+		if (new_fd == -1) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				logError("accept: %s\n", strerror(errno));
+			}
+			return;
 		}
-		return;
+
+		if (clients.size() == max_clients) {
+			// no free slots
+			close(new_fd);
+			logDebug("Max number of ethernet clients reached.\n");
+			continue;
+		}
+
+		// data and hang ups are passed to the owner of the client by readable()
+		struct epoll_event ev;
+		ev.events = EPOLLIN | EPOLLRDHUP;
+		ev.data.fd = new_fd;
+		if (epoll_ctl(epollfd, EPOLL_CTL_ADD, new_fd, &ev) == -1) {
+			logError("epoll_ctl: %s\n", strerror(errno));
+			close(new_fd);
+			continue;
+		}
+
+		new_clients.push_back(new_fd);
+		clients.push_back(new_fd);
+		filters.resize(clients.size());
+		outputs.resize(clients.size());
+
+		void *addr = &(((struct sockaddr_in*)&client_addr)->sin_addr);
+		inet_ntop(client_addr.ss_family, addr, ipstr, sizeof ipstr);
+		logDebug("New connection from %s\n", ipstr);
 	}
+}
 
-	if (clients.size() == max_clients) {
-		// no free slots, search for a dead client
-		close(new_fd);
-		logDebug("Max number of ethernet clients reached.\n");
-		return;
+void EthernetServer::_remove(int sock)
+{
+	epoll_ctl(epollfd, EPOLL_CTL_DEL, sock, NULL);
+	// the number may be reused by the next accept
+	ready.erase(std::remove(ready.begin(), ready.end(), sock), ready.end());
+	for (size_t i = 0; i < clients.size(); ++i) {
+		if (clients[i] == sock) {
+			clients[i] = clients.back();
+			clients.pop_back();
+			filters[i] = filters.back();
+			filters.pop_back();
+			outputs[i].swap(outputs.back());
+			outputs.pop_back();
+			break;
+		}
 	}
+}
+
+void EthernetServer::_hangup(int sock)
+{
+	_remove(sock);
+	logDebug("Ethernet client disconnected.\n");
 
-	new_clients.push_back(new_fd);
-	clients.push_back(new_fd);
+	// nobody took this client yet, so nobody else will close it
+	for (std::list<int>::iterator it = new_clients.begin(); it != new_clients.end(); ++it) {
+		if (*it == sock) {
+			new_clients.erase(it);
+			close(sock);
+			return;
+		}
+	}
+	// the owner finds it disconnected and stops it
+	ready.push_back(sock);
+}
 
-	void *addr = &(((struct sockaddr_in*)&client_addr)->sin_addr);
-	inet_ntop(client_addr.ss_family, addr, ipstr, sizeof ipstr);
-	logDebug("New connection from %s\n", ipstr);
+void EthernetServer::_release(int sock)
+{
+	_remove(sock);
+	// with SO_LINGER off close() returns at once and the kernel finishes the close
+	shutdown(sock, SHUT_RDWR);
+	close(sock);
 }
@@ -23,6 +23,7 @@
 #define EthernetServer_h
 
 #include <list>
+#include <string>
 #include <vector>
 #include "Server.h"
 #include "IPAddress.h"
@@ -34,6 +35,11 @@
 #define ETHERNETSERVER_BACKLOG 10 //!< Maximum length to which the queue of pending connections may grow.
 #endif
 
+#define ETHERNETSERVER_MAX_EVENTS 16 //!< Socket events handled per epoll_wait() call.
+#define ETHERNETSERVER_MAX_SUBSCRIPTIONS 32 //!< Subscriptions per client, one bit each in the filter masks.
+#define ETHERNETSERVER_MAX_COMMAND 7 //!< Highest message command a subscription can name, 3 bits.
+#define ETHERNETSERVER_MAX_OUTPUT 65536 //!< Bytes kept per client while its socket is full.
+
 class EthernetClient;
 
 /**
@@ -64,9 +70,23 @@ public:
 	/**
 	 * @brief Verifies if a new client has connected.
 	 *
+	 * Handles the pending socket events: new connections are accepted, clients with data or a
+	 * hang up are queued for readable().
+	 *
 	 * @return @c true if a new client has connected, else @c false.
 	 */
 	bool hasClient();
+	/**
+	 * @brief Get the next client socket with pending events.
+	 *
+	 * A client is returned when it has data to read, its peer hung up or a write to it failed,
+	 * as of the last hasClient(). Its owner reads it and stops it if it is no longer connected.
+	 * Output a client does not take at once is kept and sent when its socket is writable again,
+	 * a client falling more than ETHERNETSERVER_MAX_OUTPUT bytes behind is disconnected.
+	 *
+	 * @return socket of the client, -1 if none is pending.
+	 */
+	int readable();
 	/**
 	 * @brief Get the new connected client.
 	 *
@@ -103,19 +123,137 @@ public:
 	 * @return 0 if FAILURE else the number of characters sent.
 	 */
 	size_t write(const char *buffer, size_t size);
+	/**
+	 * @brief Write at most 'size' characters to the clients subscribed to a message.
+	 *
+	 * A client whose subscriptions exclude the message counts as served.
+	 *
+	 * @param buffer to read from.
+	 * @param size of the buffer.
+	 * @param node sender of the message.
+	 * @param sensor child sensor id of the message.
+	 * @param command command of the message.
+	 * @param type type of the message.
+	 * @return 0 if FAILURE or no client is connected else the number of characters sent.
+	 */
+	size_t write(const char *buffer, size_t size, uint16_t node, uint8_t sensor, uint8_t command,
+	             uint8_t type);
+	/**
+	 * @brief Write at most 'size' characters to one client only.
+	 *
+	 * @param client to write to.
+	 * @param buffer to read from.
+	 * @param size of the buffer.
+	 * @return 0 if FAILURE or the client is not connected else the number of characters sent.
+	 */
+	size_t write(EthernetClient &client, const char *buffer, size_t size);
+	/**
+	 * @brief Apply a subscription command sent by a client.
+	 *
+	 * "SUB <node>;<sensor>;<command>;<type>" adds a subscription, each field is '*' or a comma
+	 * separated list of numbers and ranges, e.g. "SUB 1,5-7;*;1;0". The fields follow the order of
+	 * the serial protocol, a type only has a meaning together with its command. A client without
+	 * subscriptions gets every message. "UNSUB" removes all subscriptions of the client. Nodes
+	 * above 255 only match subscriptions accepting every node.
+	 *
+	 * @param client the command came from.
+	 * @param command line received from the client.
+	 * @return @c true if the line was a subscription command, else @c false.
+	 */
+	bool subscribe(EthernetClient &client, const char *command);
 
 private:
+	/**
+	 * @brief Subscriptions of a client, compiled to one mask per field value.
+	 *
+	 * Bit n of node[x] is set if subscription n accepts node x, likewise for sensor, command and
+	 * type. A message passes if the masks of its node, sensor, command and type share a bit.
+	 */
+	struct subscription {
+		uint8_t count; //!< @brief Number of subscriptions, 0 accepts every message.
+		uint32_t node[256]; //!< @brief Masks by node id.
+		uint32_t anyNode; //!< @brief Mask of the subscriptions accepting every node id.
+		uint32_t sensor[256]; //!< @brief Masks by child sensor id.
+		uint32_t command[ETHERNETSERVER_MAX_COMMAND + 1]; //!< @brief Masks by message command.
+		uint32_t type[256]; //!< @brief Masks by message type.
+	};
+
 	uint16_t port; //!< @brief Port number for the network socket.
 	std::list<int> new_clients; //!< Socket list of new connected clients.
 	std::vector<int> clients; //!< @brief Socket list of connected clients.
+	std::vector<int> ready; //!< @brief Client sockets with pending events, see readable().
+	std::vector<subscription> filters; //!< @brief Subscriptions of the clients, same order.
+	std::vector<std::string> outputs; //!< @brief Output not taken yet by the clients, same order.
 	uint16_t max_clients; //!< @brief The maximum number of allowed clients.
 	int sockfd; //!< @brief Network socket used to accept connections.
+	int epollfd; //!< @brief Event queue of the listening socket and the clients.
 
+	/**
+	 * @brief Write to all clients, or to those subscribed to a message.
+	 *
+	 * @param buffer to read from.
+	 * @param size of the buffer.
+	 * @param filtered whether to apply the subscriptions.
+	 * @param node sender of the message.
+	 * @param sensor child sensor id of the message.
+	 * @param command command of the message.
+	 * @param type type of the message.
+	 * @return 0 if FAILURE else number of bytes sent.
+	 */
+	size_t _write(const uint8_t *buffer, size_t size, bool filtered, uint16_t node, uint8_t sensor,
+	              uint8_t command, uint8_t type);
+	/**
+	 * @brief Send to a client, keep what its socket does not take.
+	 *
+	 * @param i index of the client.
+	 * @param buffer to read from.
+	 * @param size of the buffer.
+	 * @return @c false if the connection failed or the client fell too far behind.
+	 */
+	bool _send(size_t i, const uint8_t *buffer, size_t size);
+	/**
+	 * @brief Send the output kept for a client whose socket became writable.
+	 *
+	 * @param sock socket of the client.
+	 * @return @c false if the client is gone.
+	 */
+	bool _flush(int sock);
+	/**
+	 * @brief Watch a client socket for being writable, or stop watching.
+	 *
+	 * @param sock socket of the client.
+	 * @param writable whether to watch for EPOLLOUT.
+	 */
+	void _watch(int sock, bool writable);
+	/**
+	 * @brief Remove a client from the socket list.
+	 *
+	 * @param sock socket of the client.
+	 */
+	void _remove(int sock);
+	/**
+	 * @brief Handle the pending socket events.
+	 */
+	void _poll();
 	/**
 	 * @brief Accept new clients if the total of connected clients is below max_clients.
 	 *
 	 */
 	void _accept();
+	/**
+	 * @brief Stop writing to a client whose connection failed, its owner is told by readable().
+	 *
+	 * @param sock socket of the client.
+	 */
+	void _hangup(int sock);
+	/**
+	 * @brief Close a client socket handed out by available().
+	 *
+	 * @param sock socket of the client.
+	 */
+	void _release(int sock);
+
+	friend class EthernetClient;
 };
 
 #endif
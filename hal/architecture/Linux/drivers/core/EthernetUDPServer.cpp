@@ -0,0 +1,329 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "EthernetUDPServer.h"
+#include <cstdio>
+#include <cstring>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "log.h"
+#include "clock.h"
+
+EthernetUDPServer::EthernetUDPServer(uint16_t port, uint16_t max_controllers,
+                                     uint32_t controller_timeout_ms) : port(port), max_controllers(max_controllers),
+	controller_timeout_ms(controller_timeout_ms), sockfd(-1), new_controller(false), rx_count(0),
+	rx_index(0), rx_offset(0), rx_last(-1), tx_count(0)
+{
+	controllers.reserve(max_controllers);
+	tx_msgs.resize(max_controllers * ETHERNETUDPSERVER_BATCH);
+}
+
+void EthernetUDPServer::begin()
+{
+	begin(IPAddress(0,0,0,0));
+}
+
+void EthernetUDPServer::begin(IPAddress address)
+{
+	struct addrinfo hints, *servinfo, *p;
+	int yes=1;
+	int rv;
+	char ipstr[INET_ADDRSTRLEN];
+	char portstr[6];
+
+	if (sockfd != -1) {
+		close(sockfd);
+		sockfd = -1;
+	}
+
+	memset(&hints, 0, sizeof hints);
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	sprintf(portstr, "%d", port);
+	if ((rv = getaddrinfo(address.toString().c_str(), portstr, &hints, &servinfo)) != 0) {
+		logError("getaddrinfo: %s\n", gai_strerror(rv));
+		return;
+	}
+
+	// loop through all the results and bind to the first we can
+	for (p = servinfo; p != NULL; p = p->ai_next) {
+		if ((sockfd = socket(p->ai_family, p->ai_socktype, p->ai_protocol)) == -1) {
+			logError("socket: %s\n", strerror(errno));
+			continue;
+		}
+
+		if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) == -1) {
+			logError("setsockopt: %s\n", strerror(errno));
+			freeaddrinfo(servinfo);
+			return;
+		}
+
+		if (bind(sockfd, p->ai_addr, p->ai_addrlen) == -1) {
+			close(sockfd);
+			sockfd = -1;
+			logError("bind: %s\n", strerror(errno));
+			continue;
+		}
+
+		break;
+	}
+
+	if (p == NULL)  {
+		logError("Failed to bind!\n");
+		freeaddrinfo(servinfo);
+		return;
+	}
+
+	fcntl(sockfd, F_SETFL, O_NONBLOCK);
+
+	struct sockaddr_in *ipv4 = (struct sockaddr_in *)p->ai_addr;
+	void *addr = &(ipv4->sin_addr);
+	inet_ntop(p->ai_family, addr, ipstr, sizeof ipstr);
+	logDebug("Listening for datagrams on %s:%s\n", ipstr, portstr);
+
+	freeaddrinfo(servinfo);
+}
+
+int EthernetUDPServer::read(char *buffer, size_t size)
+{
+	rx_last = -1;
+	while (true) {
+		if (rx_index >= rx_count && !_receive()) {
+			return 0;
+		}
+
+		const char *data = rx_buffer[rx_index];
+		const size_t length = rx_length[rx_index];
+		while (rx_offset < length && (data[rx_offset] == '\n' || data[rx_offset] == '\r')) {
+			rx_offset++;
+		}
+		if (rx_offset == length) {
+			// nothing left in this datagram
+			rx_index++;
+			rx_offset = 0;
+			continue;
+		}
+
+		size_t end = rx_offset;
+		while (end < length && data[end] != '\n' && data[end] != '\r') {
+			end++;
+		}
+		size_t n = end - rx_offset;
+		if (n > size - 1) {
+			n = size - 1;
+		}
+		memcpy(buffer, data + rx_offset, n);
+		buffer[n] = 0;
+		rx_offset = end;
+		rx_last = rx_index;
+		return n;
+	}
+}
+
+void EthernetUDPServer::registerSender()
+{
+	if (rx_last == -1) {
+		return;
+	}
+	const struct sockaddr_storage &addr = rx_addr[rx_last];
+	const socklen_t addrlen = rx_addrlen[rx_last];
+	for (size_t i = 0; i < controllers.size(); i++) {
+		if (controllers[i].addrlen == addrlen && memcmp(&controllers[i].addr, &addr, addrlen) == 0) {
+			controllers[i].heard = clockTickMillis();
+			return;
+		}
+	}
+
+	size_t slot = controllers.size();
+	if (slot == max_controllers) {
+		// forget the controller heard from least recently
+		slot = 0;
+		for (size_t i = 1; i < controllers.size(); i++) {
+			if (controllers[i].heard < controllers[slot].heard) {
+				slot = i;
+			}
+		}
+		_log("Replaced controller", controllers[slot].addr, controllers[slot].addrlen);
+	} else {
+		controllers.push_back(controller());
+	}
+	memcpy(&controllers[slot].addr, &addr, addrlen);
+	controllers[slot].addrlen = addrlen;
+	controllers[slot].heard = clockTickMillis();
+	new_controller = true;
+	_log("New controller", addr, addrlen);
+}
+
+bool EthernetUDPServer::hasNewController()
+{
+	const bool result = new_controller;
+	new_controller = false;
+	return result;
+}
+
+size_t EthernetUDPServer::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+size_t EthernetUDPServer::write(const uint8_t *buffer, size_t size)
+{
+	if (controllers.empty() || size == 0) {
+		return 0;
+	}
+	if (size > ETHERNETUDPSERVER_DATAGRAM_SIZE) {
+		size = ETHERNETUDPSERVER_DATAGRAM_SIZE;
+	}
+
+	// append to the last datagram, or start a new one if it does not fit
+	if (tx_count == 0 || tx_length[tx_count - 1] + size > ETHERNETUDPSERVER_DATAGRAM_SIZE) {
+		if (tx_count == ETHERNETUDPSERVER_BATCH) {
+			flush();
+		}
+		tx_length[tx_count++] = 0;
+	}
+	memcpy(tx_buffer[tx_count - 1] + tx_length[tx_count - 1], buffer, size);
+	tx_length[tx_count - 1] += size;
+
+	return size;
+}
+
+size_t EthernetUDPServer::write(const char *str)
+{
+	if (str == NULL) {
+		return 0;
+	}
+	return write((const uint8_t *)str, strlen(str));
+}
+
+size_t EthernetUDPServer::write(const char *buffer, size_t size)
+{
+	return write((const uint8_t *)buffer, size);
+}
+
+void EthernetUDPServer::flush()
+{
+	_expire();
+	if (tx_count == 0) {
+		return;
+	}
+
+	struct iovec iovecs[ETHERNETUDPSERVER_BATCH];
+	for (unsigned int i = 0; i < tx_count; i++) {
+		iovecs[i].iov_base = tx_buffer[i];
+		iovecs[i].iov_len = tx_length[i];
+	}
+
+	unsigned int total = 0;
+	for (size_t c = 0; c < controllers.size(); c++) {
+		for (unsigned int i = 0; i < tx_count; i++) {
+			struct mmsghdr &msg = tx_msgs[total++];
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_hdr.msg_name = &controllers[c].addr;
+			msg.msg_hdr.msg_namelen = controllers[c].addrlen;
+			msg.msg_hdr.msg_iov = &iovecs[i];
+			msg.msg_hdr.msg_iovlen = 1;
+		}
+	}
+
+	// usually everything goes out in one call, sendmmsg() may stop early though
+	unsigned int sent = 0;
+	while (sent < total) {
+		const int rc = sendmmsg(sockfd, &tx_msgs[sent], total - sent, MSG_DONTWAIT);
+		if (rc == -1) {
+			logError("sendmmsg: %s\n", strerror(errno));
+			break;
+		}
+		sent += rc;
+	}
+
+	tx_count = 0;
+}
+
+bool EthernetUDPServer::_receive()
+{
+	rx_count = 0;
+	rx_index = 0;
+	rx_offset = 0;
+
+	if (sockfd == -1) {
+		return false;
+	}
+
+	struct mmsghdr msgs[ETHERNETUDPSERVER_BATCH];
+	struct iovec iovecs[ETHERNETUDPSERVER_BATCH];
+	memset(msgs, 0, sizeof(msgs));
+	for (unsigned int i = 0; i < ETHERNETUDPSERVER_BATCH; i++) {
+		iovecs[i].iov_base = rx_buffer[i];
+		iovecs[i].iov_len = ETHERNETUDPSERVER_DATAGRAM_SIZE;
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &rx_addr[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(rx_addr[i]);
+	}
+
+	const int n = recvmmsg(sockfd, msgs, ETHERNETUDPSERVER_BATCH, MSG_DONTWAIT, NULL);
+	if (n == -1) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			logError("recvmmsg: %s\n", strerror(errno));
+		}
+		return false;
+	}
+
+	for (int i = 0; i < n; i++) {
+		rx_length[i] = msgs[i].msg_len;
+		rx_addrlen[i] = msgs[i].msg_hdr.msg_namelen;
+	}
+	rx_count = n;
+
+	return n > 0;
+}
+
+void EthernetUDPServer::_expire()
+{
+	if (controller_timeout_ms == 0) {
+		return;
+	}
+	const uint64_t now = clockTickMillis();
+	for (size_t i = 0; i < controllers.size();) {
+		if (now - controllers[i].heard > controller_timeout_ms) {
+			_log("Controller timed out", controllers[i].addr, controllers[i].addrlen);
+			controllers[i] = controllers.back();
+			controllers.pop_back();
+		} else {
+			i++;
+		}
+	}
+}
+
+void EthernetUDPServer::_log(const char *what, const struct sockaddr_storage &addr,
+                             socklen_t addrlen)
+{
+	char host[NI_MAXHOST];
+	char service[NI_MAXSERV];
+	if (getnameinfo((const struct sockaddr *)&addr, addrlen, host, sizeof(host), service,
+	                sizeof(service), NI_NUMERICHOST | NI_NUMERICSERV) == 0) {
+		logDebug("%s %s:%s\n", what, host, service);
+	}
+}
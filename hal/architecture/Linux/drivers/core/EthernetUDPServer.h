@@ -0,0 +1,178 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef EthernetUDPServer_h
+#define EthernetUDPServer_h
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <vector>
+#include "Server.h"
+#include "IPAddress.h"
+
+#define ETHERNETUDPSERVER_MAX_CONTROLLERS 10 //!< Default value for max_controllers.
+#define ETHERNETUDPSERVER_BATCH 16 //!< Datagrams per recvmmsg()/sendmmsg() call.
+#define ETHERNETUDPSERVER_DATAGRAM_SIZE 1472 //!< Largest datagram, fits an Ethernet frame.
+#define ETHERNETUDPSERVER_CONTROLLER_TIMEOUT_MS 600000 //!< Default value for controller_timeout_ms.
+
+/**
+ * @brief EthernetUDPServer class
+ *
+ * UDP counterpart of EthernetServer. A datagram may carry several newline separated messages,
+ * the owner registers the sender of a valid message as controller with registerSender().
+ * Controllers not heard from for controller_timeout_ms are forgotten. Messages written to
+ * the server are packed into datagrams and sent to all registered controllers by flush(),
+ * with a single sendmmsg() call for everything written since the last flush.
+ */
+class EthernetUDPServer : public Server
+{
+
+public:
+	/**
+	 * @brief EthernetUDPServer constructor.
+	 *
+	 * @param port number for the socket addresses.
+	 * @param max_controllers The maximum number of registered controllers, when a new one
+	 *        registers the one heard from least recently is forgotten.
+	 * @param controller_timeout_ms Time after which a controller that sent nothing is
+	 *        forgotten, 0 to keep controllers until they are replaced.
+	 */
+	EthernetUDPServer(uint16_t port,
+	                  uint16_t max_controllers = ETHERNETUDPSERVER_MAX_CONTROLLERS,
+	                  uint32_t controller_timeout_ms = ETHERNETUDPSERVER_CONTROLLER_TIMEOUT_MS);
+	/**
+	 * @brief Listen for datagrams on all addresses.
+	 */
+	virtual void begin();
+	/**
+	 * @brief Listen for datagrams on the specified ip.
+	 *
+	 * @param address IP address to bind to.
+	 */
+	void begin(IPAddress address);
+	/**
+	 * @brief Read the next message received from any controller.
+	 *
+	 * Received datagrams are fetched in batches with recvmmsg().
+	 *
+	 * @param buffer to write the null-terminated message to, without the newline.
+	 * @param size of the buffer, longer messages are truncated.
+	 * @return length of the message, 0 if none is available.
+	 */
+	int read(char *buffer, size_t size);
+	/**
+	 * @brief Register the sender of the message last returned by read() as controller, or
+	 *        refresh it.
+	 *
+	 * Only called for valid messages, so stray datagrams do not register their sender.
+	 */
+	void registerSender();
+	/**
+	 * @brief Whether a controller registered since the last call.
+	 *
+	 * @return @c true if a new controller registered, else @c false.
+	 */
+	bool hasNewController();
+	/**
+	 * @brief Queue a byte for all controllers.
+	 *
+	 * @param b byte to send.
+	 * @return 0 if FAILURE or 1 if SUCCESS.
+	 */
+	virtual size_t write(uint8_t b);
+	/**
+	 * @brief Queue 'size' bytes for all controllers, they are kept in one datagram.
+	 *
+	 * @param buffer to read from.
+	 * @param size of the buffer.
+	 * @return 0 if no controller is registered else number of bytes queued.
+	 */
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	/**
+	 * @brief Queue a null-terminated string for all controllers.
+	 *
+	 * @param str String to write.
+	 * @return 0 if no controller is registered else number of characters queued.
+	 */
+	size_t write(const char *str);
+	/**
+	 * @brief Queue 'size' characters for all controllers.
+	 *
+	 * @param buffer to read from.
+	 * @param size of the buffer.
+	 * @return 0 if no controller is registered else number of characters queued.
+	 */
+	size_t write(const char *buffer, size_t size);
+	/**
+	 * @brief Send the queued datagrams to all controllers, forget those that timed out.
+	 */
+	void flush();
+
+private:
+	/**
+	 * @brief A registered controller.
+	 */
+	struct controller {
+		struct sockaddr_storage addr; //!< @brief Address datagrams come from and go to.
+		socklen_t addrlen; //!< @brief Length of addr.
+		uint64_t heard; //!< @brief Time (clockMillis()) the controller was last heard.
+	};
+
+	uint16_t port; //!< @brief Port number for the network socket.
+	uint16_t max_controllers; //!< @brief The maximum number of registered controllers.
+	uint32_t controller_timeout_ms; //!< @brief Time after which a quiet controller is forgotten.
+	int sockfd; //!< @brief Network socket.
+	bool new_controller; //!< @brief A controller registered since hasNewController().
+	std::vector<controller> controllers; //!< @brief Registered controllers.
+
+	char rx_buffer[ETHERNETUDPSERVER_BATCH][ETHERNETUDPSERVER_DATAGRAM_SIZE]; //!< @brief Received datagrams.
+	size_t rx_length[ETHERNETUDPSERVER_BATCH]; //!< @brief Their lengths.
+	struct sockaddr_storage rx_addr[ETHERNETUDPSERVER_BATCH]; //!< @brief Their senders.
+	socklen_t rx_addrlen[ETHERNETUDPSERVER_BATCH]; //!< @brief Lengths of the sender addresses.
+	unsigned int rx_count; //!< @brief Number of datagrams in rx_buffer.
+	unsigned int rx_index; //!< @brief Datagram read() is at.
+	size_t rx_offset; //!< @brief Position of read() in that datagram.
+	int rx_last; //!< @brief Datagram of the message last returned by read(), -1 if none.
+
+	char tx_buffer[ETHERNETUDPSERVER_BATCH][ETHERNETUDPSERVER_DATAGRAM_SIZE]; //!< @brief Queued datagrams.
+	size_t tx_length[ETHERNETUDPSERVER_BATCH]; //!< @brief Their lengths.
+	unsigned int tx_count; //!< @brief Number of datagrams in tx_buffer, the last one may grow.
+	std::vector<struct mmsghdr> tx_msgs; //!< @brief sendmmsg() vector, every datagram to every controller.
+
+	/**
+	 * @brief Fetch the next batch of datagrams.
+	 *
+	 * @return @c true if a datagram was received.
+	 */
+	bool _receive();
+	/**
+	 * @brief Forget the controllers not heard from for controller_timeout_ms.
+	 */
+	void _expire();
+	/**
+	 * @brief Log a controller address.
+	 *
+	 * @param what event to log.
+	 * @param addr address of the controller.
+	 * @param addrlen length of addr.
+	 */
+	void _log(const char *what, const struct sockaddr_storage &addr, socklen_t addrlen);
+};
+
+#endif
@@ -35,14 +35,21 @@ GPIOClass::GPIOClass()
 	DIR* dp;
 	char file[64];
 
+	lastPinNum = 0;
+
 	dp = opendir("/sys/class/gpio");
 	if (dp == NULL) {
+#if defined(MY_RADIO_REPLAY) || defined(MY_SIMULATION)
+		// replay and simulation need no hardware, allow running on any host
+		exportedPins = new uint8_t[1];
+		exportedPins[0] = 0;
+		return;
+#else
 		logError("Could not open /sys/class/gpio directory");
 		exit(1);
+#endif
 	}
 
-	lastPinNum = 0;
-
 	while (true) {
 		dirent *de = readdir(dp);
 		if (de == NULL) {
@@ -0,0 +1,102 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef SimStream_h
+#define SimStream_h
+
+#include "Stream.h"
+#include "sim.h"
+
+/**
+ * @brief A class that connects the gateway serial protocol to the simulated controller
+ */
+class SimStream : public Stream
+{
+
+public:
+	/**
+	 * @brief SimStream constructor.
+	 */
+	SimStream() : _peek(-1) {}
+	/**
+	 * @brief This function does nothing.
+	 *
+	 * @param baud Ignored parameter.
+	 */
+	void begin(int baud)
+	{
+		(void)baud;
+	}
+	/**
+	 * @brief Check if the controller sent data.
+	 *
+	 * @return 1 if a byte is available, else 0.
+	 */
+	int available()
+	{
+		if (_peek < 0) {
+			_peek = simSelf->controller_read(simSelf);
+		}
+		return _peek >= 0;
+	}
+	/**
+	 * @brief Read a byte sent by the controller.
+	 *
+	 * @return the byte or -1 if none available.
+	 */
+	int read()
+	{
+		const int c = available() ? _peek : -1;
+		_peek = -1;
+		return c;
+	}
+	/**
+	 * @brief Writes a single byte to the controller.
+	 *
+	 * @param b byte to write.
+	 * @return always returns 1.
+	 */
+	size_t write(uint8_t b)
+	{
+		simSelf->controller_write(simSelf, b);
+		return 1;
+	}
+	/**
+	 * @brief Peek at the next byte sent by the controller.
+	 *
+	 * @return the byte or -1 if none available.
+	 */
+	int peek()
+	{
+		return available() ? _peek : -1;
+	}
+	/**
+	 * @brief Nothing to do.
+	 */
+	void flush() {}
+	/**
+	 * @brief Nothing to do.
+	 */
+	void end() {}
+
+private:
+	int _peek;	//!< byte read ahead by available()
+};
+
+#endif
@@ -0,0 +1,286 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "capture.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "log.h"
+
+#define CAPTURE_SLOTS 1024			// power of 2
+#define CAPTURE_MAX_FRAME 32		// MAX_MESSAGE_LENGTH
+#define CAPTURE_PSEUDO_HEADER_SIZE 12
+#define CAPTURE_VERSION 1
+
+/*
+ * pcap record, nanosecond resolution (magic 0xa1b23c4d). The frame is preceded by a pseudo
+ * header, all fields little endian:
+ *   0 version, 1 direction, 2 hop (TX: next hop, RX: last hop), 3 TX result, 4 retries,
+ *   5 reserved, 6-7 RSSI, 8-9 SNR, 10-11 reserved
+ */
+struct capture_slot {
+	uint32_t ts_sec;
+	uint32_t ts_nsec;
+	uint32_t incl_len;
+	uint32_t orig_len;
+	uint8_t data[CAPTURE_PSEUDO_HEADER_SIZE + CAPTURE_MAX_FRAME];
+};
+
+static struct capture_slot _capture_ring[CAPTURE_SLOTS];
+static unsigned int _capture_head = 0;		// next slot to fill
+static unsigned int _capture_tail = 0;		// next slot to write
+static unsigned long _capture_dropped = 0;
+static volatile int _capture_running = 0;
+static pthread_t _capture_thread;
+static pthread_mutex_t _capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _capture_cond = PTHREAD_COND_INITIALIZER;
+
+static char *_capture_file = NULL;
+static long _capture_max_size = 0;
+static int _capture_max_files = 0;
+static int _capture_is_fifo = 0;
+static FILE *_capture_fp = NULL;
+static long _capture_size = 0;
+static int _capture_failed = 0;
+
+static int _capture_open_file(void)
+{
+	const uint32_t header[6] = {
+		0xa1b23c4d,					// magic, nanosecond timestamps
+		0x00040002,					// version 2.4
+		0,							// thiszone
+		0,							// sigfigs
+		65535,						// snaplen
+		CAPTURE_LINKTYPE
+	};
+
+	if (_capture_is_fifo) {
+		// fails with ENXIO while nobody is reading, frames are discarded until then
+		const int fd = open(_capture_file, O_WRONLY | O_NONBLOCK);
+		if (fd < 0) {
+			return -1;
+		}
+		(void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+		_capture_fp = fdopen(fd, "w");
+		if (_capture_fp == NULL) {
+			close(fd);
+			return -1;
+		}
+	} else {
+		_capture_fp = fopen(_capture_file, "w");
+		if (_capture_fp == NULL) {
+			logError("Failed to open capture file %s: %s\n", _capture_file, strerror(errno));
+			_capture_failed = 1;
+			return -1;
+		}
+	}
+	if (fwrite(header, sizeof(header), 1, _capture_fp) != 1) {
+		fclose(_capture_fp);
+		_capture_fp = NULL;
+		return -1;
+	}
+	_capture_size = sizeof(header);
+	return 0;
+}
+
+static void _capture_rotate(void)
+{
+	char from[PATH_MAX];
+	char to[PATH_MAX];
+
+	fclose(_capture_fp);
+	_capture_fp = NULL;
+	for (int i = _capture_max_files - 1; i > 0; i--) {
+		if (i == 1) {
+			snprintf(from, sizeof(from), "%s", _capture_file);
+		} else {
+			snprintf(from, sizeof(from), "%s.%d", _capture_file, i - 1);
+		}
+		snprintf(to, sizeof(to), "%s.%d", _capture_file, i);
+		(void)rename(from, to);
+	}
+	(void)_capture_open_file();
+}
+
+static void *_capture_writer(void *arg)
+{
+	static struct capture_slot batch[CAPTURE_SLOTS];
+	unsigned long reported = 0;
+	sigset_t signals;
+
+	(void)arg;
+	// signals are handled by the main thread: a FIFO reader going away makes writes fail
+	// with EPIPE instead of raising SIGPIPE, and SIGINT cannot join this thread from itself
+	sigfillset(&signals);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+	while (_capture_running) {
+		unsigned int count = 0;
+
+		pthread_mutex_lock(&_capture_mutex);
+		while (_capture_running && _capture_head == _capture_tail) {
+			pthread_cond_wait(&_capture_cond, &_capture_mutex);
+		}
+		while (_capture_tail != _capture_head) {
+			batch[count++] = _capture_ring[_capture_tail];
+			_capture_tail = (_capture_tail + 1) & (CAPTURE_SLOTS - 1);
+		}
+		const unsigned long dropped = _capture_dropped;
+		pthread_mutex_unlock(&_capture_mutex);
+
+		if (dropped != reported) {
+			logWarning("Capture buffer overrun, %lu frames dropped.\n", dropped - reported);
+			reported = dropped;
+		}
+		if (_capture_failed || (_capture_fp == NULL && _capture_open_file() != 0)) {
+			continue;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			const size_t len = 16 + batch[i].incl_len;
+			if (fwrite(&batch[i], len, 1, _capture_fp) != 1) {
+				if (!_capture_is_fifo) {
+					logError("Failed to write capture file %s: %s\n", _capture_file, strerror(errno));
+					_capture_failed = 1;
+				}
+				// a FIFO reader went away (EPIPE), reopen with the next batch
+				fclose(_capture_fp);
+				_capture_fp = NULL;
+				break;
+			}
+			_capture_size += len;
+		}
+		if (_capture_fp != NULL) {
+			if (fflush(_capture_fp) != 0 && _capture_is_fifo) {
+				fclose(_capture_fp);
+				_capture_fp = NULL;
+			} else if (!_capture_is_fifo && _capture_max_size && _capture_size >= _capture_max_size) {
+				_capture_rotate();
+			}
+		}
+	}
+	return NULL;
+}
+
+int captureOpen(const char *file, int max_size_kb, int max_files)
+{
+	struct stat fileInfo;
+
+	if (file == NULL || _capture_running) {
+		return -1;
+	}
+	_capture_file = strdup(file);
+	if (_capture_file == NULL) {
+		return -1;
+	}
+	_capture_is_fifo = (stat(file, &fileInfo) == 0 && S_ISFIFO(fileInfo.st_mode));
+	_capture_max_size = (long)max_size_kb * 1024;
+	_capture_max_files = max_files > 1 ? max_files : 1;
+	_capture_failed = 0;
+	_capture_running = 1;
+	if (pthread_create(&_capture_thread, NULL, _capture_writer, NULL) != 0) {
+		logError("Failed to start capture thread.\n");
+		_capture_running = 0;
+		free(_capture_file);
+		_capture_file = NULL;
+		return -1;
+	}
+	logInfo("Capturing radio frames to %s\n", file);
+	return 0;
+}
+
+void captureFrame(uint8_t direction, uint8_t hop, uint8_t tx_result, uint8_t retries,
+                  int16_t rssi, int16_t snr, const void *frame, uint8_t length)
+{
+	struct timespec ts;
+
+	if (!_capture_running) {
+		return;
+	}
+	if (length > CAPTURE_MAX_FRAME) {
+		length = CAPTURE_MAX_FRAME;
+	}
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	pthread_mutex_lock(&_capture_mutex);
+	const unsigned int next = (_capture_head + 1) & (CAPTURE_SLOTS - 1);
+	if (next == _capture_tail) {
+		// never block the radio path, writer reports the loss
+		_capture_dropped++;
+		pthread_mutex_unlock(&_capture_mutex);
+		return;
+	}
+	struct capture_slot *slot = &_capture_ring[_capture_head];
+	slot->ts_sec = (uint32_t)ts.tv_sec;
+	slot->ts_nsec = (uint32_t)ts.tv_nsec;
+	slot->incl_len = CAPTURE_PSEUDO_HEADER_SIZE + length;
+	slot->orig_len = slot->incl_len;
+	slot->data[0] = CAPTURE_VERSION;
+	slot->data[1] = direction;
+	slot->data[2] = hop;
+	slot->data[3] = tx_result;
+	slot->data[4] = retries;
+	slot->data[5] = 0;
+	slot->data[6] = (uint8_t)rssi;
+	slot->data[7] = (uint8_t)((uint16_t)rssi >> 8);
+	slot->data[8] = (uint8_t)snr;
+	slot->data[9] = (uint8_t)((uint16_t)snr >> 8);
+	slot->data[10] = 0;
+	slot->data[11] = 0;
+	memcpy(&slot->data[CAPTURE_PSEUDO_HEADER_SIZE], frame, length);
+	_capture_head = next;
+	pthread_cond_signal(&_capture_cond);
+	pthread_mutex_unlock(&_capture_mutex);
+}
+
+int captureActive(void)
+{
+	return _capture_running;
+}
+
+// unlocked, a snapshot for diagnostics
+unsigned int capturePending(void)
+{
+	return (_capture_head - _capture_tail) & (CAPTURE_SLOTS - 1);
+}
+
+void captureClose(void)
+{
+	if (!_capture_running) {
+		return;
+	}
+	pthread_mutex_lock(&_capture_mutex);
+	_capture_running = 0;
+	pthread_cond_signal(&_capture_cond);
+	pthread_mutex_unlock(&_capture_mutex);
+	pthread_join(_capture_thread, NULL);
+
+	if (_capture_fp != NULL) {
+		fclose(_capture_fp);
+		_capture_fp = NULL;
+	}
+	free(_capture_file);
+	_capture_file = NULL;
+}
@@ -0,0 +1,52 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_LINKTYPE 147		// LINKTYPE_USER0, decoded by mysensors.lua
+
+#define CAPTURE_DIRECTION_RX 0
+#define CAPTURE_DIRECTION_TX 1
+
+#define CAPTURE_TX_NACK 0
+#define CAPTURE_TX_OK 1
+#define CAPTURE_TX_UNKNOWN 2		// passive mode, no ACK requested
+#define CAPTURE_TX_NONE 0xFF		// received frame
+
+#define CAPTURE_UNKNOWN 0xFF		// hop or retries not available
+
+int captureOpen(const char *file, int max_size_kb, int max_files);
+void captureFrame(uint8_t direction, uint8_t hop, uint8_t tx_result, uint8_t retries,
+                  int16_t rssi, int16_t snr, const void *frame, uint8_t length);
+int captureActive(void);
+unsigned int capturePending(void);
+void captureClose(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
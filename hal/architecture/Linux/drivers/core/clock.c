@@ -0,0 +1,76 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "clock.h"
+#include <time.h>
+
+static uint64_t _clock_start = 0;				// ns, CLOCK_MONOTONIC at program start
+static uint64_t _clock_coarse_start = 0;		// ns, same instant on the tick clock
+static clockid_t _clock_tick_id = CLOCK_MONOTONIC;
+static uint64_t _clock_tick = 0;				// ms, main thread only
+
+static uint64_t _clock_read(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+// before main() and before any thread, the hot path needs no initialized check
+__attribute__((constructor)) static void _clock_init(void)
+{
+	struct timespec res;
+
+#ifdef CLOCK_MONOTONIC_COARSE
+	if (clock_getres(CLOCK_MONOTONIC_COARSE, &res) == 0 && res.tv_sec == 0 &&
+	        res.tv_nsec <= 1000000) {
+		_clock_tick_id = CLOCK_MONOTONIC_COARSE;
+	}
+#else
+	(void)res;
+#endif
+	_clock_start = _clock_read(CLOCK_MONOTONIC);
+	_clock_coarse_start = _clock_read(_clock_tick_id);
+}
+
+uint64_t clockNanos(void)
+{
+	return _clock_read(CLOCK_MONOTONIC) - _clock_start;
+}
+
+uint64_t clockMicros(void)
+{
+	return clockNanos() / 1000;
+}
+
+uint64_t clockMillis(void)
+{
+	return clockNanos() / 1000000;
+}
+
+void clockTick(void)
+{
+	_clock_tick = (_clock_read(_clock_tick_id) - _clock_coarse_start) / 1000000;
+}
+
+uint64_t clockTickMillis(void)
+{
+	return _clock_tick;
+}
@@ -0,0 +1,50 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Time since program start on CLOCK_MONOTONIC, never stepped by NTP or settimeofday().
+ * 64 bit, callers truncating to 32 bit get the Arduino wraparound.
+ */
+uint64_t clockNanos(void);
+uint64_t clockMicros(void);
+uint64_t clockMillis(void);
+
+/*
+ * Timestamp cached by clockTick() on every yield of the main thread, for code that needs
+ * the time often but not more precise than a main loop iteration: one clock read per yield
+ * instead of one per call. Read from the cheaper CLOCK_MONOTONIC_COARSE when its resolution is 1 ms
+ * or better. Main thread only.
+ */
+void clockTick(void);
+uint64_t clockTickMillis(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
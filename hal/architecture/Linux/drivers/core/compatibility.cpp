@@ -17,40 +17,74 @@
  * version 2 as published by the Free Software Foundation.
  */
 
+#include <errno.h>
 #include <time.h>
-#include <sys/time.h>
 #include <stdlib.h>
 #include "Arduino.h"
+#include "clock.h"
 
-// For millis()
-static unsigned long millis_at_start = 0;
+#if defined(MY_SIMULATION)
+#include "sim.h"
+
+// Give control back if code polls the clock without ever waiting. The step starts at the
+// 10 ms the main loop sleeps on a real Linux host and doubles while the node keeps spinning.
+#define SIM_SPIN_LIMIT 10
+#define SIM_SPIN_STEP 10000
+static uint64_t spin_time = 0;
+static uint32_t spin_count = 0;
+static uint32_t spin_step = SIM_SPIN_STEP;
+
+static uint64_t sim_now(void)
+{
+	if (simSelf->now != spin_time) {
+		spin_time = simSelf->now;
+		spin_count = 0;
+		spin_step = SIM_SPIN_STEP;
+	} else if (++spin_count > SIM_SPIN_LIMIT) {
+		simSelf->wait(simSelf, simSelf->now + spin_step, 1);
+		spin_time = simSelf->now;
+		spin_count = 0;
+		if (spin_step < simSelf->idle_max) {
+			spin_step *= 2;
+		}
+	}
+	// like on a real node, the clock counts from its own power-up
+	return simSelf->now - simSelf->boot;
+}
 
 void yield(void) {}
 
 unsigned long millis(void)
 {
-	timeval curTime;
+	return (unsigned long)(sim_now() / 1000);
+}
 
-	if (millis_at_start == 0) {
-		gettimeofday(&curTime, NULL);
-		millis_at_start = curTime.tv_sec;
-	}
+unsigned long micros()
+{
+	return (unsigned long)sim_now();
+}
 
-	gettimeofday(&curTime, NULL);
-	return ((curTime.tv_sec - millis_at_start) * 1000) + (curTime.tv_usec / 1000);
+void _delay_milliseconds(unsigned int millis)
+{
+	simSelf->wait(simSelf, simSelf->now + (uint64_t)millis * 1000, 0);
 }
 
-unsigned long micros()
+void _delay_microseconds(unsigned int micro)
 {
-	timeval curTime;
+	simSelf->wait(simSelf, simSelf->now + micro, 0);
+}
+#else
+void yield(void) {}
 
-	if (millis_at_start == 0) {
-		gettimeofday(&curTime, NULL);
-		millis_at_start = curTime.tv_sec;
-	}
+// monotonic, NTP does not move timeouts; wraps like on Arduino where unsigned long is 32 bit
+unsigned long millis(void)
+{
+	return (unsigned long)clockMillis();
+}
 
-	gettimeofday(&curTime, NULL);
-	return ((curTime.tv_sec - millis_at_start) * 1000000) + (curTime.tv_usec);
+unsigned long micros()
+{
+	return (unsigned long)clockMicros();
 }
 
 void _delay_milliseconds(unsigned int millis)
@@ -59,7 +93,9 @@ void _delay_milliseconds(unsigned int millis)
 
 	sleeper.tv_sec  = (time_t)(millis / 1000);
 	sleeper.tv_nsec = (long)(millis % 1000) * 1000000;
-	nanosleep(&sleeper, NULL);
+	// resume when interrupted by a signal, i.e. the stall detector asking for a backtrace
+	while (nanosleep(&sleeper, &sleeper) != 0 && errno == EINTR) {
+	}
 }
 
 void _delay_microseconds(unsigned int micro)
@@ -68,8 +104,10 @@ void _delay_microseconds(unsigned int micro)
 
 	sleeper.tv_sec  = (time_t)(micro / 1000000);
 	sleeper.tv_nsec = (long)(micro % 1000000) * 1000;
-	nanosleep(&sleeper, NULL);
+	while (nanosleep(&sleeper, &sleeper) != 0 && errno == EINTR) {
+	}
 }
+#endif
 
 void randomSeed(unsigned long seed)
 {
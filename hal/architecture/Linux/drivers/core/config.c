@@ -20,6 +20,7 @@
  */
 
 #include "config.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,7 +58,31 @@ int config_parse(const char *config_file)
 	conf.eeprom_size = 0;
 	conf.soft_hmac_key = NULL;
 	conf.soft_serial_key = NULL;
+	conf.signing_whitelist_file = NULL;
 	conf.aes_key = NULL;
+	conf.capture = 0;
+	conf.capture_file = NULL;
+	conf.capture_file_size = 10240;
+	conf.capture_file_count = 5;
+	conf.replay_file = NULL;
+	conf.replay_speed = 1;
+	conf.replay_delay = 0;
+	conf.journal = 0;
+	conf.journal_file = NULL;
+	conf.journal_size = 1024;
+	conf.journal_compact = 1;
+	conf.journal_replay_rate = 50;
+	conf.series = 0;
+	conf.series_file = NULL;
+	conf.series_size = 4096;
+	conf.series_retention = 0;
+	conf.stall_detector = 0;
+	conf.stall_file = NULL;
+	conf.stall_file_size = 1024;
+	conf.stall_threshold = 250;
+	conf.local_time = 0;
+	conf.local_time_offset = INT_MIN;
+	conf.local_config = NULL;
 
 	while (fgets(buf, 1024, fptr)) {
 		if (buf[0] != '#' && buf[0] != 10 && buf[0] != 13) {
@@ -158,11 +183,240 @@ int config_parse(const char *config_file)
 					fclose(fptr);
 					return -1;
 				}
+			} else if (!strncmp(buf, "signing_whitelist_file=", 23)) {
+				if (_config_parse_string(&(buf[23]), "signing_whitelist_file",
+				                         &conf.signing_whitelist_file)) {
+					fclose(fptr);
+					return -1;
+				}
 			} else if (!strncmp(buf, "aes_key=", 8)) {
 				if (_config_parse_string(&(buf[8]), "aes_key", &conf.aes_key)) {
 					fclose(fptr);
 					return -1;
 				}
+			} else if (!strncmp(buf, "capture=", 8)) {
+				if (_config_parse_int(&(buf[8]), "capture", &conf.capture)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.capture != 0 && conf.capture != 1) {
+						logError("capture must be 1 or 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "capture_file=", 13)) {
+				if (_config_parse_string(&(buf[13]), "capture_file", &conf.capture_file)) {
+					fclose(fptr);
+					return -1;
+				}
+			} else if (!strncmp(buf, "capture_file_size=", 18)) {
+				if (_config_parse_int(&(buf[18]), "capture_file_size", &conf.capture_file_size)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.capture_file_size < 0) {
+						logError("capture_file_size value must not be negative in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "capture_file_count=", 19)) {
+				if (_config_parse_int(&(buf[19]), "capture_file_count", &conf.capture_file_count)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.capture_file_count <= 0) {
+						logError("capture_file_count value must be greater than 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "replay_file=", 12)) {
+				if (_config_parse_string(&(buf[12]), "replay_file", &conf.replay_file)) {
+					fclose(fptr);
+					return -1;
+				}
+			} else if (!strncmp(buf, "replay_speed=", 13)) {
+				if (_config_parse_int(&(buf[13]), "replay_speed", &conf.replay_speed)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.replay_speed < 0) {
+						logError("replay_speed value must not be negative in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "replay_delay=", 13)) {
+				if (_config_parse_int(&(buf[13]), "replay_delay", &conf.replay_delay)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.replay_delay < 0) {
+						logError("replay_delay value must not be negative in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "journal=", 8)) {
+				if (_config_parse_int(&(buf[8]), "journal", &conf.journal)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.journal != 0 && conf.journal != 1) {
+						logError("journal must be 1 or 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "journal_file=", 13)) {
+				if (_config_parse_string(&(buf[13]), "journal_file", &conf.journal_file)) {
+					fclose(fptr);
+					return -1;
+				}
+			} else if (!strncmp(buf, "journal_size=", 13)) {
+				if (_config_parse_int(&(buf[13]), "journal_size", &conf.journal_size)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.journal_size <= 0) {
+						logError("journal_size value must be greater than 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "journal_compact=", 16)) {
+				if (_config_parse_int(&(buf[16]), "journal_compact", &conf.journal_compact)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.journal_compact != 0 && conf.journal_compact != 1) {
+						logError("journal_compact must be 1 or 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "journal_replay_rate=", 20)) {
+				if (_config_parse_int(&(buf[20]), "journal_replay_rate", &conf.journal_replay_rate)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.journal_replay_rate < 0) {
+						logError("journal_replay_rate value must not be negative in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "series=", 7)) {
+				if (_config_parse_int(&(buf[7]), "series", &conf.series)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.series != 0 && conf.series != 1) {
+						logError("series must be 1 or 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "series_file=", 12)) {
+				if (_config_parse_string(&(buf[12]), "series_file", &conf.series_file)) {
+					fclose(fptr);
+					return -1;
+				}
+			} else if (!strncmp(buf, "series_size=", 12)) {
+				if (_config_parse_int(&(buf[12]), "series_size", &conf.series_size)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.series_size <= 0) {
+						logError("series_size value must be greater than 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "series_retention=", 17)) {
+				if (_config_parse_int(&(buf[17]), "series_retention", &conf.series_retention)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.series_retention < 0) {
+						logError("series_retention value must not be negative in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "stall_detector=", 15)) {
+				if (_config_parse_int(&(buf[15]), "stall_detector", &conf.stall_detector)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.stall_detector != 0 && conf.stall_detector != 1) {
+						logError("stall_detector must be 1 or 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "stall_file=", 11)) {
+				if (_config_parse_string(&(buf[11]), "stall_file", &conf.stall_file)) {
+					fclose(fptr);
+					return -1;
+				}
+			} else if (!strncmp(buf, "stall_file_size=", 16)) {
+				if (_config_parse_int(&(buf[16]), "stall_file_size", &conf.stall_file_size)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.stall_file_size < 0) {
+						logError("stall_file_size value must not be negative in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "stall_threshold=", 16)) {
+				if (_config_parse_int(&(buf[16]), "stall_threshold", &conf.stall_threshold)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.stall_threshold <= 0) {
+						logError("stall_threshold value must be greater than 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "local_time=", 11)) {
+				if (_config_parse_int(&(buf[11]), "local_time", &conf.local_time)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.local_time != 0 && conf.local_time != 1) {
+						logError("local_time must be 1 or 0 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "local_time_offset=", 18)) {
+				if (_config_parse_int(&(buf[18]), "local_time_offset", &conf.local_time_offset)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (conf.local_time_offset < -720 || conf.local_time_offset > 840) {
+						logError("local_time_offset value must be between -720 and 840 in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
+			} else if (!strncmp(buf, "local_config=", 13)) {
+				if (_config_parse_string(&(buf[13]), "local_config", &conf.local_config)) {
+					fclose(fptr);
+					return -1;
+				} else {
+					if (strcmp(conf.local_config, "M") && strcmp(conf.local_config, "I")) {
+						logError("local_config must be M or I in configuration.\n");
+						fclose(fptr);
+						return -1;
+					}
+				}
 			} else {
 				logWarning("Unknown config option \"%s\".\n", buf);
 			}
@@ -185,6 +439,26 @@ int config_parse(const char *config_file)
 		return -1;
 	}
 
+	if (conf.capture && !conf.capture_file) {
+		logError("capture_file must be set if you enable capture in configuration.\n");
+		return -1;
+	}
+
+	if (conf.journal && !conf.journal_file) {
+		logError("journal_file must be set if you enable journal in configuration.\n");
+		return -1;
+	}
+
+	if (conf.series && !conf.series_file) {
+		logError("series_file must be set if you enable series in configuration.\n");
+		return -1;
+	}
+
+	if (conf.stall_detector && !conf.stall_file) {
+		logError("stall_file must be set if you enable stall_detector in configuration.\n");
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -205,9 +479,30 @@ void config_cleanup(void)
 	if (conf.soft_serial_key) {
 		free(conf.soft_serial_key);
 	}
+	if (conf.signing_whitelist_file) {
+		free(conf.signing_whitelist_file);
+	}
 	if (conf.aes_key) {
 		free(conf.aes_key);
 	}
+	if (conf.capture_file) {
+		free(conf.capture_file);
+	}
+	if (conf.replay_file) {
+		free(conf.replay_file);
+	}
+	if (conf.journal_file) {
+		free(conf.journal_file);
+	}
+	if (conf.series_file) {
+		free(conf.series_file);
+	}
+	if (conf.stall_file) {
+		free(conf.stall_file);
+	}
+	if (conf.local_config) {
+		free(conf.local_config);
+	}
 }
 
 int _config_create(const char *config_file)
@@ -249,6 +544,11 @@ int _config_create(const char *config_file)
 	                            "# To generate a serial key run mysgw with: --gen-soft-serial-key\n" \
 	                            "# copy the new key in the line below and uncomment it.\n" \
 	                            "#soft_serial_key=\n" \
+	                            "# Whitelist of trusted nodes, for a gateway built with\n" \
+	                            "# --my-signing-runtime-whitelist. One \"<node id> <serial>\" per line,\n" \
+	                            "# the serial as printed by --gen-soft-serial-key on the node.\n" \
+	                            "# Reloaded on SIGHUP.\n" \
+	                            "#signing_whitelist_file=/etc/mysensors-whitelist.conf\n" \
 	                            "\n" \
 	                            "# Encryption settings\n" \
 	                            "# Note: The gateway must have been built with encryption\n" \
@@ -256,7 +556,85 @@ int _config_create(const char *config_file)
 	                            "#\n" \
 	                            "# To generate a AES key run mysgw with: --gen-aes-key\n" \
 	                            "# copy the new key in the line below and uncomment it.\n" \
-	                            "#aes_key=\n";
+	                            "#aes_key=\n" \
+	                            "\n" \
+	                            "# Radio frame capture\n" \
+	                            "# Write every frame sent or received by the radio to a pcap file,\n" \
+	                            "# viewable with Wireshark using tools/wireshark/mysensors.lua.\n" \
+	                            "# If capture_file is a named pipe (mkfifo) frames are streamed live:\n" \
+	                            "#   wireshark -X lua_script:mysensors.lua -k -i \"capture_file\"\n" \
+	                            "capture=0\n" \
+	                            "capture_file=/tmp/mysgw.pcap\n" \
+	                            "# Rotate after capture_file_size kB (0 = never), keeping capture_file_count files.\n" \
+	                            "capture_file_size=10240\n" \
+	                            "capture_file_count=5\n" \
+	                            "\n" \
+	                            "# Replay transport settings\n" \
+	                            "# Note: The gateway must have been built with --my-transport=replay\n" \
+	                            "#       to use the options below.\n" \
+	                            "#\n" \
+	                            "# Capture file whose received frames are fed to the gateway.\n" \
+	                            "#replay_file=/tmp/mysgw.pcap\n" \
+	                            "# Time scaling: 1 = original timing, 10 = ten times faster,\n" \
+	                            "# 0 = as fast as possible.\n" \
+	                            "#replay_speed=1\n" \
+	                            "# Delay in ms before the first frame is replayed.\n" \
+	                            "#replay_delay=0\n" \
+	                            "\n" \
+	                            "# Outbound journal\n" \
+	                            "# Keep messages for the controller while no controller is connected\n" \
+	                            "# (or the MQTT broker is down) and replay them in order on reconnect.\n" \
+	                            "# Each replayed message is preceded by a log message\n" \
+	                            "# JRN:TS=<seconds since epoch> when it was received at another time.\n" \
+	                            "journal=0\n" \
+	                            "journal_file=/etc/mysensors.journal\n" \
+	                            "# Journal size in kB, the oldest messages are dropped when full.\n" \
+	                            "journal_size=1024\n" \
+	                            "# Only keep the latest pending value per node, child and type.\n" \
+	                            "journal_compact=1\n" \
+	                            "# Messages replayed per second, 0 = as fast as possible.\n" \
+	                            "journal_replay_rate=50\n" \
+	                            "\n" \
+	                            "# Sensor history\n" \
+	                            "# Keep every numeric reading (C_SET) of the nodes, compressed.\n" \
+	                            "# When series_size kB are used up, the oldest readings are reduced\n" \
+	                            "# to count, min, max and sum of about a hundred readings each.\n" \
+	                            "# Readings older than series_retention days are dropped (0 = never).\n" \
+	                            "# The controller queries it with I_SERIES_QUERY (internal type 35):\n" \
+	                            "#   0;255;3;0;35;<node>,<child>,<type>,<from>,<to>,<aggregate>[<bucket>]\n" \
+	                            "# from and to in seconds before now, or since the epoch with a leading @,\n" \
+	                            "# aggregate R (raw), N (count), A (average), M (min), X (max) or S (sum),\n" \
+	                            "# optionally per bucket seconds. Rows <time>,<value> go to the asking\n" \
+	                            "# controller only, followed by END,<rows>, or by MORE,@<time> if more\n" \
+	                            "# rows follow the last one sent, at <time>: the payload MORE continues\n" \
+	                            "# the query after it.\n" \
+	                            "series=0\n" \
+	                            "series_file=/etc/mysensors.series\n" \
+	                            "series_size=4096\n" \
+	                            "series_retention=0\n" \
+	                            "\n" \
+	                            "# Main loop stall detector\n" \
+	                            "# When one main loop iteration takes longer than stall_threshold ms,\n" \
+	                            "# append the backtrace of the main loop, the queue depths and the\n" \
+	                            "# most recent trace events to stall_file. Trace events are recorded\n" \
+	                            "# if built with --my-trace-recorder or --my-trace-probes. Resolve the\n" \
+	                            "# addresses with\n" \
+	                            "#   addr2line -f -C -e mysgw <offset>\n" \
+	                            "# A systemd watchdog (WatchdogSec=) is served in any case.\n" \
+	                            "stall_detector=0\n" \
+	                            "stall_file=/tmp/mysgw.stall\n" \
+	                            "stall_threshold=250\n" \
+	                            "# Move stall_file to stall_file.1 after stall_file_size kB (0 = never).\n" \
+	                            "stall_file_size=1024\n" \
+	                            "\n" \
+	                            "# Answer time and configuration requests of nodes in the gateway\n" \
+	                            "# instead of forwarding them to the controller.\n" \
+	                            "# Time from the system clock, in the system time zone unless\n" \
+	                            "# local_time_offset (minutes east of UTC) is set.\n" \
+	                            "local_time=0\n" \
+	                            "#local_time_offset=60\n" \
+	                            "# Unit system: M = metric, I = imperial.\n" \
+	                            "#local_config=M\n";
 
 	myFile = fopen(config_file, "w");
 	if (!myFile) {
@@ -35,7 +35,31 @@ struct config {
 	int eeprom_size;
 	char *soft_hmac_key;
 	char *soft_serial_key;
+	char *signing_whitelist_file;
 	char *aes_key;
+	int capture;
+	char *capture_file;
+	int capture_file_size;
+	int capture_file_count;
+	char *replay_file;
+	int replay_speed;
+	int replay_delay;
+	int journal;
+	char *journal_file;
+	int journal_size;
+	int journal_compact;
+	int journal_replay_rate;
+	int series;
+	char *series_file;
+	int series_size;
+	int series_retention;
+	int stall_detector;
+	char *stall_file;
+	int stall_file_size;
+	int stall_threshold;
+	int local_time;
+	int local_time_offset;
+	char *local_config;
 } conf;
 
 int config_parse(const char *config_file);
@@ -126,26 +126,19 @@ void *interruptHandler(void *args)
 	return NULL;
 }
 
-void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
+// Export the pin as input with the edge to wait for and open its value file.
+// Returns 0, -1 if the pin is not available or -2 for an invalid mode.
+static int interruptSetup(uint8_t gpioPin, uint8_t mode)
 {
 	FILE *fd;
 	char fName[40];
 	char c;
 	int count, i;
 
-	if (threadIds[gpioPin] == NULL) {
-		threadIds[gpioPin] = new pthread_t;
-	} else {
-		// Cancel the existing thread for that pin
-		pthread_cancel(*threadIds[gpioPin]);
-		// Wait a bit
-		usleep(1000);
-	}
-
 	// Export pin for interrupt
 	if ((fd = fopen("/sys/class/gpio/export", "w")) == NULL) {
 		logError("attachInterrupt: Unable to export pin %d for interrupt: %s\n", gpioPin, strerror(errno));
-		exit(1);
+		return -1;
 	}
 	fprintf(fd, "%d\n", gpioPin);
 	fclose(fd);
@@ -157,7 +150,7 @@ void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
 	if ((fd = fopen (fName, "w")) == NULL) {
 		logError("attachInterrupt: Unable to open GPIO direction interface for pin %d: %s\n",
 		         gpioPin, strerror(errno));
-		exit(1) ;
+		return -1;
 	}
 	fprintf(fd, "in\n") ;
 	fclose(fd) ;
@@ -166,7 +159,7 @@ void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
 	if ((fd = fopen(fName, "w")) == NULL) {
 		logError("attachInterrupt: Unable to open GPIO edge interface for pin %d: %s\n", gpioPin,
 		         strerror(errno));
-		exit(1) ;
+		return -1;
 	}
 
 	switch (mode) {
@@ -185,7 +178,7 @@ void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
 	default:
 		logError("attachInterrupt: Invalid mode\n");
 		fclose(fd);
-		return;
+		return -2;
 	}
 	fclose(fd);
 
@@ -193,7 +186,7 @@ void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
 		snprintf(fName, sizeof(fName), "/sys/class/gpio/gpio%d/value", gpioPin);
 		if ((sysFds[gpioPin] = open(fName, O_RDWR)) < 0) {
 			logError("Error reading pin %d: %s\n", gpioPin, strerror(errno));
-			exit(1);
+			return -1;
 		}
 	}
 
@@ -204,6 +197,26 @@ void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
 			logError("attachInterrupt: failed to read pin status: %s\n", strerror(errno));
 		}
 	}
+	return 0;
+}
+
+void attachInterrupt(uint8_t gpioPin, void (*func)(), uint8_t mode)
+{
+	if (threadIds[gpioPin] == NULL) {
+		threadIds[gpioPin] = new pthread_t;
+	} else {
+		// Cancel the existing thread for that pin
+		pthread_cancel(*threadIds[gpioPin]);
+		// Wait a bit
+		usleep(1000);
+	}
+
+	const int ret = interruptSetup(gpioPin, mode);
+	if (ret == -2) {
+		return;
+	} else if (ret != 0) {
+		exit(1);
+	}
 
 	struct ThreadArgs *threadArgs = new struct ThreadArgs;
 	threadArgs->func = func;
@@ -237,6 +250,53 @@ void detachInterrupt(uint8_t gpioPin)
 	fclose(fp);
 }
 
+int interruptWakeOpen(uint8_t gpioPin, uint8_t mode)
+{
+	char fName[40];
+	char c;
+	int fd;
+
+	if (gpioPin >= 64) {
+		return -1;
+	}
+	if (threadIds[gpioPin] == NULL) {
+		if (interruptSetup(gpioPin, mode) != 0) {
+			return -1;
+		}
+		fd = sysFds[gpioPin];
+	} else {
+		// attached: keep the edge, and a file of our own, reads of the handler clear events per file
+		snprintf(fName, sizeof(fName), "/sys/class/gpio/gpio%d/value", gpioPin);
+		if ((fd = open(fName, O_RDONLY)) < 0) {
+			logError("Error reading pin %d: %s\n", gpioPin, strerror(errno));
+			return -1;
+		}
+	}
+	// a new file reports an event until read once
+	if (lseek(fd, 0, SEEK_SET) < 0 || read(fd, &c, 1) < 0) {
+		logError("Error reading pin %d: %s\n", gpioPin, strerror(errno));
+	}
+	return fd;
+}
+
+void interruptWakeClose(uint8_t gpioPin, int fd)
+{
+	if (threadIds[gpioPin] != NULL) {
+		close(fd);
+		return;
+	}
+	close(sysFds[gpioPin]);
+	sysFds[gpioPin] = -1;
+
+	FILE *fp = fopen("/sys/class/gpio/unexport", "w");
+	if (fp == NULL) {
+		logError("Unable to unexport pin %d\n", gpioPin);
+		return;
+	}
+	fprintf(fp, "%d", gpioPin);
+	fclose(fp);
+}
+
 void interrupts()
 {
 	pthread_mutex_lock(&intMutex);
@@ -35,6 +35,12 @@ extern "C" {
 
 void attachInterrupt(uint8_t gpioPin, void(*func)(), uint8_t mode);
 void detachInterrupt(uint8_t gpioPin);
+/*
+ * Value file of a pin to poll() for POLLPRI while sleeping, -1 if not available. A pin with
+ * an attached interrupt keeps its mode and handler. Release with interruptWakeClose().
+ */
+int interruptWakeOpen(uint8_t gpioPin, uint8_t mode);
+void interruptWakeClose(uint8_t gpioPin, int fd);
 void interrupts();
 void noInterrupts();
 
@@ -0,0 +1,368 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "journal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "clock.h"
+#include "log.h"
+
+#define JOURNAL_MAGIC 0x4c4e524a	// "JRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_MIN_SLOTS 16
+#define JOURNAL_SUPERSEDED 0x01		// a newer value for the same key follows
+#define JOURNAL_MAX_BURST 32		// records per journalReplayBudget() call
+#define JOURNAL_RETRY_MS 1000		// wait after a failed replay
+
+/*
+ * The journal file is a header followed by a ring of fixed size records, in host byte order.
+ * head and tail are free running sequence numbers, record seq lives in slot seq % slots.
+ * Records are written before head is advanced, the kernel writes the shared mapping back,
+ * so a crash loses at most the record being appended.
+ */
+struct journal_header {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t record_size;
+	uint32_t slots;
+	uint32_t head;					// next record to append
+	uint32_t tail;					// next record to replay
+	uint32_t dropped;				// records lost to overflow
+	uint32_t superseded;			// records removed by compaction
+	uint32_t reserved[9];
+};
+
+struct journal_record {
+	uint32_t timestamp;				// seconds since the epoch
+	uint32_t key;
+	uint8_t flags;
+	uint8_t length;
+	uint8_t reserved[2];
+	uint8_t data[JOURNAL_MAX_DATA];
+};
+
+static int _journal_fd = -1;
+static size_t _journal_map_size = 0;
+static struct journal_header *_journal_header = NULL;
+static struct journal_record *_journal_records = NULL;
+static int _journal_overflow = 0;
+
+// compaction index, key -> sequence of the newest record with that key, linear probing
+static int _journal_compact = 0;
+static uint32_t *_journal_index_key = NULL;
+static uint32_t *_journal_index_seq = NULL;
+static uint32_t _journal_index_mask = 0;
+static unsigned int _journal_index_shift = 0;
+
+// replay rate limit, token bucket
+static int _journal_rate = 0;
+static double _journal_tokens = 0;
+static uint64_t _journal_last_ms = 0;
+static uint64_t _journal_retry_ms = 0;
+
+static struct journal_record *_journal_record(uint32_t seq)
+{
+	return &_journal_records[seq % _journal_header->slots];
+}
+
+static uint32_t _journal_index_find(uint32_t key)
+{
+	uint32_t pos = (key * 2654435761u) >> _journal_index_shift;
+
+	while (_journal_index_key[pos] != JOURNAL_KEY_NONE && _journal_index_key[pos] != key) {
+		pos = (pos + 1) & _journal_index_mask;
+	}
+	return pos;
+}
+
+static void _journal_index_remove(uint32_t pos)
+{
+	// backward shift deletion, keeps probe sequences intact without tombstones
+	uint32_t next = pos;
+
+	while (1) {
+		_journal_index_key[pos] = JOURNAL_KEY_NONE;
+		while (1) {
+			next = (next + 1) & _journal_index_mask;
+			if (_journal_index_key[next] == JOURNAL_KEY_NONE) {
+				return;
+			}
+			const uint32_t home = (_journal_index_key[next] * 2654435761u) >> _journal_index_shift;
+			if (((home - pos - 1) & _journal_index_mask) >= ((next - pos) & _journal_index_mask)) {
+				break;
+			}
+		}
+		_journal_index_key[pos] = _journal_index_key[next];
+		_journal_index_seq[pos] = _journal_index_seq[next];
+		pos = next;
+	}
+}
+
+static void _journal_index_add(uint32_t seq)
+{
+	struct journal_record *record = _journal_record(seq);
+
+	if (!_journal_compact || record->key == JOURNAL_KEY_NONE) {
+		return;
+	}
+	const uint32_t pos = _journal_index_find(record->key);
+	if (_journal_index_key[pos] != JOURNAL_KEY_NONE) {
+		_journal_record(_journal_index_seq[pos])->flags |= JOURNAL_SUPERSEDED;
+		_journal_header->superseded++;
+	}
+	_journal_index_key[pos] = record->key;
+	_journal_index_seq[pos] = seq;
+}
+
+static void _journal_remove_tail(void)
+{
+	struct journal_record *record = _journal_record(_journal_header->tail);
+
+	if (_journal_compact && record->key != JOURNAL_KEY_NONE &&
+	        !(record->flags & JOURNAL_SUPERSEDED)) {
+		const uint32_t pos = _journal_index_find(record->key);
+		if (_journal_index_key[pos] == record->key &&
+		        _journal_index_seq[pos] == _journal_header->tail) {
+			_journal_index_remove(pos);
+		}
+	}
+	_journal_header->tail++;
+}
+
+static void _journal_skip_superseded(void)
+{
+	while (_journal_header->tail != _journal_header->head &&
+	        (_journal_record(_journal_header->tail)->flags & JOURNAL_SUPERSEDED)) {
+		_journal_header->tail++;
+	}
+}
+
+static int _journal_valid(const struct journal_header *header, uint32_t slots)
+{
+	return header->magic == JOURNAL_MAGIC && header->version == JOURNAL_VERSION &&
+	       header->record_size == sizeof(struct journal_record) && header->slots == slots &&
+	       header->head - header->tail <= slots;
+}
+
+int journalOpen(const char *file, int size_kb, int compact, int replay_rate)
+{
+	struct stat fileInfo;
+
+	if (file == NULL || _journal_header != NULL) {
+		return -1;
+	}
+	long slots = ((long)size_kb * 1024 - (long)sizeof(struct journal_header)) /
+	             (long)sizeof(struct journal_record);
+	if (slots < JOURNAL_MIN_SLOTS) {
+		slots = JOURNAL_MIN_SLOTS;
+	}
+	_journal_map_size = sizeof(struct journal_header) + slots * sizeof(struct journal_record);
+
+	_journal_fd = open(file, O_RDWR | O_CREAT, 0644);
+	if (_journal_fd < 0) {
+		logError("Failed to open journal %s: %s\n", file, strerror(errno));
+		return -1;
+	}
+	if (fstat(_journal_fd, &fileInfo) != 0) {
+		logError("Failed to stat journal %s: %s\n", file, strerror(errno));
+		close(_journal_fd);
+		_journal_fd = -1;
+		return -1;
+	}
+	const int resume = ((size_t)fileInfo.st_size == _journal_map_size);
+	if (!resume && (ftruncate(_journal_fd, 0) != 0 ||
+	                ftruncate(_journal_fd, _journal_map_size) != 0)) {
+		logError("Failed to resize journal %s: %s\n", file, strerror(errno));
+		close(_journal_fd);
+		_journal_fd = -1;
+		return -1;
+	}
+	void *map = mmap(NULL, _journal_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, _journal_fd, 0);
+	if (map == MAP_FAILED) {
+		logError("Failed to map journal %s: %s\n", file, strerror(errno));
+		close(_journal_fd);
+		_journal_fd = -1;
+		return -1;
+	}
+	_journal_header = (struct journal_header *)map;
+	_journal_records = (struct journal_record *)(_journal_header + 1);
+
+	if (!resume || !_journal_valid(_journal_header, (uint32_t)slots)) {
+		if (resume) {
+			logWarning("Journal %s is invalid, starting a new one.\n", file);
+		}
+		memset(_journal_header, 0, sizeof(struct journal_header));
+		_journal_header->magic = JOURNAL_MAGIC;
+		_journal_header->version = JOURNAL_VERSION;
+		_journal_header->record_size = sizeof(struct journal_record);
+		_journal_header->slots = (uint32_t)slots;
+	}
+
+	_journal_compact = compact;
+	if (compact) {
+		unsigned int bits = 1;
+		while ((1UL << bits) < 2UL * slots) {
+			bits++;
+		}
+		_journal_index_mask = (1U << bits) - 1;
+		_journal_index_shift = 32 - bits;
+		_journal_index_key = (uint32_t *)calloc(_journal_index_mask + 1, sizeof(uint32_t));
+		_journal_index_seq = (uint32_t *)calloc(_journal_index_mask + 1, sizeof(uint32_t));
+		if (_journal_index_key == NULL || _journal_index_seq == NULL) {
+			logError("Failed to allocate journal index.\n");
+			journalClose();
+			return -1;
+		}
+		for (uint32_t seq = _journal_header->tail; seq != _journal_header->head; seq++) {
+			if (!(_journal_record(seq)->flags & JOURNAL_SUPERSEDED)) {
+				_journal_index_add(seq);
+			}
+		}
+	}
+	_journal_rate = replay_rate;
+	_journal_tokens = 0;
+	_journal_last_ms = clockMillis();
+	_journal_retry_ms = 0;
+	_journal_overflow = 0;
+
+	logInfo("Journal %s, %u messages pending\n", file, journalPending());
+	return 0;
+}
+
+int journalAppend(uint32_t key, const void *data, uint8_t length)
+{
+	if (_journal_header == NULL) {
+		return -1;
+	}
+	if (length > JOURNAL_MAX_DATA) {
+		length = JOURNAL_MAX_DATA;
+	}
+	if (_journal_header->head - _journal_header->tail == _journal_header->slots) {
+		_journal_remove_tail();
+		_journal_header->dropped++;
+		if (!_journal_overflow) {
+			logWarning("Journal full, dropping oldest messages.\n");
+			_journal_overflow = 1;
+		}
+	}
+
+	struct journal_record *record = _journal_record(_journal_header->head);
+	record->timestamp = (uint32_t)time(NULL);
+	record->key = key;
+	record->flags = 0;
+	record->length = length;
+	memcpy(record->data, data, length);
+	_journal_index_add(_journal_header->head);
+	__sync_synchronize();
+	_journal_header->head++;
+	return 0;
+}
+
+unsigned int journalPending(void)
+{
+	if (_journal_header == NULL) {
+		return 0;
+	}
+	_journal_skip_superseded();
+	return _journal_header->head - _journal_header->tail;
+}
+
+int journalPeek(void *data, uint8_t *length, uint32_t *timestamp)
+{
+	if (journalPending() == 0) {
+		return 0;
+	}
+	const struct journal_record *record = _journal_record(_journal_header->tail);
+	memcpy(data, record->data, record->length);
+	*length = record->length;
+	*timestamp = record->timestamp;
+	return 1;
+}
+
+void journalPop(void)
+{
+	if (journalPending() == 0) {
+		return;
+	}
+	_journal_remove_tail();
+	if (_journal_tokens >= 1) {
+		_journal_tokens--;
+	}
+	if (journalPending() == 0) {
+		logInfo("Journal replayed, %u superseded, %u dropped\n", _journal_header->superseded,
+		        _journal_header->dropped);
+		_journal_header->superseded = 0;
+		_journal_header->dropped = 0;
+		_journal_overflow = 0;
+	}
+}
+
+unsigned int journalReplayBudget(void)
+{
+	const uint64_t now = clockMillis();
+
+	if (now < _journal_retry_ms) {
+		return 0;
+	}
+	if (_journal_rate <= 0) {
+		return JOURNAL_MAX_BURST;
+	}
+	// a tenth of a second worth of records at most, at least one
+	double burst = _journal_rate / 10.0;
+	if (burst < 1) {
+		burst = 1;
+	} else if (burst > JOURNAL_MAX_BURST) {
+		burst = JOURNAL_MAX_BURST;
+	}
+	_journal_tokens += (now - _journal_last_ms) * _journal_rate / 1000.0;
+	if (_journal_tokens > burst) {
+		_journal_tokens = burst;
+	}
+	_journal_last_ms = now;
+	return (unsigned int)_journal_tokens;
+}
+
+void journalReplayFailed(void)
+{
+	_journal_retry_ms = clockMillis() + JOURNAL_RETRY_MS;
+}
+
+void journalClose(void)
+{
+	if (_journal_header != NULL) {
+		(void)msync(_journal_header, _journal_map_size, MS_SYNC);
+		(void)munmap(_journal_header, _journal_map_size);
+		_journal_header = NULL;
+		_journal_records = NULL;
+	}
+	if (_journal_fd >= 0) {
+		close(_journal_fd);
+		_journal_fd = -1;
+	}
+	free(_journal_index_key);
+	free(_journal_index_seq);
+	_journal_index_key = NULL;
+	_journal_index_seq = NULL;
+}
@@ -0,0 +1,45 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JOURNAL_MAX_DATA 32			// MAX_MESSAGE_LENGTH
+#define JOURNAL_KEY_NONE 0			// record is never superseded
+
+int journalOpen(const char *file, int size_kb, int compact, int replay_rate);
+int journalAppend(uint32_t key, const void *data, uint8_t length);
+unsigned int journalPending(void);
+int journalPeek(void *data, uint8_t *length, uint32_t *timestamp);
+void journalPop(void);
+unsigned int journalReplayBudget(void);
+void journalReplayFailed(void);
+void journalClose(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -27,6 +27,9 @@
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#if defined(MY_SIMULATION)
+#include "sim.h"
+#endif
 
 static const char *_log_level_colors[] = {
 	"\x1b[1;5;91m", "\x1b[1;91m", "\x1b[91m", "\x1b[31m", "\x1b[33m", "\x1b[34m", "\x1b[32m", "\x1b[36m"
@@ -130,12 +133,19 @@ void vlog(int level, const char *fmt, va_list args)
 	}
 
 	if (!_log_quiet || _log_file_fp != NULL) {
+#if defined(MY_SIMULATION)
+		/* Virtual time, number and node id of the simulated node */
+		char date[32];
+		snprintf(date, sizeof(date), "%10.3f %3u:%-3u", simSelf->now / 1e6, simSelf->index,
+		         simSelf->address);
+#else
 		/* Get current time */
 		time_t t = time(NULL);
 		struct tm *lt = localtime(&t);
 
 		char date[16];
 		date[strftime(date, sizeof(date), "%b %d %H:%M:%S", lt)] = '\0';
+#endif
 
 		if (_log_file_fp != NULL) {
 			fprintf(_log_file_fp, "%s %-5s ", date, _log_level_names[level]);
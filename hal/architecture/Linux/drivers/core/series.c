@@ -0,0 +1,708 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "series.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "log.h"
+
+#define SERIES_MAGIC 0x53524553		// "SERS"
+#define SERIES_VERSION 1
+#define SERIES_CHUNK_SIZE 512
+#define SERIES_CHUNK_DATA (SERIES_CHUNK_SIZE - 64)
+#define SERIES_CHUNK_BITS (SERIES_CHUNK_DATA * 8)
+#define SERIES_SAMPLE_BITS (4 + 32 + 2 + 5 + 6 + 64)	// worst case of one sample
+#define SERIES_MIN_CHUNKS 16
+#define SERIES_MIN_ROLLUPS 16
+#define SERIES_NO_WINDOW 0xff		// no XOR window yet
+
+#define SERIES_FREE 0
+#define SERIES_OPEN 1				// current chunk of its series, in the index
+#define SERIES_SEALED 2
+
+#define SERIES_TIME 0
+#define SERIES_VALUE 1
+
+/*
+ * The file is a header, the chunks and the rollups, in host byte order. Chunks are taken
+ * round robin, a chunk is reduced to a rollup record before it is reused, so the file holds
+ * every sample of the recent past and aggregates of the time before.
+ * Within a chunk the timestamp column grows from the start of data and the value column
+ * from the end, both most significant bit first. Timestamps are coded as in Gorilla:
+ * '0' same delta, '10' +7 bit, '110' +9 bit, '1110' +12 bit delta-of-delta, '1111' +32 bit
+ * delta. Values are XORed with the previous one: '0' same value, '10' +bits inside the
+ * previous window, '11' +5 bit leading zeros +6 bit length +bits.
+ */
+struct series_header {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t chunk_size;
+	uint32_t chunks;
+	uint32_t rollups;
+	uint32_t next_chunk;			// taken by the next new series chunk
+	uint32_t next_rollup;
+	uint32_t reserved[2];
+};
+
+struct series_chunk {
+	uint32_t key;
+	uint32_t first;					// timestamp of the first sample
+	uint32_t last;					// timestamp of the last sample
+	uint32_t delta;					// last - previous timestamp, for the encoder
+	uint16_t count;
+	uint16_t time_bits;
+	uint16_t value_bits;
+	uint8_t leading;				// XOR window of the last value
+	uint8_t trailing;
+	uint8_t state;
+	uint8_t reserved[7];
+	double previous;				// last value, for the encoder
+	double min;
+	double max;
+	double sum;
+	uint8_t data[SERIES_CHUNK_DATA];
+};
+
+struct series_rollup {
+	uint32_t key;
+	uint32_t first;
+	uint32_t last;
+	uint32_t count;
+	double min;
+	double max;
+	double sum;
+};
+
+_Static_assert(sizeof(struct series_chunk) == SERIES_CHUNK_SIZE, "series chunk size");
+
+struct series_cursor {
+	const struct series_chunk *chunk;
+	unsigned int time_bit;
+	unsigned int value_bit;
+	unsigned int index;
+	uint32_t timestamp;
+	uint32_t delta;
+	uint64_t value;
+	unsigned int leading;
+	unsigned int trailing;
+};
+
+struct series_ref {
+	uint32_t first;
+	uint32_t index;
+	int rollup;
+};
+
+struct series_query {
+	char aggregate;
+	uint32_t bucket;
+	uint32_t from;
+	series_row_t row;
+	void *context;
+	int rows;
+	int stopped;
+	uint32_t start;					// current bucket
+	uint32_t count;
+	double min;
+	double max;
+	double sum;
+};
+
+static int _series_fd = -1;
+static size_t _series_map_size = 0;
+static struct series_header *_series_header = NULL;
+static struct series_chunk *_series_chunks = NULL;
+static struct series_rollup *_series_rollups = NULL;
+static uint32_t _series_retention = 0;	// seconds, 0 = no limit
+
+// open chunk of every series, key -> chunk index + 1, linear probing
+static uint32_t *_series_index = NULL;
+static uint32_t _series_index_mask = 0;
+static unsigned int _series_index_shift = 0;
+
+static uint64_t _series_bits(double value)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static double _series_double(uint64_t bits)
+{
+	double value;
+
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void _series_write(struct series_chunk *chunk, int column, uint64_t value,
+                          unsigned int bits)
+{
+	uint16_t *length = (column == SERIES_VALUE) ? &chunk->value_bits : &chunk->time_bits;
+
+	while (bits--) {
+		if ((value >> bits) & 1) {
+			const unsigned int bit = (column == SERIES_VALUE) ? SERIES_CHUNK_BITS - 1 - *length :
+			                         *length;
+			chunk->data[bit >> 3] |= (uint8_t)(0x80 >> (bit & 7));
+		}
+		(*length)++;
+	}
+}
+
+static uint64_t _series_read(struct series_cursor *cursor, int column, unsigned int bits)
+{
+	unsigned int *position = (column == SERIES_VALUE) ? &cursor->value_bit : &cursor->time_bit;
+	uint64_t value = 0;
+
+	while (bits--) {
+		const unsigned int bit = (column == SERIES_VALUE) ? SERIES_CHUNK_BITS - 1 - *position :
+		                         *position;
+		value = (value << 1) | ((cursor->chunk->data[bit >> 3] >> (7 - (bit & 7))) & 1);
+		(*position)++;
+	}
+	return value;
+}
+
+static void _series_encode_time(struct series_chunk *chunk, uint32_t timestamp)
+{
+	const uint32_t delta = timestamp - chunk->last;
+	const int64_t dod = (int64_t)delta - (int64_t)chunk->delta;
+
+	if (dod == 0) {
+		_series_write(chunk, SERIES_TIME, 0x0, 1);
+	} else if (dod >= -63 && dod <= 64) {
+		_series_write(chunk, SERIES_TIME, 0x2, 2);
+		_series_write(chunk, SERIES_TIME, (uint64_t)(dod + 63), 7);
+	} else if (dod >= -255 && dod <= 256) {
+		_series_write(chunk, SERIES_TIME, 0x6, 3);
+		_series_write(chunk, SERIES_TIME, (uint64_t)(dod + 255), 9);
+	} else if (dod >= -2047 && dod <= 2048) {
+		_series_write(chunk, SERIES_TIME, 0xe, 4);
+		_series_write(chunk, SERIES_TIME, (uint64_t)(dod + 2047), 12);
+	} else {
+		// the delta itself, a delta-of-delta may not fit 32 bit
+		_series_write(chunk, SERIES_TIME, 0xf, 4);
+		_series_write(chunk, SERIES_TIME, delta, 32);
+	}
+	chunk->delta = delta;
+	chunk->last = timestamp;
+}
+
+static void _series_encode_value(struct series_chunk *chunk, double value)
+{
+	const uint64_t x = _series_bits(value) ^ _series_bits(chunk->previous);
+
+	if (x == 0) {
+		_series_write(chunk, SERIES_VALUE, 0x0, 1);
+	} else {
+		unsigned int leading = (unsigned int)__builtin_clzll(x);
+		const unsigned int trailing = (unsigned int)__builtin_ctzll(x);
+		if (leading > 31) {
+			leading = 31;
+		}
+		if (chunk->leading != SERIES_NO_WINDOW && leading >= chunk->leading &&
+		        trailing >= chunk->trailing) {
+			_series_write(chunk, SERIES_VALUE, 0x2, 2);
+			_series_write(chunk, SERIES_VALUE, x >> chunk->trailing,
+			              64 - chunk->leading - chunk->trailing);
+		} else {
+			const unsigned int significant = 64 - leading - trailing;
+			_series_write(chunk, SERIES_VALUE, 0x3, 2);
+			_series_write(chunk, SERIES_VALUE, leading, 5);
+			_series_write(chunk, SERIES_VALUE, significant & 63, 6);	// 64 is stored as 0
+			_series_write(chunk, SERIES_VALUE, x >> trailing, significant);
+			chunk->leading = (uint8_t)leading;
+			chunk->trailing = (uint8_t)trailing;
+		}
+	}
+	chunk->previous = value;
+}
+
+// Decodes the next sample of a chunk, returns 0 after the last one
+static int _series_next(struct series_cursor *cursor, uint32_t *timestamp, double *value)
+{
+	if (cursor->index == cursor->chunk->count) {
+		return 0;
+	}
+	if (cursor->index == 0) {
+		cursor->timestamp = cursor->chunk->first;
+		cursor->delta = 0;
+		cursor->value = _series_read(cursor, SERIES_VALUE, 64);
+	} else {
+		int64_t dod = 0;
+		if (!_series_read(cursor, SERIES_TIME, 1)) {
+			dod = 0;
+		} else if (!_series_read(cursor, SERIES_TIME, 1)) {
+			dod = (int64_t)_series_read(cursor, SERIES_TIME, 7) - 63;
+		} else if (!_series_read(cursor, SERIES_TIME, 1)) {
+			dod = (int64_t)_series_read(cursor, SERIES_TIME, 9) - 255;
+		} else if (!_series_read(cursor, SERIES_TIME, 1)) {
+			dod = (int64_t)_series_read(cursor, SERIES_TIME, 12) - 2047;
+		} else {
+			dod = (int64_t)_series_read(cursor, SERIES_TIME, 32) - (int64_t)cursor->delta;
+		}
+		cursor->delta = (uint32_t)((int64_t)cursor->delta + dod);
+		cursor->timestamp += cursor->delta;
+
+		if (_series_read(cursor, SERIES_VALUE, 1)) {
+			if (_series_read(cursor, SERIES_VALUE, 1)) {
+				unsigned int significant;
+				cursor->leading = (unsigned int)_series_read(cursor, SERIES_VALUE, 5);
+				significant = (unsigned int)_series_read(cursor, SERIES_VALUE, 6);
+				if (significant == 0) {
+					significant = 64;
+				}
+				cursor->trailing = 64 - cursor->leading - significant;
+			}
+			cursor->value ^= _series_read(cursor, SERIES_VALUE,
+			                              64 - cursor->leading - cursor->trailing) << cursor->trailing;
+		}
+	}
+	cursor->index++;
+	*timestamp = cursor->timestamp;
+	*value = _series_double(cursor->value);
+	return 1;
+}
+
+static uint32_t _series_hash(uint32_t key)
+{
+	return (key * 2654435761u) >> _series_index_shift;
+}
+
+static struct series_chunk *_series_index_find(uint32_t key, uint32_t *position)
+{
+	uint32_t i = _series_hash(key);
+
+	while (_series_index[i]) {
+		struct series_chunk *chunk = &_series_chunks[_series_index[i] - 1];
+		if (chunk->key == key) {
+			*position = i;
+			return chunk;
+		}
+		i = (i + 1) & _series_index_mask;
+	}
+	return NULL;
+}
+
+static void _series_index_add(uint32_t index)
+{
+	uint32_t i = _series_hash(_series_chunks[index].key);
+
+	while (_series_index[i]) {
+		i = (i + 1) & _series_index_mask;
+	}
+	_series_index[i] = index + 1;
+}
+
+// backward shift deletion, keeps every probe sequence intact without tombstones
+static void _series_index_remove(uint32_t position)
+{
+	uint32_t i = position;
+	uint32_t j = position;
+
+	_series_index[i] = 0;
+	for (;;) {
+		j = (j + 1) & _series_index_mask;
+		if (!_series_index[j]) {
+			return;
+		}
+		const uint32_t home = _series_hash(_series_chunks[_series_index[j] - 1].key);
+		if ((j > i && (home <= i || home > j)) || (j < i && home <= i && home > j)) {
+			_series_index[i] = _series_index[j];
+			_series_index[j] = 0;
+			i = j;
+		}
+	}
+}
+
+static int _series_expired(uint32_t timestamp, uint32_t now)
+{
+	return _series_retention && (uint64_t)timestamp + _series_retention < now;
+}
+
+// Makes room in a chunk, keeping its aggregate unless it is past retention
+static void _series_reduce(struct series_chunk *chunk, uint32_t now)
+{
+	uint32_t position;
+
+	if (chunk->state == SERIES_OPEN && _series_index_find(chunk->key, &position) == chunk) {
+		_series_index_remove(position);
+	}
+	if (chunk->state != SERIES_FREE && chunk->count && !_series_expired(chunk->last, now)) {
+		struct series_rollup *rollup = &_series_rollups[_series_header->next_rollup];
+		rollup->key = chunk->key;
+		rollup->first = chunk->first;
+		rollup->last = chunk->last;
+		rollup->count = chunk->count;
+		rollup->min = chunk->min;
+		rollup->max = chunk->max;
+		rollup->sum = chunk->sum;
+		_series_header->next_rollup = (_series_header->next_rollup + 1) % _series_header->rollups;
+	}
+	memset(chunk, 0, sizeof(struct series_chunk));
+}
+
+static int _series_valid(const struct series_header *header, uint32_t chunks, uint32_t rollups)
+{
+	return header->magic == SERIES_MAGIC && header->version == SERIES_VERSION &&
+	       header->chunk_size == SERIES_CHUNK_SIZE && header->chunks == chunks &&
+	       header->rollups == rollups && header->next_chunk < chunks &&
+	       header->next_rollup < rollups;
+}
+
+int seriesOpen(const char *file, int size_kb, int retention_days)
+{
+	struct stat fileInfo;
+	unsigned int series = 0;
+
+	if (file == NULL || _series_header != NULL) {
+		return -1;
+	}
+	// an eighth of the file for the rollups
+	const long space = (long)size_kb * 1024 - (long)sizeof(struct series_header);
+	long rollups = space / 8 / (long)sizeof(struct series_rollup);
+	if (rollups < SERIES_MIN_ROLLUPS) {
+		rollups = SERIES_MIN_ROLLUPS;
+	}
+	long chunks = (space - rollups * (long)sizeof(struct series_rollup)) /
+	              (long)sizeof(struct series_chunk);
+	if (chunks < SERIES_MIN_CHUNKS) {
+		chunks = SERIES_MIN_CHUNKS;
+	}
+	_series_map_size = sizeof(struct series_header) + chunks * sizeof(struct series_chunk) +
+	                   rollups * sizeof(struct series_rollup);
+
+	_series_fd = open(file, O_RDWR | O_CREAT, 0644);
+	if (_series_fd < 0) {
+		logError("Failed to open series store %s: %s\n", file, strerror(errno));
+		return -1;
+	}
+	if (fstat(_series_fd, &fileInfo) != 0) {
+		logError("Failed to stat series store %s: %s\n", file, strerror(errno));
+		close(_series_fd);
+		_series_fd = -1;
+		return -1;
+	}
+	const int resume = ((size_t)fileInfo.st_size == _series_map_size);
+	if (!resume && (ftruncate(_series_fd, 0) != 0 ||
+	                ftruncate(_series_fd, _series_map_size) != 0)) {
+		logError("Failed to resize series store %s: %s\n", file, strerror(errno));
+		close(_series_fd);
+		_series_fd = -1;
+		return -1;
+	}
+	void *map = mmap(NULL, _series_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, _series_fd, 0);
+	if (map == MAP_FAILED) {
+		logError("Failed to map series store %s: %s\n", file, strerror(errno));
+		close(_series_fd);
+		_series_fd = -1;
+		return -1;
+	}
+	_series_header = (struct series_header *)map;
+	_series_chunks = (struct series_chunk *)(_series_header + 1);
+	_series_rollups = (struct series_rollup *)(_series_chunks + chunks);
+
+	if (!resume || !_series_valid(_series_header, (uint32_t)chunks, (uint32_t)rollups)) {
+		if (resume) {
+			logWarning("Series store %s is invalid, starting a new one.\n", file);
+		}
+		memset(map, 0, _series_map_size);
+		_series_header->magic = SERIES_MAGIC;
+		_series_header->version = SERIES_VERSION;
+		_series_header->chunk_size = SERIES_CHUNK_SIZE;
+		_series_header->chunks = (uint32_t)chunks;
+		_series_header->rollups = (uint32_t)rollups;
+	}
+
+	unsigned int bits = 1;
+	while ((1UL << bits) < 2UL * chunks) {
+		bits++;
+	}
+	_series_index_mask = (1U << bits) - 1;
+	_series_index_shift = 32 - bits;
+	_series_index = (uint32_t *)calloc(_series_index_mask + 1, sizeof(uint32_t));
+	if (_series_index == NULL) {
+		logError("Failed to allocate series index.\n");
+		seriesClose();
+		return -1;
+	}
+	for (uint32_t index = 0; index < (uint32_t)chunks; index++) {
+		struct series_chunk *chunk = &_series_chunks[index];
+		uint32_t position;
+		if (chunk->state != SERIES_OPEN) {
+			continue;
+		}
+		if (_series_index_find(chunk->key, &position) != NULL) {
+			chunk->state = SERIES_SEALED;
+			continue;
+		}
+		_series_index_add(index);
+		series++;
+	}
+	_series_retention = (uint32_t)retention_days * 86400u;
+
+	logInfo("Series store %s, %u series\n", file, series);
+	return 0;
+}
+
+int seriesAppend(uint32_t key, uint32_t timestamp, double value)
+{
+	struct series_chunk *chunk;
+	uint32_t position;
+
+	if (_series_header == NULL || !isfinite(value)) {
+		return -1;
+	}
+	chunk = _series_index_find(key, &position);
+	if (chunk != NULL) {
+		if (timestamp < chunk->last) {
+			// wall clock was set back, keep the series in order
+			timestamp = chunk->last;
+		}
+		if (chunk->count == UINT16_MAX ||
+		        chunk->time_bits + chunk->value_bits + SERIES_SAMPLE_BITS > SERIES_CHUNK_BITS) {
+			chunk->state = SERIES_SEALED;
+			_series_index_remove(position);
+			chunk = NULL;
+		}
+	}
+	if (chunk == NULL) {
+		const uint32_t index = _series_header->next_chunk;
+		chunk = &_series_chunks[index];
+		_series_reduce(chunk, timestamp);
+		_series_header->next_chunk = (index + 1) % _series_header->chunks;
+		chunk->key = key;
+		chunk->first = timestamp;
+		chunk->last = timestamp;
+		chunk->leading = SERIES_NO_WINDOW;
+		_series_write(chunk, SERIES_VALUE, _series_bits(value), 64);
+		chunk->previous = value;
+		chunk->count = 1;
+		chunk->min = value;
+		chunk->max = value;
+		chunk->sum = value;
+		chunk->state = SERIES_OPEN;
+		_series_index_add(index);
+		return 0;
+	}
+	_series_encode_time(chunk, timestamp);
+	_series_encode_value(chunk, value);
+	chunk->count++;
+	if (value < chunk->min) {
+		chunk->min = value;
+	}
+	if (value > chunk->max) {
+		chunk->max = value;
+	}
+	chunk->sum += value;
+	return 0;
+}
+
+static int _series_ref_compare(const void *a, const void *b)
+{
+	const struct series_ref *left = (const struct series_ref *)a;
+	const struct series_ref *right = (const struct series_ref *)b;
+
+	return (left->first > right->first) - (left->first < right->first);
+}
+
+static void _series_emit(struct series_query *query)
+{
+	double value;
+
+	if (query->count == 0) {
+		return;
+	}
+	switch (query->aggregate) {
+	case SERIES_COUNT:
+		value = query->count;
+		break;
+	case SERIES_AVERAGE:
+		value = query->sum / query->count;
+		break;
+	case SERIES_MIN:
+		value = query->min;
+		break;
+	case SERIES_MAX:
+		value = query->max;
+		break;
+	default:
+		value = query->sum;
+		break;
+	}
+	query->count = 0;
+	if (query->row(query->start, value, query->context)) {
+		query->stopped = 1;
+	} else {
+		query->rows++;
+	}
+}
+
+static void _series_aggregate(struct series_query *query, uint32_t timestamp, uint32_t count,
+                              double min, double max, double sum)
+{
+	const uint32_t start = query->bucket ? timestamp - timestamp % query->bucket : query->from;
+
+	if (query->count && start != query->start) {
+		_series_emit(query);
+		if (query->stopped) {
+			return;
+		}
+	}
+	if (query->count == 0) {
+		query->start = start;
+		query->min = min;
+		query->max = max;
+		query->sum = 0;
+	}
+	if (min < query->min) {
+		query->min = min;
+	}
+	if (max > query->max) {
+		query->max = max;
+	}
+	query->count += count;
+	query->sum += sum;
+}
+
+static void _series_query_chunk(struct series_query *query, const struct series_chunk *chunk,
+                                uint32_t to)
+{
+	struct series_cursor cursor;
+	uint32_t timestamp;
+	double value;
+
+	if (query->aggregate != SERIES_RAW && chunk->first >= query->from && chunk->last <= to &&
+	        (query->bucket == 0 || chunk->first / query->bucket == chunk->last / query->bucket)) {
+		// whole chunk in one bucket, no need to decode it
+		_series_aggregate(query, chunk->first, chunk->count, chunk->min, chunk->max, chunk->sum);
+		return;
+	}
+	memset(&cursor, 0, sizeof(cursor));
+	cursor.chunk = chunk;
+	while (!query->stopped && _series_next(&cursor, &timestamp, &value)) {
+		if (timestamp < query->from) {
+			continue;
+		}
+		if (timestamp > to) {
+			break;
+		}
+		if (query->aggregate == SERIES_RAW) {
+			if (query->row(timestamp, value, query->context)) {
+				query->stopped = 1;
+			} else {
+				query->rows++;
+			}
+		} else {
+			_series_aggregate(query, timestamp, 1, value, value, value);
+		}
+	}
+}
+
+int seriesQuery(uint32_t key, uint32_t from, uint32_t to, char aggregate, uint32_t bucket,
+                series_row_t row, void *context)
+{
+	struct series_query query;
+	struct series_ref *refs;
+	uint32_t count = 0;
+	const uint32_t now = (uint32_t)time(NULL);
+
+	if (_series_header == NULL || aggregate == '\0' || strchr("RNAMXS", aggregate) == NULL) {
+		return -1;
+	}
+	if (_series_retention && now > _series_retention && from < now - _series_retention) {
+		from = now - _series_retention;
+	}
+	if (from > to) {
+		return 0;
+	}
+	refs = (struct series_ref *)malloc((_series_header->chunks + _series_header->rollups) *
+	                                   sizeof(struct series_ref));
+	if (refs == NULL) {
+		return -1;
+	}
+	for (uint32_t index = 0; index < _series_header->chunks; index++) {
+		const struct series_chunk *chunk = &_series_chunks[index];
+		if (chunk->state != SERIES_FREE && chunk->key == key && chunk->last >= from &&
+		        chunk->first <= to) {
+			refs[count].first = chunk->first;
+			refs[count].index = index;
+			refs[count].rollup = 0;
+			count++;
+		}
+	}
+	for (uint32_t index = 0; aggregate != SERIES_RAW && index < _series_header->rollups; index++) {
+		const struct series_rollup *rollup = &_series_rollups[index];
+		// the samples of a rollup cannot be split, one straddling from or to is left out
+		if (rollup->count && rollup->key == key && rollup->first >= from && rollup->last <= to) {
+			refs[count].first = rollup->first;
+			refs[count].index = index;
+			refs[count].rollup = 1;
+			count++;
+		}
+	}
+	// chunks and rollups of one series never overlap in time
+	qsort(refs, count, sizeof(struct series_ref), _series_ref_compare);
+
+	memset(&query, 0, sizeof(query));
+	query.aggregate = aggregate;
+	query.bucket = bucket;
+	query.from = from;
+	query.row = row;
+	query.context = context;
+	for (uint32_t i = 0; i < count && !query.stopped; i++) {
+		if (refs[i].rollup) {
+			const struct series_rollup *rollup = &_series_rollups[refs[i].index];
+			_series_aggregate(&query, rollup->first, rollup->count, rollup->min, rollup->max,
+			                  rollup->sum);
+		} else {
+			_series_query_chunk(&query, &_series_chunks[refs[i].index], to);
+		}
+	}
+	if (!query.stopped) {
+		_series_emit(&query);
+	}
+	free(refs);
+	return query.rows;
+}
+
+void seriesClose(void)
+{
+	if (_series_header != NULL) {
+		munmap(_series_header, _series_map_size);
+		_series_header = NULL;
+		_series_chunks = NULL;
+		_series_rollups = NULL;
+	}
+	if (_series_fd >= 0) {
+		close(_series_fd);
+		_series_fd = -1;
+	}
+	free(_series_index);
+	_series_index = NULL;
+}
@@ -0,0 +1,67 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef SERIES_H
+#define SERIES_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERIES_KEY(node, sensor, type) \
+	(((uint32_t)(node) << 16) | ((uint32_t)(sensor) << 8) | (uint32_t)(type))
+
+// aggregates for seriesQuery()
+#define SERIES_RAW 'R'				// every sample
+#define SERIES_COUNT 'N'
+#define SERIES_AVERAGE 'A'
+#define SERIES_MIN 'M'
+#define SERIES_MAX 'X'
+#define SERIES_SUM 'S'
+
+// Called for every row of a query, returns non-zero to refuse the row and stop the query
+typedef int (*series_row_t)(uint32_t timestamp, double value, void *context);
+
+/*
+ * Opens the store, a file of size_kb mapped into memory. Samples are kept compressed in
+ * chunks of one series each: timestamps as delta-of-delta, values XORed with the previous
+ * one. When the file is full the oldest chunk is reduced to count, min, max and sum.
+ * Samples older than retention_days (0 = no limit) are dropped.
+ */
+int seriesOpen(const char *file, int size_kb, int retention_days);
+// Appends a sample, timestamp in seconds since the epoch
+int seriesAppend(uint32_t key, uint32_t timestamp, double value);
+/*
+ * Reports the samples of a series between from and to (inclusive), or their aggregate per
+ * bucket seconds (0 = one row for the whole range), in time order. Ranges that were reduced
+ * only contribute to aggregates, each with the time of its first sample, and only if they lie
+ * within from and to entirely.
+ * Returns the number of rows reported, -1 if the store is not open or aggregate is unknown.
+ */
+int seriesQuery(uint32_t key, uint32_t from, uint32_t to, char aggregate, uint32_t bucket,
+                series_row_t row, void *context);
+void seriesClose(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Interface between a simulated node and the simulator (tools/sim).
+ *
+ * Every node is a separately loaded copy of the library built with MY_SIMULATION. The
+ * simulator owns the virtual clock and the radio medium, a node gives control back by
+ * calling wait() and only runs again once the simulator advanced its clock.
+ */
+typedef struct simNode {
+	uint64_t now;					//!< virtual time in us, advanced by the simulator
+	uint64_t boot;					//!< virtual time the node was powered up, millis() counts from there
+	uint32_t index;					//!< number of this node in the simulation, 0 is the gateway
+	uint32_t seed;					//!< random seed of this node
+	const char *eeprom_file;		//!< EEPROM file of this node
+	uint32_t report_interval;		//!< ms between sensor reports
+	int send_async;					//!< queue reports with sendAsync() and request an ack
+	uint32_t idle_min;				//!< us, first idle step when nothing happens
+	uint32_t idle_max;				//!< us, idle steps double up to this value
+	int verbose;					//!< log to stderr
+	void *host;						//!< simulator private data
+
+	/** @brief Yield to the simulator until @p until (us), or earlier if a frame arrives and @p wake_on_frame */
+	void (*wait)(struct simNode *node, uint64_t until, int wake_on_frame);
+	/** @brief Transmit a frame, returns 1 if acknowledged (unicast) */
+	int (*send)(struct simNode *node, uint16_t to, const void *data, uint8_t len, int no_ack);
+	/** @brief Fetch a received frame, returns its length or 0 */
+	uint8_t (*receive)(struct simNode *node, void *data, int16_t *rssi);
+	/** @brief Gateway output towards the controller */
+	void (*controller_write)(struct simNode *node, uint8_t c);
+	/** @brief Controller input to the gateway, returns -1 if none */
+	int (*controller_read)(struct simNode *node);
+
+	// maintained by the node
+	uint16_t address;				//!< current node id
+	uint8_t ready;					//!< transport is ready
+	uint32_t reports;				//!< sensor reports sent by the application
+	uint32_t async_acked;			//!< queued reports acknowledged by the gateway
+	uint32_t async_no_ack;			//!< queued reports sent, but not acknowledged in time
+	uint32_t async_failed;			//!< queued reports not sent
+} simNode_t;
+
+/**
+ * @brief Node entry point, never returns.
+ */
+typedef void (*simNodeMain_t)(simNode_t *node);
+
+extern simNode_t *simSelf;			//!< the node running in this copy of the library
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,400 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "stall.h"
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "clock.h"
+#include "log.h"
+
+#define STALL_EVENTS 256			// power of 2
+#define STALL_FRAMES 64
+#define STALL_GAUGES 8
+#define STALL_SIGNAL SIGUSR2		// asks the main thread for its backtrace
+#define STALL_BACKTRACE_WAIT_MS 100	// main thread blocked in the kernel does not answer
+
+struct stall_event {
+	uint32_t seq;					// index + 1 when complete, 0 while written
+	uint64_t ts_ns;
+	const char *name;
+	int32_t value;
+	char kind;
+	uint8_t a;
+	uint8_t b;
+	uint8_t c;
+	uint8_t d;
+};
+
+struct stall_gauge {
+	const char *name;
+	stall_gauge_t depth;
+};
+
+static struct stall_event _stall_events[STALL_EVENTS];
+static uint32_t _stall_event_head = 0;		// next event to fill
+static struct stall_gauge _stall_gauges[STALL_GAUGES];
+static int _stall_gauge_count = 0;
+
+static volatile int _stall_running = 0;
+static pthread_t _stall_thread;
+static pthread_t _stall_main;
+static pthread_mutex_t _stall_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _stall_cond;
+static uint32_t _stall_beat = 0;			// ms, start of the current iteration
+static uint32_t _stall_iteration = 0;
+static int _stall_idle = 0;					// main thread sleeps on purpose
+
+static char *_stall_file = NULL;
+static uint32_t _stall_threshold = 0;		// ms
+static long _stall_max_size = 0;
+
+static void *_stall_frames[STALL_FRAMES];
+static volatile sig_atomic_t _stall_depth = 0;
+
+static int _stall_notify_fd = -1;
+static struct sockaddr_un _stall_notify_addr;
+static socklen_t _stall_notify_len = 0;
+static uint32_t _stall_watchdog = 0;		// ms, 0 if systemd does not watch us
+
+// sd_notify(3) without linking libsystemd
+static void _stall_notify_init(void)
+{
+	const char *path = getenv("NOTIFY_SOCKET");
+	const char *usec = getenv("WATCHDOG_USEC");
+	const char *pid = getenv("WATCHDOG_PID");
+
+	if (path == NULL || (path[0] != '/' && path[0] != '@') ||
+	        strlen(path) >= sizeof(_stall_notify_addr.sun_path)) {
+		return;
+	}
+	memset(&_stall_notify_addr, 0, sizeof(_stall_notify_addr));
+	_stall_notify_addr.sun_family = AF_UNIX;
+	memcpy(_stall_notify_addr.sun_path, path, strlen(path));
+	if (path[0] == '@') {
+		// abstract namespace
+		_stall_notify_addr.sun_path[0] = '\0';
+	}
+	_stall_notify_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + strlen(path));
+	_stall_notify_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (_stall_notify_fd < 0) {
+		logError("Failed to open systemd notification socket: %s\n", strerror(errno));
+		return;
+	}
+	if (usec != NULL && (pid == NULL || (pid_t)atol(pid) == getpid())) {
+		_stall_watchdog = (uint32_t)(strtoull(usec, NULL, 10) / 1000);
+	}
+}
+
+static void _stall_notify(const char *state)
+{
+	if (_stall_notify_fd < 0) {
+		return;
+	}
+	(void)sendto(_stall_notify_fd, state, strlen(state), MSG_NOSIGNAL,
+	             (const struct sockaddr *)&_stall_notify_addr, _stall_notify_len);
+}
+
+static void _stall_signal(int sig)
+{
+	const int saved = errno;
+
+	(void)sig;
+	_stall_depth = backtrace(_stall_frames, STALL_FRAMES);
+	errno = saved;
+}
+
+static int _stall_backtrace(void)
+{
+	_stall_depth = 0;
+	if (pthread_kill(_stall_main, STALL_SIGNAL) != 0) {
+		return 0;
+	}
+	for (int i = 0; i < STALL_BACKTRACE_WAIT_MS && _stall_depth == 0; i++) {
+		usleep(1000);
+	}
+	return _stall_depth;
+}
+
+static FILE *_stall_open_file(void)
+{
+	char rotated[PATH_MAX];
+	struct stat fileInfo;
+
+	if (_stall_max_size && stat(_stall_file, &fileInfo) == 0 && fileInfo.st_size >= _stall_max_size) {
+		snprintf(rotated, sizeof(rotated), "%s.1", _stall_file);
+		(void)rename(_stall_file, rotated);
+	}
+	return fopen(_stall_file, "a");
+}
+
+static void _stall_dump(uint32_t iteration, uint32_t age)
+{
+	const int depth = _stall_backtrace();
+	const uint64_t now_ns = clockNanos();
+	struct timespec wall;
+	struct tm tm;
+	char stamp[32];
+
+	FILE *fp = _stall_open_file();
+	if (fp == NULL) {
+		logError("Failed to open stall file %s: %s\n", _stall_file, strerror(errno));
+		return;
+	}
+	clock_gettime(CLOCK_REALTIME, &wall);
+	strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime_r(&wall.tv_sec, &tm));
+	fprintf(fp, "=== %s.%03ld main loop iteration %u running for %u ms\n", stamp,
+	        wall.tv_nsec / 1000000, iteration, age);
+
+	if (depth > 0) {
+		fprintf(fp, "backtrace:\n");
+		fflush(fp);
+		backtrace_symbols_fd(_stall_frames, depth, fileno(fp));
+	} else {
+		fprintf(fp, "backtrace: not available, main thread blocked in the kernel\n");
+	}
+
+	if (_stall_gauge_count) {
+		fprintf(fp, "queues:");
+		for (int i = 0; i < _stall_gauge_count; i++) {
+			fprintf(fp, " %s=%u", _stall_gauges[i].name, _stall_gauges[i].depth());
+		}
+		fprintf(fp, "\n");
+	}
+
+	// oldest first, slots overwritten while reading are skipped
+	fprintf(fp, "events, ms before now:\n");
+	const uint32_t head = __atomic_load_n(&_stall_event_head, __ATOMIC_ACQUIRE);
+	for (uint32_t index = head < STALL_EVENTS ? 0 : head - STALL_EVENTS; index != head; index++) {
+		const struct stall_event *slot = &_stall_events[index & (STALL_EVENTS - 1)];
+		const uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		struct stall_event event = *slot;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (seq != index + 1 || __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+			continue;
+		}
+		const double before = -(double)(now_ns - event.ts_ns) / 1000000.0;
+		if (event.kind == STALL_EVENT_MSG) {
+			fprintf(fp, "  %10.3f %-20s sender=%u destination=%u command=%u type=%u value=%d\n",
+			        before, event.name, event.a, event.b, event.c, event.d, event.value);
+		} else {
+			fprintf(fp, "  %10.3f %-20s recipient=%u length=%u value=%d\n", before, event.name,
+			        event.a, event.b, event.value);
+		}
+	}
+	fclose(fp);
+	logWarning("Main loop stuck for %u ms, state written to %s\n", age, _stall_file);
+}
+
+static void *_stall_watch(void *arg)
+{
+	uint32_t period = _stall_file ? _stall_threshold / 4 : UINT32_MAX;
+	uint32_t dumped = UINT32_MAX;
+	uint32_t pinged = 0;
+
+	(void)arg;
+	if (_stall_watchdog && _stall_watchdog / 4 < period) {
+		period = _stall_watchdog / 4;
+	}
+	if (period < 10) {
+		period = 10;
+	}
+	pthread_mutex_lock(&_stall_mutex);
+	while (_stall_running) {
+		struct timespec deadline;
+
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += period / 1000;
+		deadline.tv_nsec += (long)(period % 1000) * 1000000;
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+		(void)pthread_cond_timedwait(&_stall_cond, &_stall_mutex, &deadline);
+		if (!_stall_running) {
+			break;
+		}
+		pthread_mutex_unlock(&_stall_mutex);
+
+		const uint32_t iteration = __atomic_load_n(&_stall_iteration, __ATOMIC_ACQUIRE);
+		// beat first, it is never ahead of the precise clock read after it
+		const uint32_t beat = __atomic_load_n(&_stall_beat, __ATOMIC_ACQUIRE);
+		const uint32_t now = (uint32_t)clockMillis();
+		const uint32_t age = __atomic_load_n(&_stall_idle, __ATOMIC_ACQUIRE) ? 0 : now - beat;
+		if (_stall_file && age >= _stall_threshold && iteration != dumped) {
+			_stall_dump(iteration, age);
+			dumped = iteration;
+		}
+		// a loop stuck for half the watchdog interval stops the pings, systemd restarts us
+		if (_stall_watchdog && age < _stall_watchdog / 2 && now - pinged >= _stall_watchdog / 2) {
+			_stall_notify("WATCHDOG=1");
+			pinged = now;
+		}
+
+		pthread_mutex_lock(&_stall_mutex);
+	}
+	pthread_mutex_unlock(&_stall_mutex);
+	return NULL;
+}
+
+int stallOpen(const char *file, int threshold_ms, int max_size_kb)
+{
+	pthread_condattr_t attr;
+	struct sigaction action;
+
+	if (_stall_running) {
+		return -1;
+	}
+	_stall_notify_init();
+	if (file == NULL && _stall_watchdog == 0) {
+		return 0;
+	}
+	if (file != NULL) {
+		_stall_file = strdup(file);
+		if (_stall_file == NULL) {
+			return -1;
+		}
+		_stall_threshold = threshold_ms > 0 ? (uint32_t)threshold_ms : 1;
+		_stall_max_size = (long)max_size_kb * 1024;
+
+		// backtrace() loads libgcc on first use, which is not safe in a signal handler
+		(void)backtrace(_stall_frames, STALL_FRAMES);
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = _stall_signal;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		(void)sigaction(STALL_SIGNAL, &action, NULL);
+	}
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_stall_cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	_stall_main = pthread_self();
+	__atomic_store_n(&_stall_beat, (uint32_t)clockMillis(), __ATOMIC_RELEASE);
+	_stall_running = 1;
+	if (pthread_create(&_stall_thread, NULL, _stall_watch, NULL) != 0) {
+		logError("Failed to start stall detector thread.\n");
+		_stall_running = 0;
+		free(_stall_file);
+		_stall_file = NULL;
+		return -1;
+	}
+	if (_stall_file) {
+		logInfo("Stall detector threshold %d ms, writing to %s\n", threshold_ms, file);
+	}
+	if (_stall_watchdog) {
+		logInfo("systemd watchdog every %u ms\n", _stall_watchdog);
+	}
+	return 0;
+}
+
+void stallReady(void)
+{
+	_stall_notify("READY=1");
+}
+
+void stallLoop(void)
+{
+	if (!_stall_running) {
+		return;
+	}
+	const uint32_t now = (uint32_t)clockTickMillis();
+	// the tick clock may lag the precise one stallOpen() started with
+	const int32_t age = (int32_t)(now - __atomic_load_n(&_stall_beat, __ATOMIC_RELAXED));
+	__atomic_store_n(&_stall_beat, now, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&_stall_iteration, 1, __ATOMIC_RELEASE);
+	if (_stall_file && age >= (int32_t)_stall_threshold) {
+		logWarning("Main loop stalled for %d ms\n", age);
+	}
+}
+
+void stallIdle(int idle)
+{
+	if (!_stall_running) {
+		return;
+	}
+	if (!idle) {
+		// the sleep does not count towards the iteration
+		__atomic_store_n(&_stall_beat, (uint32_t)clockMillis(), __ATOMIC_RELEASE);
+	}
+	__atomic_store_n(&_stall_idle, idle, __ATOMIC_RELEASE);
+}
+
+void stallGauge(const char *name, stall_gauge_t depth)
+{
+	if (_stall_gauge_count < STALL_GAUGES) {
+		_stall_gauges[_stall_gauge_count].name = name;
+		_stall_gauges[_stall_gauge_count].depth = depth;
+		_stall_gauge_count++;
+	}
+}
+
+void stallRecord(char kind, const char *name, uint8_t a, uint8_t b, uint8_t c, uint8_t d,
+                 int32_t value)
+{
+	if (_stall_file == NULL) {
+		return;
+	}
+	const uint32_t index = __atomic_fetch_add(&_stall_event_head, 1, __ATOMIC_RELAXED);
+	struct stall_event *slot = &_stall_events[index & (STALL_EVENTS - 1)];
+	__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->ts_ns = clockNanos();
+	slot->name = name;
+	slot->value = value;
+	slot->kind = kind;
+	slot->a = a;
+	slot->b = b;
+	slot->c = c;
+	slot->d = d;
+	__atomic_store_n(&slot->seq, index + 1, __ATOMIC_RELEASE);
+}
+
+void stallClose(void)
+{
+	if (_stall_running) {
+		pthread_mutex_lock(&_stall_mutex);
+		_stall_running = 0;
+		pthread_cond_signal(&_stall_cond);
+		pthread_mutex_unlock(&_stall_mutex);
+		pthread_join(_stall_thread, NULL);
+		pthread_cond_destroy(&_stall_cond);
+	}
+	_stall_notify("STOPPING=1");
+	if (_stall_notify_fd >= 0) {
+		close(_stall_notify_fd);
+		_stall_notify_fd = -1;
+	}
+	free(_stall_file);
+	_stall_file = NULL;
+}
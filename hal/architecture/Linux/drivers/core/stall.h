@@ -0,0 +1,62 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef STALL_H
+#define STALL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STALL_EVENT_MSG 'M'			// a=sender, b=destination, c=command, d=type
+#define STALL_EVENT_RADIO 'R'		// a=recipient, b=length
+
+typedef unsigned int (*stall_gauge_t)(void);
+
+/*
+ * Starts the watchdog thread. With a file, a main loop iteration running longer than
+ * threshold_ms is dumped to it: backtrace of the main thread, queue depths and the most
+ * recent trace events. The file is moved to file.1 after max_size_kb (0 = never).
+ * Without a file only the systemd watchdog is served, if the service requests one.
+ * Must be called from the main thread.
+ */
+int stallOpen(const char *file, int threshold_ms, int max_size_kb);
+// Tells systemd that startup is complete (Type=notify)
+void stallReady(void);
+// Heartbeat, called by every yield of the main thread after clockTick()
+void stallLoop(void);
+// Brackets an intended sleep, the main loop counts as alive meanwhile
+void stallIdle(int idle);
+/*
+ * Adds a queue depth to the dumps. Called from the watchdog thread while the main thread
+ * is stuck, must neither block nor modify the queue.
+ */
+void stallGauge(const char *name, stall_gauge_t depth);
+// Flight recorder, name must be a string literal
+void stallRecord(char kind, const char *name, uint8_t a, uint8_t b, uint8_t c, uint8_t d,
+                 int32_t value);
+void stallClose(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
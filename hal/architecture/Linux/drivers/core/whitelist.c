@@ -0,0 +1,211 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#include "whitelist.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log.h"
+
+#define WHITELIST_NODES 256
+
+// indexed by node ID, a lookup is a bit test and an offset
+struct whitelist_table {
+	uint8_t present[WHITELIST_NODES / 8];
+	uint8_t serial[WHITELIST_NODES][WHITELIST_SERIAL_SIZE];
+	unsigned int entries;
+};
+
+static struct whitelist_table *_whitelist = NULL;
+static char *_whitelist_file = NULL;
+static unsigned int _whitelist_misses = 0;
+// misses per node since the list was loaded, a warning is logged at every power of two
+static unsigned int _whitelist_node_misses[WHITELIST_NODES];
+
+static int _whitelist_hex(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	c = (char)tolower((unsigned char)c);
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+static int _whitelist_parse_line(char *p, struct whitelist_table *table, unsigned int line)
+{
+	char *end;
+	long id;
+
+	while (isspace((unsigned char)*p)) {
+		p++;
+	}
+	if (*p == '\0' || *p == '#') {
+		return 0;
+	}
+
+	errno = 0;
+	id = strtol(p, &end, 10);
+	if (end == p || errno != 0 || id < 0 || id >= WHITELIST_NODES - 1) {
+		logError("%s:%u: invalid node id\n", _whitelist_file, line);
+		return -1;
+	}
+	if (table->present[id >> 3] & (1 << (id & 7))) {
+		logError("%s:%u: node %ld listed twice\n", _whitelist_file, line, id);
+		return -1;
+	}
+	p = end;
+	while (isspace((unsigned char)*p)) {
+		p++;
+	}
+	for (int i = 0; i < WHITELIST_SERIAL_SIZE * 2; i++) {
+		const int n = _whitelist_hex(p[i]);
+		if (n < 0) {
+			logError("%s:%u: serial must be %d hex digits\n", _whitelist_file, line,
+			         WHITELIST_SERIAL_SIZE * 2);
+			return -1;
+		}
+		if ((i & 1) == 0) {
+			table->serial[id][i / 2] = (uint8_t)(n << 4);
+		} else {
+			table->serial[id][i / 2] |= (uint8_t)n;
+		}
+	}
+	p += WHITELIST_SERIAL_SIZE * 2;
+	while (isspace((unsigned char)*p)) {
+		p++;
+	}
+	if (*p != '\0' && *p != '#') {
+		logError("%s:%u: unexpected text after serial\n", _whitelist_file, line);
+		return -1;
+	}
+
+	table->present[id >> 3] |= (uint8_t)(1 << (id & 7));
+	table->entries++;
+	return 0;
+}
+
+static struct whitelist_table *_whitelist_load(void)
+{
+	struct whitelist_table *table;
+	char *buf = NULL;
+	size_t size = 0;
+	unsigned int line = 0;
+	int ret = 0;
+	FILE *fp;
+
+	fp = fopen(_whitelist_file, "r");
+	if (fp == NULL) {
+		logError("Cannot open signing whitelist %s: %s\n", _whitelist_file, strerror(errno));
+		return NULL;
+	}
+	table = (struct whitelist_table *)calloc(1, sizeof(struct whitelist_table));
+	if (table == NULL) {
+		logError("Out of memory loading signing whitelist\n");
+		fclose(fp);
+		return NULL;
+	}
+	while (ret == 0 && getline(&buf, &size, fp) != -1) {
+		ret = _whitelist_parse_line(buf, table, ++line);
+	}
+	if (ret == 0 && ferror(fp)) {
+		logError("Cannot read signing whitelist %s\n", _whitelist_file);
+		ret = -1;
+	}
+	free(buf);
+	fclose(fp);
+
+	if (ret != 0) {
+		free(table);
+		return NULL;
+	}
+	return table;
+}
+
+int whitelistOpen(const char *file)
+{
+	whitelistClose();
+
+	_whitelist_file = strdup(file);
+	if (_whitelist_file == NULL) {
+		return -1;
+	}
+	_whitelist = _whitelist_load();
+	if (_whitelist == NULL) {
+		return -1;
+	}
+	logInfo("Signing whitelist: %u nodes from %s\n", _whitelist->entries, _whitelist_file);
+	return 0;
+}
+
+int whitelistReload(void)
+{
+	struct whitelist_table *table;
+	unsigned int nodes = 0, misses = 0;
+
+	if (_whitelist_file == NULL) {
+		return -1;
+	}
+	table = _whitelist_load();
+	if (table == NULL) {
+		logError("Signing whitelist not reloaded, keeping %u nodes\n",
+		         _whitelist ? _whitelist->entries : 0);
+		return -1;
+	}
+	free(_whitelist);
+	_whitelist = table;
+
+	for (int i = 0; i < WHITELIST_NODES; i++) {
+		if (_whitelist_node_misses[i]) {
+			nodes++;
+			misses += _whitelist_node_misses[i];
+		}
+	}
+	memset(_whitelist_node_misses, 0, sizeof(_whitelist_node_misses));
+	logInfo("Signing whitelist reloaded: %u nodes, %u misses from %u nodes since last load, "
+	        "%u since start\n", table->entries, misses, nodes, _whitelist_misses);
+	return 0;
+}
+
+const uint8_t *whitelistLookup(uint8_t nodeId)
+{
+	unsigned int count;
+
+	if (_whitelist != NULL && (_whitelist->present[nodeId >> 3] & (1 << (nodeId & 7)))) {
+		return _whitelist->serial[nodeId];
+	}
+	_whitelist_misses++;
+	count = ++_whitelist_node_misses[nodeId];
+	if ((count & (count - 1)) == 0) {
+		logWarning("Node %d is not on the signing whitelist, %u misses\n", nodeId, count);
+	}
+	return NULL;
+}
+
+void whitelistClose(void)
+{
+	free(_whitelist);
+	_whitelist = NULL;
+	free(_whitelist_file);
+	_whitelist_file = NULL;
+}
@@ -0,0 +1,53 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+#ifndef WHITELIST_H
+#define WHITELIST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WHITELIST_SERIAL_SIZE 9
+
+/*
+ * Loads the signing whitelist from file, one "<node id> <serial>" pair per line with the
+ * serial as 18 hex digits, as printed by --gen-soft-serial-key. '#' starts a comment.
+ */
+int whitelistOpen(const char *file);
+/*
+ * Reads the file again. The new list replaces the old one only if the whole file parses,
+ * a broken file keeps the previous list. Main thread only.
+ */
+int whitelistReload(void);
+/*
+ * Serial of a node, NULL if the node is not on the list. Misses are counted per node and
+ * logged as warnings at 1, 2, 4, 8... misses, the counts are summarized on reload.
+ * Main thread only.
+ */
+const uint8_t *whitelistLookup(uint8_t nodeId);
+void whitelistClose(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -54,3 +54,35 @@ void hwDebugPrint(const char *fmt, ...)
 	(void)fmt;
 #endif
 }
+
+#if !defined(MY_HW_HAS_LOCAL_TIME)
+bool hwLocalTime(uint32_t *localTime)
+{
+	(void)localTime;
+	return false;
+}
+
+bool hwLocalConfig(char *config)
+{
+	(void)config;
+	return false;
+}
+#endif
+
+#if !defined(MY_HW_HAS_CAPTURE)
+bool hwCaptureActive(void)
+{
+	return false;
+}
+
+void hwCaptureFrame(const uint8_t result, const uint8_t hop, const int16_t rssi, const int16_t snr,
+                    const void *frame, const uint8_t length)
+{
+	(void)result;
+	(void)hop;
+	(void)rssi;
+	(void)snr;
+	(void)frame;
+	(void)length;
+}
+#endif
@@ -121,6 +121,157 @@ int8_t hwCPUTemperature(void);
  */
 uint16_t hwFreeMem(void);
 
+#define HW_CAPTURE_RX			(0u)	//!< received frame
+#define HW_CAPTURE_TX_NACK		(1u)	//!< sent frame, not acknowledged
+#define HW_CAPTURE_TX_OK		(2u)	//!< sent frame, acknowledged
+#define HW_CAPTURE_TX_NO_ACK	(3u)	//!< sent frame, no ACK requested
+
+/**
+ * @def MY_HW_HAS_LOCAL_TIME
+ * @brief Define this, if a gateway can answer I_TIME and I_CONFIG itself (Linux: local_time=1,
+ * local_config=M or I)
+ *
+ * Otherwise hwLocalTime() and hwLocalConfig() return false and the controller answers.
+ */
+//#define MY_HW_HAS_LOCAL_TIME
+
+/**
+ * Local time for nodes, if the gateway answers I_TIME itself
+ * @param localTime seconds since 1970 in the configured time zone
+ * @return true if answered locally
+ */
+bool hwLocalTime(uint32_t *localTime);
+
+/**
+ * Unit system for nodes, if the gateway answers I_CONFIG itself
+ * @param config 'M' for metric, 'I' for imperial
+ * @return true if answered locally
+ */
+bool hwLocalConfig(char *config);
+
+/**
+ * @def MY_HW_HAS_CAPTURE
+ * @brief Define this, if the platform records radio frames (Linux: capture=1)
+ *
+ * Otherwise hwCaptureActive() returns false and hwCaptureFrame() does nothing.
+ */
+//#define MY_HW_HAS_CAPTURE
+
+/**
+ * Check if radio frames are recorded, the transport reads signal reports only for a capture
+ * @return true if hwCaptureFrame() records frames
+ */
+bool hwCaptureActive(void);
+
+/**
+ * Record a radio frame
+ * @param result HW_CAPTURE_RX or the result of a sent frame
+ * @param hop receiver of a sent frame, last hop of a received frame
+ * @param rssi RSSI of the frame, INVALID_RSSI if not available
+ * @param snr SNR of the frame, INVALID_SNR if not available
+ * @param frame frame as sent or received
+ * @param length length of the frame
+ */
+void hwCaptureFrame(const uint8_t result, const uint8_t hop, const int16_t rssi, const int16_t snr,
+                    const void *frame, const uint8_t length);
+
+/**
+ * @def MY_HW_HAS_JOURNAL
+ * @brief Define this, if the platform keeps gateway messages while the controller is absent
+ *
+ * The hwJournal functions are only used by the gateway if defined (Linux: journal=1).
+ */
+//#define MY_HW_HAS_JOURNAL
+
+#define HW_JOURNAL_KEY_NONE		(0u)	//!< journaled message is never superseded
+
+/**
+ * Keep a message until the controller takes it
+ * @param key a later message with the same key supersedes it, HW_JOURNAL_KEY_NONE if none
+ * @param frame message as frame
+ * @param length length of the frame, up to MAX_MESSAGE_LENGTH
+ * @return true if kept
+ */
+bool hwJournalAppend(const uint32_t key, const void *frame, const uint8_t length);
+
+/**
+ * Messages kept in the journal
+ * @return number of messages not taken by the controller yet
+ */
+uint32_t hwJournalPending(void);
+
+/**
+ * Oldest message in the journal, without removing it
+ * @param frame buffer of MAX_MESSAGE_LENGTH bytes for the message
+ * @param length length of the frame
+ * @param timestamp seconds since 1970 the message was kept at
+ * @return true if a message is pending
+ */
+bool hwJournalPeek(void *frame, uint8_t *length, uint32_t *timestamp);
+
+/**
+ * Remove the oldest message from the journal, after the controller took it
+ */
+void hwJournalPop(void);
+
+/**
+ * Messages to replay now, spreads the replay of a full journal over several loops
+ * @return number of messages the gateway may hand over to the controller now
+ */
+uint16_t hwJournalReplayBudget(void);
+
+/**
+ * The controller did not take a replayed message, delays the next replay
+ */
+void hwJournalReplayFailed(void);
+
+/**
+ * @def MY_HW_HAS_SERIES
+ * @brief Define this, if the platform keeps a history of sensor readings for the controller
+ *
+ * The hwSeries functions are only used by the gateway if defined (Linux: series=1).
+ */
+//#define MY_HW_HAS_SERIES
+
+/// @brief Series of a node, child sensor and value type
+#define HW_SERIES_KEY(__node, __sensor, __type) \
+	(((uint32_t)(__node) << 16) | ((uint32_t)(__sensor) << 8) | (uint32_t)(__type))
+
+/**
+ * @brief Called for every row of a series query
+ * @return non-zero to refuse the row and stop the query
+ */
+typedef int (*hwSeriesRow_t)(uint32_t timestamp, double value, void *context);
+
+/**
+ * Clock of the sensor history
+ * @return seconds since 1970, UTC
+ */
+uint32_t hwSeriesTime(void);
+
+/**
+ * Add a reading to the sensor history
+ * @param key series, see HW_SERIES_KEY()
+ * @param timestamp seconds since 1970, see hwSeriesTime()
+ * @param value reading
+ * @return true if kept
+ */
+bool hwSeriesAppend(const uint32_t key, const uint32_t timestamp, const double value);
+
+/**
+ * Query the sensor history
+ * @param key series, see HW_SERIES_KEY()
+ * @param from first second of the query
+ * @param to last second of the query
+ * @param aggregate R (raw), N (count), A (average), M (min), X (max) or S (sum)
+ * @param bucket seconds aggregated per row, 0 for one row
+ * @param row called for every row, in order of time
+ * @param context passed to row
+ * @return rows taken, -1 if the query is invalid
+ */
+int hwSeriesQuery(const uint32_t key, const uint32_t from, const uint32_t to, const char aggregate,
+                  const uint32_t bucket, hwSeriesRow_t row, void *context);
+
 #if defined(DEBUG_OUTPUT_ENABLED)
 void hwDebugPrint(const char *fmt, ...);
 #endif
@@ -156,6 +307,10 @@ void hwDebugPrint(const char *fmt, ...);
 #ifdef DOXYGEN
 #define MY_CRITICAL_SECTION
 #define MY_HW_HAS_GETENTROPY
+#define MY_HW_HAS_CAPTURE
+#define MY_HW_HAS_JOURNAL
+#define MY_HW_HAS_LOCAL_TIME
+#define MY_HW_HAS_SERIES
 #endif  /* DOXYGEN */
 
 #endif // #ifdef MyHw_h
@@ -65,11 +65,11 @@ bool transportInit(void);
 /**
 * @brief Set node address
 */
-void transportSetAddress(const uint8_t address);
+void transportSetAddress(const nodeId_t address);
 /**
 * @brief Retrieve node address
 */
-uint8_t transportGetAddress(void) __attribute__((unused));
+nodeId_t transportGetAddress(void) __attribute__((unused));
 /**
 * @brief Send message
 * @param to recipient
@@ -78,7 +78,7 @@ uint8_t transportGetAddress(void) __attribute__((unused));
 * @param noACK do not wait for ACK
 * @return true if message sent successfully
 */
-bool transportSend(const uint8_t to, const void *data, const uint8_t len,
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len,
                    const bool noACK = false);
 /**
 * @brief Verify if RX FIFO has pending messages
@@ -49,18 +49,18 @@ bool transportInit(void)
 	return NRF5_ESB_initialize();
 }
 
-void transportSetAddress(const uint8_t address)
+void transportSetAddress(const nodeId_t address)
 {
 	NRF5_ESB_setNodeAddress(address);
 	NRF5_ESB_startListening();
 }
 
-uint8_t transportGetAddress(void)
+nodeId_t transportGetAddress(void)
 {
 	return NRF5_ESB_getNodeID();
 }
 
-bool transportSend(const uint8_t to, const void *data, const uint8_t len, const bool noACK)
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len, const bool noACK)
 {
 #if defined(MY_NRF5_ESB_ENABLE_ENCRYPTION)
 	// copy input data because it is read-only
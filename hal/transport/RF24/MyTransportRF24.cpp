@@ -82,18 +82,18 @@ bool transportInit(void)
 	return RF24_initialize();
 }
 
-void transportSetAddress(const uint8_t address)
+void transportSetAddress(const nodeId_t address)
 {
 	RF24_setNodeAddress(address);
 	RF24_startListening();
 }
 
-uint8_t transportGetAddress(void)
+nodeId_t transportGetAddress(void)
 {
 	return RF24_getNodeID();
 }
 
-bool transportSend(const uint8_t to, const void *data, const uint8_t len, const bool noACK)
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len, const bool noACK)
 {
 #if defined(MY_RF24_ENABLE_ENCRYPTION)
 	// copy input data because it is read-only
@@ -30,7 +30,7 @@
 #endif
 
 LOCAL uint8_t RF24_BASE_ID[MY_RF24_ADDR_WIDTH] = { MY_RF24_BASE_RADIO_ID };
-LOCAL uint8_t RF24_NODE_ADDRESS = RF24_BROADCAST_ADDRESS;
+LOCAL nodeId_t RF24_NODE_ADDRESS = RF24_BROADCAST_ADDRESS;
 
 #if defined(MY_RX_MESSAGE_BUFFER_FEATURE)
 LOCAL RF24_receiveCallbackType RF24_receiveCallback = NULL;
@@ -221,10 +221,23 @@ LOCAL void RF24_setPipeAddress(const uint8_t pipe, uint8_t *address, const uint8
 	RF24_writeMultiByteRegister(pipe, address, addressWidth);
 }
 
+#if !defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
 LOCAL void RF24_setPipeLSB(const uint8_t pipe, const uint8_t LSB)
 {
 	RF24_writeByteRegister(pipe, LSB);
 }
+#endif
+
+LOCAL void RF24_setPipeNodeAddress(const uint8_t pipe, const nodeId_t address)
+{
+#if defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
+	// the high byte of extended IDs alters the second address byte, 8 bit IDs keep the base ID
+	uint8_t nodeAddress[2] = { (uint8_t)address, (uint8_t)(RF24_BASE_ID[1] ^ (address >> 8)) };
+	RF24_setPipeAddress(pipe, nodeAddress, sizeof(nodeAddress));
+#else
+	RF24_setPipeLSB(pipe, address);
+#endif
+}
 
 LOCAL uint8_t RF24_getObserveTX(void)
 {
@@ -241,12 +254,12 @@ LOCAL void RF24_enableFeatures(void)
 	RF24_RAW_writeByteRegister(RF24_CMD_ACTIVATE, 0x73);
 }
 
-LOCAL void RF24_openWritingPipe(const uint8_t recipient)
+LOCAL void RF24_openWritingPipe(const nodeId_t recipient)
 {
 	RF24_DEBUG(PSTR("RF24:OWP:RCPT=%" PRIu8 "\n"), recipient); // open writing pipe
 	// only write LSB of RX0 and TX pipe
-	RF24_setPipeLSB(RF24_REG_RX_ADDR_P0, recipient);
-	RF24_setPipeLSB(RF24_REG_TX_ADDR, recipient);
+	RF24_setPipeNodeAddress(RF24_REG_RX_ADDR_P0, recipient);
+	RF24_setPipeNodeAddress(RF24_REG_TX_ADDR, recipient);
 }
 
 LOCAL void RF24_startListening(void)
@@ -256,7 +269,7 @@ LOCAL void RF24_startListening(void)
 	RF24_setRFConfiguration(RF24_CONFIGURATION | _BV(RF24_PWR_UP) | _BV(RF24_PRIM_RX) );
 	// all RX pipe addresses must be unique, therefore skip if node ID is RF24_BROADCAST_ADDRESS
 	if(RF24_NODE_ADDRESS!= RF24_BROADCAST_ADDRESS) {
-		RF24_setPipeLSB(RF24_REG_RX_ADDR_P0, RF24_NODE_ADDRESS);
+		RF24_setPipeNodeAddress(RF24_REG_RX_ADDR_P0, RF24_NODE_ADDRESS);
 	}
 	// start listening
 	RF24_ce(HIGH);
@@ -304,7 +317,7 @@ LOCAL void RF24_standBy(void)
 }
 
 
-LOCAL bool RF24_sendMessage(const uint8_t recipient, const void *buf, const uint8_t len,
+LOCAL bool RF24_sendMessage(const nodeId_t recipient, const void *buf, const uint8_t len,
                             const bool noACK)
 {
 	uint8_t RF24_status;
@@ -368,7 +381,7 @@ LOCAL uint8_t RF24_readMessage(void *buf)
 	return len;
 }
 
-LOCAL void RF24_setNodeAddress(const uint8_t address)
+LOCAL void RF24_setNodeAddress(const nodeId_t address)
 {
 	if(address!= RF24_BROADCAST_ADDRESS) {
 		RF24_NODE_ADDRESS = address;
@@ -379,7 +392,7 @@ LOCAL void RF24_setNodeAddress(const uint8_t address)
 	}
 }
 
-LOCAL uint8_t RF24_getNodeID(void)
+LOCAL nodeId_t RF24_getNodeID(void)
 {
 	return RF24_NODE_ADDRESS;
 }
@@ -202,7 +202,7 @@ LOCAL uint8_t RF24_getFIFOStatus(void);
 * @brief RF24_openWritingPipe
 * @param recipient
 */
-LOCAL void RF24_openWritingPipe(const uint8_t recipient);
+LOCAL void RF24_openWritingPipe(const nodeId_t recipient);
 /**
 * @brief RF24_startListening
 */
@@ -235,7 +235,7 @@ LOCAL void RF24_powerUp(void);
 * @param noACK set True if no ACK is required
 * @return
 */
-LOCAL bool RF24_sendMessage(const uint8_t recipient, const void *buf, const uint8_t len,
+LOCAL bool RF24_sendMessage(const nodeId_t recipient, const void *buf, const uint8_t len,
                             const bool noACK = false);
 /**
 * @brief RF24_getDynamicPayloadSize
@@ -256,12 +256,12 @@ LOCAL uint8_t RF24_readMessage(void *buf);
 * @brief RF24_setNodeAddress
 * @param address
 */
-LOCAL void RF24_setNodeAddress(const uint8_t address);
+LOCAL void RF24_setNodeAddress(const nodeId_t address);
 /**
 * @brief RF24_getNodeID
 * @return
 */
-LOCAL uint8_t RF24_getNodeID(void);
+LOCAL nodeId_t RF24_getNodeID(void);
 /**
 * @brief RF24_sanityCheck
 * @return
@@ -330,12 +330,20 @@ LOCAL void RF24_setRFConfiguration(const uint8_t configuration);
 * @param addressWidth
 */
 LOCAL void RF24_setPipeAddress(const uint8_t pipe, uint8_t *address, const uint8_t addressWidth);
+#if !defined(MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE)
 /**
 * @brief RF24_setPipeLSB
 * @param pipe
 * @param LSB
 */
 LOCAL void RF24_setPipeLSB(const uint8_t pipe, const uint8_t LSB);
+#endif
+/**
+* @brief RF24_setPipeNodeAddress, node specific bytes of the pipe address
+* @param pipe
+* @param address
+*/
+LOCAL void RF24_setPipeNodeAddress(const uint8_t pipe, const nodeId_t address);
 /**
 * @brief RF24_getObserveTX
 * @return
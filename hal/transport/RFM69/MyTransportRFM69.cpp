@@ -104,17 +104,17 @@ bool transportInit(void)
 	return result;
 }
 
-void transportSetAddress(const uint8_t address)
+void transportSetAddress(const nodeId_t address)
 {
 	RFM69_setAddress(address);
 }
 
-uint8_t transportGetAddress(void)
+nodeId_t transportGetAddress(void)
 {
 	return RFM69_getAddress();
 }
 
-bool transportSend(const uint8_t to, const void *data, uint8_t len, const bool noACK)
+bool transportSend(const nodeId_t to, const void *data, uint8_t len, const bool noACK)
 {
 	if (noACK) {
 		(void)RFM69_sendWithRetry(to, data, len, 0, 0);
@@ -265,18 +265,18 @@ bool transportInit(void)
 	return false;
 }
 
-void transportSetAddress(const uint8_t address)
+void transportSetAddress(const nodeId_t address)
 {
 	_address = address;
 	_radio.setAddress(address);
 }
 
-uint8_t transportGetAddress(void)
+nodeId_t transportGetAddress(void)
 {
 	return _address;
 }
 
-bool transportSend(const uint8_t to, const void *data, const uint8_t len, const bool noACK)
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len, const bool noACK)
 {
 	if (noACK) {
 		(void)_radio.sendWithRetry(to, data, len, 0, 0);
@@ -58,17 +58,17 @@ bool transportInit(void)
 	return result;
 }
 
-void transportSetAddress(const uint8_t address)
+void transportSetAddress(const nodeId_t address)
 {
 	RFM95_setAddress(address);
 }
 
-uint8_t transportGetAddress(void)
+nodeId_t transportGetAddress(void)
 {
 	return RFM95_getAddress();
 }
 
-bool transportSend(const uint8_t to, const void *data, const uint8_t len, const bool noACK)
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len, const bool noACK)
 {
 #if defined(MY_RFM95_ENABLE_ENCRYPTION)
 	// copy input data because it is read-only
@@ -545,6 +545,7 @@ LOCAL bool RFM95_sendWithRetry(const uint8_t recipient, const void *buffer,
 		RFM95_DEBUG(PSTR("RFM95:SWR:SEND,TO=%" PRIu8 ",SEQ=%" PRIu16 ",RETRY=%" PRIu8 "\n"), recipient,
 		            RFM95.txSequenceNumber,
 		            retry);
+		MY_TRACE_RADIO(radio__retry, recipient, bufferSize, retry);
 		rfm95_controlFlags_t flags = 0u;
 		RFM95_setACKRequested(flags, (recipient != RFM95_BROADCAST_ADDRESS));
 		// send packet
@@ -236,7 +236,7 @@ bool _serialProcess()
 	return true;
 }
 
-bool transportSend(const uint8_t to, const void* data, const uint8_t len, const bool noACK)
+bool transportSend(const nodeId_t to, const void* data, const uint8_t len, const bool noACK)
 {
 	(void)noACK;	// not implemented
 	const char *datap = static_cast<char const *>(data);
@@ -329,12 +329,12 @@ bool transportInit(void)
 	return true;
 }
 
-void transportSetAddress(const uint8_t address)
+void transportSetAddress(const nodeId_t address)
 {
 	_nodeId = address;
 }
 
-uint8_t transportGetAddress(void)
+nodeId_t transportGetAddress(void)
 {
 	return _nodeId;
 }
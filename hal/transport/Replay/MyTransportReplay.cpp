@@ -0,0 +1,253 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+// Replay transport: feeds received radio frames from a pcap file written by the
+// gateway capture (capture=1) into the transport layer. The original timing is
+// scaled by replay_speed (0 = as fast as possible), starting replay_delay ms after
+// init. Sent frames are acknowledged and discarded, enable capture to record them.
+// See tools/replay/mysreplay.py.
+
+#include <time.h>
+#include "capture.h"
+#include "config.h"
+#include "log.h"
+
+#define REPLAY_PCAP_MAGIC_USEC	(0xa1b2c3d4)
+#define REPLAY_PCAP_MAGIC_NSEC	(0xa1b23c4d)
+#define REPLAY_PSEUDO_HEADER_SIZE	(12)
+
+static FILE *_replayFile = NULL;
+static nodeId_t _replayAddress = AUTO;
+static bool _replayNanoseconds = true;
+static bool _replayPending = false;
+static bool _replayDone = false;
+static uint8_t _replayFrame[MAX_MESSAGE_LENGTH];
+static uint8_t _replayFrameLength = 0;
+static int16_t _replayRSSI = INVALID_RSSI;
+static int16_t _replaySNR = INVALID_SNR;
+static uint64_t _replayFrameTime = 0;	// ns, capture time of pending frame
+static uint64_t _replayFirstFrameTime = 0;
+static uint64_t _replayLastFrameTime = 0;	// ns, capture time of previous frame, shifted
+static uint64_t _replayTimeShift = 0;	// ns, added where the capture clock stepped back
+static uint64_t _replayInitTime = 0;	// ns, monotonic
+static uint64_t _replayStartTime = 0;	// ns, monotonic
+static uint32_t _replayRxCount = 0;
+static uint32_t _replayTxCount = 0;
+
+static uint64_t _replayNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// read next received frame, frames sent by the captured gateway are skipped
+static bool _replayReadFrame(void)
+{
+	uint32_t record[4];
+	static uint8_t data[65535];
+
+	while (fread(record, sizeof(record), 1, _replayFile) == 1) {
+		const uint32_t length = record[2];
+		if (length > sizeof(data) || fread(data, length, 1, _replayFile) != 1) {
+			break;
+		}
+		if (length < REPLAY_PSEUDO_HEADER_SIZE + HEADER_SIZE || data[1] != CAPTURE_DIRECTION_RX) {
+			continue;
+		}
+		_replayFrameLength = (uint8_t)min(length - REPLAY_PSEUDO_HEADER_SIZE, (uint32_t)MAX_MESSAGE_LENGTH);
+		(void)memcpy(_replayFrame, &data[REPLAY_PSEUDO_HEADER_SIZE], _replayFrameLength);
+		_replayRSSI = (int16_t)(data[6] | (data[7] << 8));
+		_replaySNR = (int16_t)(data[8] | (data[9] << 8));
+		_replayFrameTime = (uint64_t)record[0] * 1000000000ull + (uint64_t)record[1] *
+		                   (_replayNanoseconds ? 1u : 1000u);
+		if (_replayFrameTime + _replayTimeShift < _replayLastFrameTime) {
+			// the capture clock stepped back, replay the frame right after the previous one
+			_replayTimeShift = _replayLastFrameTime - _replayFrameTime;
+		}
+		_replayFrameTime += _replayTimeShift;
+		_replayLastFrameTime = _replayFrameTime;
+		return true;
+	}
+	return false;
+}
+
+bool transportInit(void)
+{
+	uint32_t header[6];
+
+	if (conf.replay_file == NULL) {
+		logError("Replay transport requires replay_file in configuration.\n");
+		return false;
+	}
+	_replayFile = fopen(conf.replay_file, "rb");
+	if (_replayFile == NULL) {
+		logError("Failed to open replay file %s: %s\n", conf.replay_file, strerror(errno));
+		return false;
+	}
+	if (fread(header, sizeof(header), 1, _replayFile) != 1 ||
+	        (header[0] != REPLAY_PCAP_MAGIC_NSEC && header[0] != REPLAY_PCAP_MAGIC_USEC) ||
+	        header[5] != CAPTURE_LINKTYPE) {
+		logError("%s is not a MySensors capture file.\n", conf.replay_file);
+		fclose(_replayFile);
+		_replayFile = NULL;
+		return false;
+	}
+	_replayNanoseconds = (header[0] == REPLAY_PCAP_MAGIC_NSEC);
+	_replayPending = false;
+	_replayDone = false;
+	_replayInitTime = _replayNow();
+	_replayStartTime = 0;
+	_replayLastFrameTime = 0;
+	_replayTimeShift = 0;
+	_replayRxCount = 0;
+	_replayTxCount = 0;
+	return true;
+}
+
+void transportSetAddress(const nodeId_t address)
+{
+	_replayAddress = address;
+}
+
+nodeId_t transportGetAddress(void)
+{
+	return _replayAddress;
+}
+
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len, const bool noACK)
+{
+	(void)to;
+	(void)data;
+	(void)len;
+	(void)noACK;
+	_replayTxCount++;
+	return true;
+}
+
+bool transportAvailable(void)
+{
+	if (_replayFile == NULL || _replayDone) {
+		return false;
+	}
+	if (!_replayStartTime && (_replayNow() - _replayInitTime) < (uint64_t)conf.replay_delay * 1000000ull) {
+		// give a controller time to connect
+		return false;
+	}
+	if (!_replayPending) {
+		if (!_replayReadFrame()) {
+			_replayDone = true;
+			logInfo("Replay finished, %" PRIu32 " frames received, %" PRIu32 " frames sent.\n",
+			        _replayRxCount, _replayTxCount);
+			return false;
+		}
+		_replayPending = true;
+		if (!_replayStartTime) {
+			// time base is the first frame, tools synchronise on this message
+			_replayStartTime = _replayNow();
+			_replayFirstFrameTime = _replayFrameTime;
+			logInfo("Replay started, speed %d\n", conf.replay_speed);
+		}
+	}
+	if (!conf.replay_speed) {
+		return true;
+	}
+	// frame times never decrease, the clamp only guards the unsigned difference
+	const uint64_t elapsed = _replayFrameTime > _replayFirstFrameTime ? _replayFrameTime -
+	                         _replayFirstFrameTime : 0;
+	const uint64_t due = elapsed / (uint64_t)conf.replay_speed;
+	return (_replayNow() - _replayStartTime) >= due;
+}
+
+bool transportSanityCheck(void)
+{
+	return true;
+}
+
+uint8_t transportReceive(void *data)
+{
+	if (!_replayPending) {
+		return 0;
+	}
+	(void)memcpy(data, _replayFrame, _replayFrameLength);
+	_replayPending = false;
+	_replayRxCount++;
+	return _replayFrameLength;
+}
+
+void transportPowerDown(void)
+{
+	// Nothing to shut down here
+}
+
+void transportPowerUp(void)
+{
+	// not implemented
+}
+
+void transportSleep(void)
+{
+	// not implemented
+}
+
+void transportStandBy(void)
+{
+	// not implemented
+}
+
+int16_t transportGetSendingRSSI(void)
+{
+	// not implemented
+	return INVALID_RSSI;
+}
+
+int16_t transportGetReceivingRSSI(void)
+{
+	return _replayRSSI;
+}
+
+int16_t transportGetSendingSNR(void)
+{
+	// not implemented
+	return INVALID_SNR;
+}
+
+int16_t transportGetReceivingSNR(void)
+{
+	return _replaySNR;
+}
+
+int16_t transportGetTxPowerPercent(void)
+{
+	// not implemented
+	return static_cast<int16_t>(100);
+}
+
+int16_t transportGetTxPowerLevel(void)
+{
+	// not implemented
+	return static_cast<int16_t>(100);
+}
+
+bool transportSetTxPowerPercent(const uint8_t powerPercent)
+{
+	// not possible
+	(void)powerPercent;
+	return false;
+}
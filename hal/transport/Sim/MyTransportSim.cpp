@@ -0,0 +1,145 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+// Simulation transport: frames go through the radio medium modelled by the simulator
+// (tools/sim). Polling an empty receiver hands control back to the simulator for an idle
+// step, which doubles while nothing happens, so idle nodes cost almost nothing.
+
+#include "sim.h"
+
+static nodeId_t _simAddress = AUTO;
+static uint32_t _simIdleStep = 0;
+static int16_t _simRSSI = INVALID_RSSI;
+static uint8_t _simFrame[MAX_MESSAGE_LENGTH];
+static uint8_t _simFrameLength = 0;
+
+bool transportInit(void)
+{
+	_simIdleStep = simSelf->idle_min;
+	_simFrameLength = 0;
+	return true;
+}
+
+void transportSetAddress(const nodeId_t address)
+{
+	_simAddress = address;
+	simSelf->address = address;
+}
+
+nodeId_t transportGetAddress(void)
+{
+	return _simAddress;
+}
+
+bool transportSend(const nodeId_t to, const void *data, const uint8_t len, const bool noACK)
+{
+	_simIdleStep = simSelf->idle_min;
+	return simSelf->send(simSelf, to, data, len, noACK) != 0;
+}
+
+bool transportAvailable(void)
+{
+	simSelf->ready = isTransportReady();
+	if (!_simFrameLength) {
+		_simFrameLength = simSelf->receive(simSelf, _simFrame, &_simRSSI);
+	}
+	if (_simFrameLength) {
+		_simIdleStep = simSelf->idle_min;
+		return true;
+	}
+	simSelf->wait(simSelf, simSelf->now + _simIdleStep, 1);
+	_simIdleStep = min(_simIdleStep * 2, simSelf->idle_max);
+	_simFrameLength = simSelf->receive(simSelf, _simFrame, &_simRSSI);
+	return _simFrameLength > 0;
+}
+
+bool transportSanityCheck(void)
+{
+	return true;
+}
+
+uint8_t transportReceive(void *data)
+{
+	const uint8_t length = _simFrameLength;
+	(void)memcpy(data, _simFrame, length);
+	_simFrameLength = 0;
+	return length;
+}
+
+void transportPowerDown(void)
+{
+	// Nothing to shut down here
+}
+
+void transportPowerUp(void)
+{
+	// not implemented
+}
+
+void transportSleep(void)
+{
+	// not implemented
+}
+
+void transportStandBy(void)
+{
+	// not implemented
+}
+
+int16_t transportGetSendingRSSI(void)
+{
+	// not implemented
+	return INVALID_RSSI;
+}
+
+int16_t transportGetReceivingRSSI(void)
+{
+	return _simRSSI;
+}
+
+int16_t transportGetSendingSNR(void)
+{
+	// not implemented
+	return INVALID_SNR;
+}
+
+int16_t transportGetReceivingSNR(void)
+{
+	// not implemented
+	return INVALID_SNR;
+}
+
+int16_t transportGetTxPowerPercent(void)
+{
+	// not implemented
+	return static_cast<int16_t>(100);
+}
+
+int16_t transportGetTxPowerLevel(void)
+{
+	// not implemented
+	return static_cast<int16_t>(100);
+}
+
+bool transportSetTxPowerPercent(const uint8_t powerPercent)
+{
+	// not possible
+	(void)powerPercent;
+	return false;
+}
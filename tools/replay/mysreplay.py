@@ -0,0 +1,428 @@
+#!/usr/bin/env python3
+#
+# The MySensors Arduino library handles the wireless radio link and protocol
+# between your home built sensors/actuators and HA controller of choice.
+# The sensors forms a self healing radio network with optional repeaters. Each
+# repeater and gateway builds a routing tables in EEPROM which keeps track of the
+# network topology allowing messages to be routed to nodes.
+#
+# Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+# Copyright (C) 2013-2019 Sensnology AB
+# Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+#
+# Documentation: http://www.mysensors.org
+# Support Forum: http://forum.mysensors.org
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# version 2 as published by the Free Software Foundation.
+#
+"""Record and replay gateway traffic.
+
+record: proxy between a controller and an Ethernet gateway, writing the
+        controller stream with timestamps to a session file. Run it together
+        with capture=1 on the gateway to also record the radio side.
+
+replay: start mysgw built with --my-transport=replay --my-gateway=ethernet,
+        feed it the received radio frames of a capture and the controller
+        commands of a session file with the original timing (scaled by
+        --speed), then compare its output with the recording and report
+        throughput and latency.
+
+Session file format, one line per controller message:
+    <unix time> <direction> <serial protocol message>
+where direction is '>' for controller to gateway and '<' for gateway to
+controller.
+"""
+
+import argparse
+import collections
+import os
+import select
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+LINKTYPE_USER0 = 147
+PSEUDO_HEADER_SIZE = 12
+DIRECTION_RX = 0
+DIRECTION_TX = 1
+C_INTERNAL = 3
+PROTOCOL_VERSION_EXTENDED = 3
+HEADER_SIZE = 7
+HEADER_EXTENSION_SIZE = 3
+I_LOG_MESSAGE = 9
+
+
+class Frame(object):
+    __slots__ = ("time", "direction", "data")
+
+    def __init__(self, time_, direction, data):
+        self.time = time_
+        self.direction = direction
+        self.data = data
+
+    def key(self):
+        """(node, sensor, command, type) as used in the serial protocol"""
+        index = 2 if self.direction == DIRECTION_TX else 1
+        node = self.data[index]
+        if (self.data[3] & 0x03) == PROTOCOL_VERSION_EXTENDED:
+            # version 3 frames carry the high bytes of the node IDs behind the header
+            node |= self.data[HEADER_SIZE + index] << 8
+        return (node, self.data[6], self.data[4] & 0x07, self.data[5])
+
+
+def read_pcap(path):
+    frames = []
+    with open(path, "rb") as f:
+        header = f.read(24)
+        if len(header) < 24:
+            return frames
+        magic = struct.unpack("<I", header[:4])[0]
+        endian = "<"
+        if magic in (0xd4c3b2a1, 0x4d3cb2a1):
+            endian = ">"
+            magic = struct.unpack(">I", header[:4])[0]
+        if magic not in (0xa1b2c3d4, 0xa1b23c4d):
+            raise ValueError("%s is not a pcap file" % path)
+        divisor = 1e9 if magic == 0xa1b23c4d else 1e6
+        if struct.unpack(endian + "I", header[20:24])[0] != LINKTYPE_USER0:
+            raise ValueError("%s is not a MySensors capture" % path)
+        while True:
+            record = f.read(16)
+            if len(record) < 16:
+                break
+            sec, frac, incl, _ = struct.unpack(endian + "IIII", record)
+            data = f.read(incl)
+            if len(data) < incl:
+                break
+            if incl < PSEUDO_HEADER_SIZE + HEADER_SIZE:
+                continue
+            if ((data[PSEUDO_HEADER_SIZE + 3] & 0x03) == PROTOCOL_VERSION_EXTENDED and
+                    incl < PSEUDO_HEADER_SIZE + HEADER_SIZE + HEADER_EXTENSION_SIZE):
+                continue
+            frames.append(Frame(sec + frac / divisor, data[1], data[PSEUDO_HEADER_SIZE:]))
+    return frames
+
+
+def read_session(path):
+    sent, received = [], []
+    with open(path) as f:
+        for line in f:
+            parts = line.rstrip("\r\n").split(" ", 2)
+            if len(parts) != 3:
+                continue
+            entry = (float(parts[0]), parts[2])
+            (sent if parts[1] == ">" else received).append(entry)
+    return sent, received
+
+
+def message_key(line):
+    """(node, sensor, command, type) of a serial protocol message or None"""
+    fields = line.split(";", 5)
+    if len(fields) < 5:
+        return None
+    try:
+        return (int(fields[0]), int(fields[1]), int(fields[2]), int(fields[4]))
+    except ValueError:
+        return None
+
+
+def is_ignored(line, ignore_types):
+    key = message_key(line)
+    return key is not None and key[2] == C_INTERNAL and key[3] in ignore_types
+
+
+def percentiles(values):
+    if not values:
+        return "n=0"
+    values = sorted(values)
+
+    def pick(p):
+        return values[min(len(values) - 1, int(p * len(values)))] * 1000.0
+    return "n=%d p50=%.2fms p95=%.2fms p99=%.2fms max=%.2fms" % (
+        len(values), pick(0.50), pick(0.95), pick(0.99), values[-1] * 1000.0)
+
+
+def match_latency(requests, responses):
+    """Pair each request (time, key) with the first later unused response (time, key)"""
+    pending = collections.defaultdict(collections.deque)
+    for t, key in responses:
+        pending[key].append(t)
+    latencies = []
+    for t, key in sorted(requests):
+        queue = pending.get(key)
+        while queue and queue[0] < t:
+            queue.popleft()
+        if queue:
+            latencies.append(queue.popleft() - t)
+    return latencies
+
+
+def compare(name, expected, actual, verbose):
+    """Compare two sequences, return True if they contain the same items"""
+    exp, act = collections.Counter(expected), collections.Counter(actual)
+    missing, unexpected = exp - act, act - exp
+    ordered = list(expected) == list(actual)
+    print("%s: expected %d, got %d, missing %d, unexpected %d, order %s" % (
+        name, len(expected), len(actual), sum(missing.values()), sum(unexpected.values()),
+        "identical" if ordered else "differs"))
+    if verbose:
+        for item, count in missing.items():
+            print("  - %s (x%d)" % (item, count))
+        for item, count in unexpected.items():
+            print("  + %s (x%d)" % (item, count))
+    return not missing and not unexpected
+
+
+def record(args):
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("", args.listen))
+    listener.listen(1)
+    print("Waiting for controller on port %d" % args.listen)
+    controller, _ = listener.accept()
+    gateway = socket.create_connection((args.host, args.port))
+    buffers = {controller: b"", gateway: b""}
+    peers = {controller: (gateway, ">"), gateway: (controller, "<")}
+    count = 0
+    with open(args.output, "w") as out:
+        try:
+            while True:
+                readable, _, _ = select.select(list(peers), [], [])
+                for sock in readable:
+                    data = sock.recv(4096)
+                    if not data:
+                        return 0
+                    now = time.time()
+                    peer, direction = peers[sock]
+                    peer.sendall(data)
+                    buffers[sock] += data
+                    while b"\n" in buffers[sock]:
+                        line, buffers[sock] = buffers[sock].split(b"\n", 1)
+                        out.write("%.6f %s %s\n" % (now, direction,
+                                                      line.decode("ascii", "replace").rstrip("\r")))
+                        count += 1
+                out.flush()
+        except KeyboardInterrupt:
+            return 0
+        finally:
+            print("Recorded %d messages to %s" % (count, args.output))
+
+
+class Gateway(object):
+    """mysgw process running the replay transport"""
+
+    def __init__(self, args, workdir):
+        self.capture_file = os.path.join(workdir, "replay.pcap")
+        eeprom = os.path.join(workdir, "eeprom")
+        if args.eeprom:
+            shutil.copyfile(args.eeprom, eeprom)
+        config = os.path.join(workdir, "mysensors.conf")
+        with open(config, "w") as f:
+            f.write("verbose=info\n"
+                    "eeprom_file=%s\n"
+                    "eeprom_size=%d\n"
+                    "capture=1\n"
+                    "capture_file=%s\n"
+                    "capture_file_size=0\n"
+                    "replay_file=%s\n"
+                    "replay_speed=%d\n"
+                    "replay_delay=%d\n" % (eeprom, args.eeprom_size, self.capture_file,
+                                           os.path.abspath(args.pcap), args.speed,
+                                           args.delay))
+        self.started = threading.Event()
+        self.finished = threading.Event()
+        self.start_time = None
+        self.finish_time = None
+        self.process = subprocess.Popen([args.gateway, "--config-file=" + config],
+                                        stdout=subprocess.DEVNULL,
+                                        stderr=subprocess.PIPE)
+        self.log = open(os.path.join(workdir, "mysgw.log"), "wb")
+        self.reader = threading.Thread(target=self._read_log)
+        self.reader.daemon = True
+        self.reader.start()
+
+    def _read_log(self):
+        for line in self.process.stderr:
+            self.log.write(line)
+            if b"Replay started" in line:
+                self.start_time = time.time()
+                self.started.set()
+            elif b"Replay finished" in line:
+                self.finish_time = time.time()
+                self.finished.set()
+        self.started.set()
+        self.finished.set()
+
+    def stop(self):
+        if self.process.poll() is None:
+            self.process.send_signal(signal.SIGTERM)
+            try:
+                self.process.wait(10)
+            except subprocess.TimeoutExpired:
+                self.process.kill()
+                self.process.wait()
+        self.reader.join(1)
+        self.log.close()
+
+
+class Controller(object):
+    """Simulated controller connected to the gateway"""
+
+    def __init__(self, port, timeout):
+        deadline = time.time() + timeout
+        while True:
+            try:
+                self.sock = socket.create_connection(("127.0.0.1", port))
+                break
+            except OSError:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.05)
+        self.received = []
+        self.sent = []
+        self.last_activity = time.time()
+        self.reader = threading.Thread(target=self._read)
+        self.reader.daemon = True
+        self.reader.start()
+
+    def _read(self):
+        buffer = b""
+        while True:
+            try:
+                data = self.sock.recv(4096)
+            except OSError:
+                return
+            if not data:
+                return
+            now = time.time()
+            self.last_activity = now
+            buffer += data
+            while b"\n" in buffer:
+                line, buffer = buffer.split(b"\n", 1)
+                self.received.append((now, line.decode("ascii", "replace").rstrip("\r")))
+
+    def send(self, line):
+        self.sent.append((time.time(), line))
+        self.sock.sendall((line + "\n").encode("ascii"))
+
+    def close(self):
+        try:
+            self.sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        self.sock.close()
+
+
+def replay(args):
+    capture = read_pcap(args.pcap)
+    rx = [f for f in capture if f.direction == DIRECTION_RX]
+    if not rx:
+        print("%s contains no received frames" % args.pcap)
+        return 2
+    session_sent, session_received = read_session(args.session) if args.session else ([], [])
+    origin = rx[0].time
+    workdir = tempfile.mkdtemp(prefix="mysreplay.")
+    gateway = Gateway(args, workdir)
+    try:
+        controller = Controller(args.port, args.timeout)
+        if not gateway.started.wait(args.delay / 1000.0 + args.timeout) or gateway.start_time is None:
+            print("Gateway did not start replaying, see %s" % os.path.join(workdir, "mysgw.log"))
+            return 2
+        for t, line in session_sent:
+            if args.speed:
+                delay = gateway.start_time + (t - origin) / args.speed - time.time()
+                if delay > 0:
+                    time.sleep(delay)
+            controller.send(line)
+        gateway.finished.wait()
+        while time.time() - controller.last_activity < args.idle:
+            time.sleep(0.1)
+        end_time = time.time()
+        controller.close()
+    finally:
+        gateway.stop()
+
+    output = read_pcap(gateway.capture_file)
+    out_rx = [f for f in output if f.direction == DIRECTION_RX]
+    out_tx = [f for f in output if f.direction == DIRECTION_TX]
+    ignore = set(args.ignore_type)
+    received = [(t, l) for t, l in controller.received if not is_ignored(l, ignore)]
+
+    duration = (gateway.finish_time or end_time) - gateway.start_time
+    print("Replay: %d radio frames, %d controller commands, speed %s, %.3fs" % (
+        len(rx), len(controller.sent), ("%dx" % args.speed) if args.speed else "max", duration))
+    if duration > 0:
+        print("Throughput: %.1f frames/s in, %.1f frames/s out, %.1f msgs/s to controller" % (
+            len(out_rx) / duration, len(out_tx) / duration, len(received) / duration))
+    uplink = match_latency([(f.time, f.key()) for f in out_rx],
+                           [(t, message_key(l)) for t, l in received])
+    downlink = match_latency([(t, message_key(l)) for t, l in controller.sent],
+                             [(f.time, f.key()) for f in out_tx])
+    print("Latency radio -> controller: %s" % percentiles(uplink))
+    print("Latency controller -> radio: %s" % percentiles(downlink))
+
+    equivalent = compare("Radio frames sent", [bytes(f.data).hex() for f in capture
+                                               if f.direction == DIRECTION_TX],
+                         [bytes(f.data).hex() for f in out_tx], args.verbose)
+    if args.session:
+        equivalent &= compare("Controller messages", [l for _, l in session_received
+                                                      if not is_ignored(l, ignore)],
+                              [l for _, l in received], args.verbose)
+    print("Result: %s" % ("equivalent" if equivalent else "DIFFERENT"))
+    if args.keep:
+        print("Output kept in %s" % workdir)
+    else:
+        shutil.rmtree(workdir, ignore_errors=True)
+    return 0 if equivalent else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command")
+    commands.required = True
+
+    rec = commands.add_parser("record", help="record a controller session")
+    rec.add_argument("-o", "--output", required=True, help="session file to write")
+    rec.add_argument("--listen", type=int, default=5004,
+                     help="port the controller connects to [5004]")
+    rec.add_argument("--host", default="127.0.0.1", help="gateway address [127.0.0.1]")
+    rec.add_argument("--port", type=int, default=5003, help="gateway port [5003]")
+    rec.set_defaults(func=record)
+
+    rep = commands.add_parser("replay", help="replay a captured session into mysgw")
+    rep.add_argument("--gateway", required=True,
+                     help="mysgw built with --my-transport=replay --my-gateway=ethernet")
+    rep.add_argument("--pcap", required=True, help="radio capture (capture=1)")
+    rep.add_argument("--session", help="controller session file (record)")
+    rep.add_argument("--eeprom", help="EEPROM file to start from, e.g. a copy from production")
+    rep.add_argument("--eeprom-size", type=int, default=1024, help="EEPROM size [1024]")
+    rep.add_argument("--speed", type=int, default=1,
+                     help="time scaling, 1 = original, 10 = ten times faster, 0 = max [1]")
+    rep.add_argument("--port", type=int, default=5003, help="gateway port [5003]")
+    rep.add_argument("--delay", type=int, default=1000,
+                     help="ms to connect the controller before replay starts [1000]")
+    rep.add_argument("--idle", type=float, default=2.0,
+                     help="seconds without output before the replay is complete [2]")
+    rep.add_argument("--timeout", type=float, default=10.0,
+                     help="seconds to wait for the gateway to start [10]")
+    rep.add_argument("--ignore-type", type=int, action="append", default=[I_LOG_MESSAGE],
+                     help="internal message type excluded from comparison [9]")
+    rep.add_argument("--keep", action="store_true", help="keep the output capture and log")
+    rep.add_argument("-v", "--verbose", action="store_true", help="list differences")
+    rep.set_defaults(func=replay)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,673 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+// Discrete-event network simulator.
+//
+// Every node runs the real library on its own coroutine and virtual clock. The
+// scheduler always resumes the node with the earliest pending event (a timer
+// or a frame arrival), so simulated time advances as fast as the nodes can
+// compute. The radio medium places nodes at random in a square: frames reach
+// nodes within range, with a loss probability growing towards the edge of
+// the range. Unicast frames are retried until acknowledged like auto
+// retransmitting radios do. A sender defers while a neighbour transmits and
+// backs off at random, so hidden nodes aside frames reach a receiver one
+// after the other. Collisions are not modelled.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <getopt.h>
+#include <dlfcn.h>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "sim.h"
+
+#define SIM_GATEWAY_ADDRESS		0
+#define SIM_BROADCAST_ADDRESS	255
+#define SIM_EXTENDED_NODE_ID_LAST	0xFEFF
+#define SIM_MAX_FRAME			32
+#define SIM_STACK_SIZE			(256 * 1024)
+#define SIM_ID_LEASE			(300 * 1000000ull)	// us an unused ID stays handed out
+
+struct simFrame {
+	uint64_t arrival;
+	int16_t rssi;
+	uint8_t length;
+	uint8_t data[SIM_MAX_FRAME];
+};
+
+struct simNodeState {
+	simNode_t sim;
+	ucontext_t context;
+	std::vector<char> stack;
+	simNodeMain_t main;
+	double x;
+	double y;
+	uint64_t wake;
+	uint64_t channelBusy;				// a neighbour transmits until then
+	bool wakeOnFrame;
+	uint32_t generation;
+	std::deque<simFrame> rx;
+	bool ready;
+	uint64_t readyAt;
+	std::string controllerOut;			// gateway only
+	std::string controllerIn;			// gateway only
+};
+
+struct simEvent {
+	uint64_t time;
+	uint64_t sequence;
+	uint32_t node;
+	uint32_t generation;
+	bool operator>(const simEvent &other) const
+	{
+		return time != other.time ? time > other.time : sequence > other.sequence;
+	}
+};
+
+static struct {
+	unsigned int nodes = 200;
+	double duration = 3600.0;			// s
+	double size = 0.0;					// m, 0 = derived from node count
+	double range = 30.0;				// m
+	double loss = 0.02;					// at distance 0
+	double edgeLoss = 0.4;				// at range
+	uint32_t airtime = 1000;			// us per frame
+	unsigned int retries = 5;
+	unsigned int rxQueue = 3;
+	uint32_t reportInterval = 60000;	// ms
+	uint32_t bootSpread = 60000;		// ms
+	uint32_t idleMin = 1000;			// us
+	uint32_t idleMax = 1000000;			// us
+	uint32_t seed = 1;
+	std::string libDir = "build";
+	bool verbose = false;
+	bool controller = false;
+	bool sendAsync = false;
+} options;
+
+static struct {
+	uint64_t transmissions;
+	uint64_t retransmissions;
+	uint64_t broadcasts;
+	uint64_t receptions;
+	uint64_t deferrals;
+	uint64_t lost;
+	uint64_t overflows;
+	uint64_t acked;
+	uint64_t nacked;
+	uint64_t controllerMessages;
+} stats;
+
+static std::vector<simNodeState> nodes;
+static std::priority_queue<simEvent, std::vector<simEvent>, std::greater<simEvent> > events;
+static uint64_t eventSequence = 0;
+static ucontext_t schedulerContext;
+static simNodeState *current = NULL;
+static std::mt19937 rng;
+static std::uniform_real_distribution<double> uniform(0.0, 1.0);
+static std::vector<uint64_t> idHandedOut(SIM_EXTENDED_NODE_ID_LAST + 1);	// us + 1, 0 = never
+static std::vector<bool> idSeen(SIM_EXTENDED_NODE_ID_LAST + 1);
+static std::set<std::pair<uint16_t, std::string> > delivered;
+static uint64_t lastReadyChange = 0;
+
+static void schedule(simNodeState &node, uint64_t time)
+{
+	node.wake = time;
+	node.generation++;
+	events.push(simEvent{time, eventSequence++, (uint32_t)(&node - &nodes[0]), node.generation});
+}
+
+static void simWait(simNode_t *sim, uint64_t until, int wakeOnFrame)
+{
+	simNodeState &node = *(simNodeState *)sim->host;
+	node.wakeOnFrame = wakeOnFrame != 0;
+	if (wakeOnFrame) {
+		// frames that already arrived were seen by the caller, only wait for new ones
+		for (const simFrame &frame : node.rx) {
+			if (frame.arrival > sim->now) {
+				until = std::min(until, frame.arrival);
+			}
+		}
+	}
+	schedule(node, until);
+	swapcontext(&node.context, &schedulerContext);
+}
+
+static double distance(const simNodeState &a, const simNodeState &b)
+{
+	return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// one transmission from a to b, true if b received it
+static bool transmit(const simNodeState &a, const simNodeState &b, double *d)
+{
+	*d = distance(a, b);
+	if (*d > options.range) {
+		return false;
+	}
+	const double ratio = *d / options.range;
+	return uniform(rng) >= options.loss + (options.edgeLoss - options.loss) * ratio * ratio;
+}
+
+// carrier sense: wait until no neighbour transmits, plus a random backoff so that nodes
+// deferring to the same frame do not all start together
+static void channelAccess(simNodeState &self)
+{
+	while (self.channelBusy > self.sim.now) {
+		stats.deferrals++;
+		simWait(&self.sim, self.channelBusy + (uint64_t)(uniform(rng) * options.airtime), 0);
+	}
+}
+
+// the frame occupies the channel of every node within range of the sender
+static uint64_t occupyChannel(simNodeState &self)
+{
+	const uint64_t arrival = self.sim.now + options.airtime;
+	for (simNodeState &node : nodes) {
+		if (&node != &self && distance(self, node) <= options.range) {
+			node.channelBusy = std::max(node.channelBusy, arrival);
+		}
+	}
+	return arrival;
+}
+
+static bool deliver(simNodeState &to, uint64_t arrival, double d, const void *data, uint8_t len)
+{
+	if (to.rx.size() >= options.rxQueue) {
+		stats.overflows++;
+		return false;
+	}
+	simFrame frame;
+	frame.arrival = arrival;
+	frame.rssi = (int16_t)(-40 - 60 * d / options.range);
+	frame.length = std::min(len, (uint8_t)SIM_MAX_FRAME);
+	memcpy(frame.data, data, frame.length);
+	to.rx.push_back(frame);
+	stats.receptions++;
+	if (to.wakeOnFrame && arrival < to.wake) {
+		schedule(to, arrival);
+	}
+	return true;
+}
+
+static int simSend(simNode_t *sim, uint16_t to, const void *data, uint8_t len, int noAck)
+{
+	simNodeState &self = *(simNodeState *)sim->host;
+	int result = 0;
+	double d;
+
+	if (to == SIM_BROADCAST_ADDRESS) {
+		channelAccess(self);
+		stats.transmissions++;
+		stats.broadcasts++;
+		const uint64_t arrival = occupyChannel(self);
+		for (simNodeState &node : nodes) {
+			if (&node == &self) {
+				continue;
+			}
+			if (transmit(self, node, &d)) {
+				deliver(node, arrival, d, data, len);
+			} else if (d <= options.range) {
+				stats.lost++;
+			}
+		}
+		simWait(sim, arrival, 0);
+		return 1;
+	}
+
+	simNodeState *target = NULL;
+	for (simNodeState &node : nodes) {
+		if (&node != &self && node.sim.address == to) {
+			target = &node;
+			break;
+		}
+	}
+	// every attempt takes one airtime, the receiver keeps draining its queue meanwhile
+	bool received = false;
+	for (unsigned int attempt = 0; attempt <= (noAck ? 0 : options.retries); attempt++) {
+		channelAccess(self);
+		const uint64_t arrival = occupyChannel(self);
+		stats.transmissions++;
+		if (attempt) {
+			stats.retransmissions++;
+		}
+		bool acked = false;
+		if (target == NULL || !transmit(self, *target, &d)) {
+			stats.lost++;
+		} else if (received || deliver(*target, arrival, d, data, len)) {
+			// duplicates of a frame already received are filtered by the radio
+			received = true;
+			acked = noAck || transmit(*target, self, &d);
+		}
+		simWait(sim, arrival, 0);
+		if (acked) {
+			result = 1;
+			break;
+		}
+	}
+	if (!noAck) {
+		result ? stats.acked++ : stats.nacked++;
+	}
+	return result;
+}
+
+static uint8_t simReceive(simNode_t *sim, void *data, int16_t *rssi)
+{
+	simNodeState &node = *(simNodeState *)sim->host;
+	if (node.rx.empty() || node.rx.front().arrival > sim->now) {
+		return 0;
+	}
+	const simFrame &frame = node.rx.front();
+	const uint8_t length = frame.length;
+	memcpy(data, frame.data, length);
+	*rssi = frame.rssi;
+	node.rx.pop_front();
+	return length;
+}
+
+// the simulated controller: assigns node ids and collects reports
+static void controllerMessage(simNodeState &gateway, const std::string &line)
+{
+	unsigned int node, child, command, ack, type;
+	int offset = 0;
+
+	stats.controllerMessages++;
+	if (options.controller) {
+		printf("%10.3f %s\n", gateway.sim.now / 1e6, line.c_str());
+	}
+	if (sscanf(line.c_str(), "%u;%u;%u;%u;%u;%n", &node, &child, &command, &ack, &type, &offset) < 5) {
+		return;
+	}
+	if (node > SIM_GATEWAY_ADDRESS && node < idSeen.size()) {
+		idSeen[node] = true;
+	}
+	if (command == 3 && type == 3) {
+		// I_ID_REQUEST, the child id carries the token the node expects back, a payload of 3
+		// marks a path relaying extended IDs. A node retries when the response got lost, so an
+		// ID no node has used yet is handed out again once its lease ran out.
+		const bool extended = offset && line.compare(offset, std::string::npos, "3") == 0;
+		const unsigned int last = extended ? SIM_EXTENDED_NODE_ID_LAST : SIM_BROADCAST_ADDRESS - 1;
+		for (unsigned int id = 1; id <= last; id++) {
+			if (id == SIM_BROADCAST_ADDRESS || idSeen[id] ||
+			        (idHandedOut[id] && idHandedOut[id] - 1 + SIM_ID_LEASE > gateway.sim.now)) {
+				continue;
+			}
+			idHandedOut[id] = gateway.sim.now + 1;
+			char response[32];
+			snprintf(response, sizeof(response), "255;%u;3;0;4;%u\n", child, id);
+			gateway.controllerIn += response;
+			break;
+		}
+	} else if (command == 1 && !ack && offset) {
+		delivered.insert(std::make_pair((uint16_t)node, line.substr(offset)));
+	}
+}
+
+static void simControllerWrite(simNode_t *sim, uint8_t c)
+{
+	simNodeState &gateway = *(simNodeState *)sim->host;
+	if (c == '\n') {
+		controllerMessage(gateway, gateway.controllerOut);
+		gateway.controllerOut.clear();
+	} else {
+		gateway.controllerOut += (char)c;
+	}
+}
+
+static int simControllerRead(simNode_t *sim)
+{
+	simNodeState &gateway = *(simNodeState *)sim->host;
+	if (gateway.controllerIn.empty()) {
+		return -1;
+	}
+	const int c = (unsigned char)gateway.controllerIn[0];
+	gateway.controllerIn.erase(0, 1);
+	return c;
+}
+
+static void nodeEntry(void)
+{
+	current->main(&current->sim);
+}
+
+// every node needs its own copy of the library globals, so each loads its own file
+static simNodeMain_t loadNode(const std::string &library, const std::string &workDir, unsigned int index)
+{
+	const std::string copy = workDir + "/node" + std::to_string(index) + ".so";
+	FILE *in = fopen(library.c_str(), "rb");
+	FILE *out = fopen(copy.c_str(), "wb");
+	if (in == NULL || out == NULL) {
+		fprintf(stderr, "Cannot copy %s to %s\n", library.c_str(), copy.c_str());
+		exit(1);
+	}
+	char buffer[65536];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+		if (fwrite(buffer, 1, n, out) != n) {
+			fprintf(stderr, "Cannot write %s\n", copy.c_str());
+			exit(1);
+		}
+	}
+	fclose(in);
+	fclose(out);
+
+	void *handle = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+	unlink(copy.c_str());
+	if (handle == NULL) {
+		fprintf(stderr, "%s\n", dlerror());
+		exit(1);
+	}
+	simNodeMain_t entry = (simNodeMain_t)dlsym(handle, "simNodeMain");
+	if (entry == NULL) {
+		fprintf(stderr, "%s has no simNodeMain\n", library.c_str());
+		exit(1);
+	}
+	return entry;
+}
+
+static void usage(void)
+{
+	printf("Usage: mysim [options]\n"
+	       "  --nodes=N              number of nodes besides the gateway [200]\n"
+	       "  --duration=S           simulated seconds [3600]\n"
+	       "  --size=M               side of the square area in m [derived from nodes]\n"
+	       "  --range=M              radio range in m [30]\n"
+	       "  --loss=P               frame loss probability next to the sender [0.02]\n"
+	       "  --edge-loss=P          frame loss probability at the edge of the range [0.4]\n"
+	       "  --airtime=US           air time of a frame in us [1000]\n"
+	       "  --retries=N            retransmissions of unacknowledged frames [5]\n"
+	       "  --rx-queue=N           frames a receiver buffers [3]\n"
+	       "  --report-interval=MS   ms between node reports [60000]\n"
+	       "  --send-async           nodes queue reports with sendAsync() and request an ack\n"
+	       "  --boot-spread=MS       nodes boot at random within this time [60000]\n"
+	       "  --idle-min=US          first idle step of a node [1000]\n"
+	       "  --idle-max=US          largest idle step of a node [1000000]\n"
+	       "  --seed=N               random seed [1]\n"
+	       "  --lib-dir=DIR          directory of gateway.so and node.so [build]\n"
+	       "  --controller           print the controller traffic\n"
+	       "  --verbose              print the node logs\n");
+}
+
+static void parseOptions(int argc, char *argv[])
+{
+	static struct option longOptions[] = {
+		{"nodes",			required_argument,	0,	'n'},
+		{"duration",		required_argument,	0,	'd'},
+		{"size",			required_argument,	0,	'S'},
+		{"range",			required_argument,	0,	'r'},
+		{"loss",			required_argument,	0,	'l'},
+		{"edge-loss",		required_argument,	0,	'e'},
+		{"airtime",			required_argument,	0,	'a'},
+		{"retries",			required_argument,	0,	'R'},
+		{"rx-queue",		required_argument,	0,	'q'},
+		{"report-interval",	required_argument,	0,	'i'},
+		{"send-async",		no_argument,		0,	'A'},
+		{"boot-spread",		required_argument,	0,	'b'},
+		{"idle-min",		required_argument,	0,	'm'},
+		{"idle-max",		required_argument,	0,	'M'},
+		{"seed",			required_argument,	0,	's'},
+		{"lib-dir",			required_argument,	0,	'L'},
+		{"controller",		no_argument,		0,	'c'},
+		{"verbose",			no_argument,		0,	'v'},
+		{"help",			no_argument,		0,	'h'},
+		{0, 0, 0, 0}
+	};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "n:d:s:vh", longOptions, NULL)) != -1) {
+		switch (opt) {
+		case 'n':
+			options.nodes = atoi(optarg);
+			break;
+		case 'd':
+			options.duration = atof(optarg);
+			break;
+		case 'S':
+			options.size = atof(optarg);
+			break;
+		case 'r':
+			options.range = atof(optarg);
+			break;
+		case 'l':
+			options.loss = atof(optarg);
+			break;
+		case 'e':
+			options.edgeLoss = atof(optarg);
+			break;
+		case 'a':
+			options.airtime = atoi(optarg);
+			break;
+		case 'R':
+			options.retries = atoi(optarg);
+			break;
+		case 'q':
+			options.rxQueue = atoi(optarg);
+			break;
+		case 'i':
+			options.reportInterval = atoi(optarg);
+			break;
+		case 'A':
+			options.sendAsync = true;
+			break;
+		case 'b':
+			options.bootSpread = atoi(optarg);
+			break;
+		case 'm':
+			options.idleMin = atoi(optarg);
+			break;
+		case 'M':
+			options.idleMax = atoi(optarg);
+			break;
+		case 's':
+			options.seed = atoi(optarg);
+			break;
+		case 'L':
+			options.libDir = optarg;
+			break;
+		case 'c':
+			options.controller = true;
+			break;
+		case 'v':
+			options.verbose = true;
+			break;
+		case 'h':
+			usage();
+			exit(0);
+		default:
+			usage();
+			exit(1);
+		}
+	}
+	// more than 253 nodes need libraries built with MY_TRANSPORT_EXTENDED_ADDRESS_FEATURE
+	if (options.nodes < 1 || options.nodes > 4000) {
+		fprintf(stderr, "--nodes must be between 1 and 4000\n");
+		exit(1);
+	}
+	if (options.idleMin < 1 || options.idleMax < options.idleMin || options.rxQueue < 1) {
+		fprintf(stderr, "Invalid idle step or receive queue size\n");
+		exit(1);
+	}
+	if (options.size <= 0) {
+		// about 15 neighbours per node
+		options.size = std::sqrt((options.nodes + 1) * M_PI * options.range * options.range / 15.0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	parseOptions(argc, argv);
+	rng.seed(options.seed);
+	srand(options.seed);
+
+	char workDir[] = "/tmp/mysim.XXXXXX";
+	if (mkdtemp(workDir) == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	// node 0 is the gateway in the centre
+	nodes.resize(options.nodes + 1);
+	std::vector<std::string> eepromFiles(nodes.size());
+	for (unsigned int i = 0; i < nodes.size(); i++) {
+		simNodeState &node = nodes[i];
+		eepromFiles[i] = std::string(workDir) + "/eeprom" + std::to_string(i);
+		node.sim.now = 0;
+		node.sim.seed = options.seed * 7919 + i;
+		node.sim.eeprom_file = eepromFiles[i].c_str();
+		node.sim.report_interval = options.reportInterval;
+		node.sim.send_async = options.sendAsync;
+		node.sim.idle_min = options.idleMin;
+		node.sim.idle_max = options.idleMax;
+		node.sim.verbose = options.verbose;
+		node.sim.host = &node;
+		node.sim.wait = simWait;
+		node.sim.send = simSend;
+		node.sim.receive = simReceive;
+		node.sim.index = i;
+		node.sim.controller_write = simControllerWrite;
+		node.sim.controller_read = simControllerRead;
+		node.sim.address = i ? SIM_BROADCAST_ADDRESS : SIM_GATEWAY_ADDRESS;
+		node.sim.ready = 0;
+		node.sim.reports = 0;
+		node.sim.async_acked = 0;
+		node.sim.async_no_ack = 0;
+		node.sim.async_failed = 0;
+		node.x = i ? uniform(rng) * options.size : options.size / 2;
+		node.y = i ? uniform(rng) * options.size : options.size / 2;
+		node.channelBusy = 0;
+		node.wakeOnFrame = false;
+		node.generation = 0;
+		node.ready = false;
+		node.readyAt = 0;
+		node.main = loadNode(options.libDir + (i ? "/node.so" : "/gateway.so"), workDir, i);
+		node.stack.resize(SIM_STACK_SIZE);
+		getcontext(&node.context);
+		node.context.uc_stack.ss_sp = node.stack.data();
+		node.context.uc_stack.ss_size = node.stack.size();
+		node.context.uc_link = NULL;
+		makecontext(&node.context, nodeEntry, 0);
+		node.sim.boot = i ? (uint64_t)(uniform(rng) * options.bootSpread * 1000) : 0;
+		schedule(node, node.sim.boot);
+	}
+
+	struct timeval wallStart, wallEnd;
+	gettimeofday(&wallStart, NULL);
+	const uint64_t end = (uint64_t)(options.duration * 1e6);
+	unsigned int ready = 0;
+	uint64_t now = 0;
+	while (!events.empty()) {
+		const simEvent event = events.top();
+		if (event.time > end) {
+			break;
+		}
+		events.pop();
+		simNodeState &node = nodes[event.node];
+		if (event.generation != node.generation) {
+			continue;
+		}
+		now = event.time;
+		node.sim.now = now;
+		current = &node;
+		swapcontext(&schedulerContext, &node.context);
+		if (event.node == 0 || (bool)node.sim.ready == node.ready) {
+			continue;
+		}
+		// Only sensor nodes count towards convergence, the gateway is ready once started
+		node.ready = node.sim.ready;
+		if (node.ready) {
+			node.readyAt = now;
+			ready++;
+		} else {
+			ready--;
+		}
+		lastReadyChange = now;
+	}
+	gettimeofday(&wallEnd, NULL);
+	const double wall = (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_usec - wallStart.tv_usec) / 1e6;
+
+	std::vector<double> joins;
+	uint64_t reports = 0, asyncAcked = 0, asyncNoAck = 0, asyncFailed = 0;
+	std::vector<unsigned int> users(SIM_EXTENDED_NODE_ID_LAST + 1);
+	for (unsigned int i = 1; i < nodes.size(); i++) {
+		if (nodes[i].ready) {
+			joins.push_back(nodes[i].readyAt / 1e6);
+		}
+		reports += nodes[i].sim.reports;
+		asyncAcked += nodes[i].sim.async_acked;
+		asyncNoAck += nodes[i].sim.async_no_ack;
+		asyncFailed += nodes[i].sim.async_failed;
+		if (nodes[i].sim.address < users.size()) {
+			users[nodes[i].sim.address]++;
+		}
+	}
+	// nodes waiting for an ID at the same time accept the same response if their 8 bit request
+	// tokens are equal
+	unsigned int handedOut = 0, shared = 0;
+	for (unsigned int id = 1; id < users.size(); id++) {
+		handedOut += idHandedOut[id] != 0;
+		shared += (id != SIM_BROADCAST_ADDRESS && users[id] > 1) ? users[id] : 0;
+	}
+	std::sort(joins.begin(), joins.end());
+
+	printf("Simulated %.1f s of %u nodes in %.2f s (%.0fx real time), area %.0f m x %.0f m, seed %u\n",
+	       options.duration, options.nodes, wall, wall > 0 ? options.duration / wall : 0.0,
+	       options.size, options.size, options.seed);
+	printf("Convergence: %u/%u nodes ready", ready, options.nodes);
+	if (ready == options.nodes) {
+		printf(", all ready after %.3f s", lastReadyChange / 1e6);
+	}
+	if (!joins.empty()) {
+		printf(", join time median %.3f s, max %.3f s", joins[joins.size() / 2], joins.back());
+	}
+	printf("\n");
+	printf("Frames: %llu sent (%llu broadcast, %llu retransmissions, %llu deferred), %llu received, "
+	       "%llu lost, %llu receiver overflows\n", (unsigned long long)stats.transmissions,
+	       (unsigned long long)stats.broadcasts, (unsigned long long)stats.retransmissions,
+	       (unsigned long long)stats.deferrals, (unsigned long long)stats.receptions,
+	       (unsigned long long)stats.lost, (unsigned long long)stats.overflows);
+	printf("IDs: %u handed out, %u nodes share their ID with another node\n", handedOut, shared);
+	printf("Unicast: %llu acknowledged, %llu failed\n", (unsigned long long)stats.acked,
+	       (unsigned long long)stats.nacked);
+	printf("Reports: %llu sent, %zu delivered to controller, delivery ratio %.2f%%\n",
+	       (unsigned long long)reports, delivered.size(),
+	       reports ? 100.0 * delivered.size() / reports : 0.0);
+	if (options.sendAsync) {
+		// reports still queued or waiting for their ack at the end are not counted
+		printf("Async: %llu acknowledged, %llu ack timeouts, %llu failed\n",
+		       (unsigned long long)asyncAcked, (unsigned long long)asyncNoAck,
+		       (unsigned long long)asyncFailed);
+	}
+
+	for (const std::string &file : eepromFiles) {
+		unlink(file.c_str());
+	}
+	rmdir(workDir);
+	return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * The MySensors Arduino library handles the wireless radio link and protocol
+ * between your home built sensors/actuators and HA controller of choice.
+ * The sensors forms a self healing radio network with optional repeaters. Each
+ * repeater and gateway builds a routing tables in EEPROM which keeps track of the
+ * network topology allowing messages to be routed to nodes.
+ *
+ * Created by Henrik Ekblad <henrik.ekblad@mysensors.org>
+ * Copyright (C) 2013-2019 Sensnology AB
+ * Full contributor list: https://github.com/mysensors/MySensors/graphs/contributors
+ *
+ * Documentation: http://www.mysensors.org
+ * Support Forum: http://forum.mysensors.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ */
+
+// Sketch run by every simulated node. Built twice by the Makefile: as the gateway
+// (SIM_GATEWAY, serial protocol towards the simulated controller) and as a repeater
+// node sending a report every report_interval ms, with send() or, with --send-async,
+// queued by sendAsync() with an ack requested.
+
+#ifndef MY_SIMULATION
+#define MY_SIMULATION
+#endif
+
+#if defined(SIM_GATEWAY)
+#define MY_GATEWAY_SERIAL
+#else
+#define MY_REPEATER_FEATURE
+#define MY_SEND_QUEUE_FEATURE
+#endif
+
+#include <MySensors.h>
+
+#if !defined(SIM_GATEWAY)
+#define CHILD_ID 0
+
+MyMessage msg(CHILD_ID, V_CUSTOM);
+static uint32_t counter = 0;
+
+// outcome of a queued report, known after the ack arrived or MY_SEND_QUEUE_ACK_TIMEOUT_MS
+static void reportDone(const MyMessage &message, const sendStatus_t status)
+{
+	(void)message;
+	if (status == SEND_ACKED) {
+		simSelf->async_acked++;
+	} else if (status == SEND_NO_ACK) {
+		simSelf->async_no_ack++;
+	} else {
+		simSelf->async_failed++;
+	}
+}
+
+void presentation()
+{
+	sendSketchInfo("Simulated node", "1.0");
+	present(CHILD_ID, S_CUSTOM);
+}
+
+void loop()
+{
+	wait(simSelf->report_interval);
+	if (isTransportReady()) {
+		// the simulator counts reports arriving at the controller against these
+		if (!simSelf->send_async) {
+			send(msg.set(counter++));
+			simSelf->reports++;
+		} else if (sendAsync(msg.set(counter), true, reportDone)) {
+			// sent from _process() during the next wait(), which also waits for the ack
+			counter++;
+			simSelf->reports++;
+		}
+	}
+}
+#endif
@@ -0,0 +1,129 @@
+-- MySensors radio frame dissector for Wireshark
+--
+-- Decodes pcap files written by mysgw when capture=1 is set in mysensors.conf.
+-- Usage:
+--   wireshark -X lua_script:mysensors.lua /tmp/mysgw.pcap
+-- or copy this file to your Wireshark personal plugins directory.
+--
+-- Each frame carries a 12 byte pseudo header (little endian) followed by the
+-- raw MySensors message as it was sent or received by the radio:
+--   0 version, 1 direction, 2 hop, 3 tx result, 4 retries, 5 reserved,
+--   6-7 RSSI, 8-9 SNR, 10-11 reserved
+
+local mys = Proto("mysensors", "MySensors")
+
+local directions = { [0] = "RX", [1] = "TX" }
+local tx_results = { [0] = "NACK", [1] = "OK", [2] = "Unknown", [0xFF] = "n/a" }
+local commands = {
+	[0] = "C_PRESENTATION", [1] = "C_SET", [2] = "C_REQ",
+	[3] = "C_INTERNAL", [4] = "C_STREAM", [5] = "C_RESERVED_5",
+	[6] = "C_RESERVED_6", [7] = "C_INVALID_7"
+}
+local payload_types = {
+	[0] = "P_STRING", [1] = "P_BYTE", [2] = "P_INT16", [3] = "P_UINT16",
+	[4] = "P_LONG32", [5] = "P_ULONG32", [6] = "P_CUSTOM", [7] = "P_FLOAT32"
+}
+
+local f = mys.fields
+f.cap_version = ProtoField.uint8("mysensors.capture.version", "Capture version")
+f.direction = ProtoField.uint8("mysensors.capture.direction", "Direction", base.DEC, directions)
+f.hop = ProtoField.uint8("mysensors.capture.hop", "Hop", base.DEC, nil, nil, "TX: next hop, RX: last hop")
+f.tx_result = ProtoField.uint8("mysensors.capture.tx_result", "TX result", base.DEC, tx_results)
+f.retries = ProtoField.uint8("mysensors.capture.retries", "Retries")
+f.rssi = ProtoField.int16("mysensors.capture.rssi", "RSSI")
+f.snr = ProtoField.int16("mysensors.capture.snr", "SNR")
+
+f.last = ProtoField.uint8("mysensors.last", "Last")
+f.sender = ProtoField.uint8("mysensors.sender", "Sender")
+f.destination = ProtoField.uint8("mysensors.destination", "Destination")
+f.protocol = ProtoField.uint8("mysensors.protocol", "Protocol version", base.DEC, nil, 0x03)
+f.signed = ProtoField.bool("mysensors.signed", "Signed", 8, nil, 0x04)
+f.length = ProtoField.uint8("mysensors.length", "Payload length", base.DEC, nil, 0xF8)
+f.command = ProtoField.uint8("mysensors.command", "Command", base.DEC, commands, 0x07)
+f.request_ack = ProtoField.bool("mysensors.request_ack", "Request echo", 8, nil, 0x08)
+f.ack = ProtoField.bool("mysensors.ack", "Echo", 8, nil, 0x10)
+f.payload_type = ProtoField.uint8("mysensors.payload_type", "Payload type", base.DEC, payload_types, 0xE0)
+f.type = ProtoField.uint8("mysensors.type", "Type")
+f.sensor = ProtoField.uint8("mysensors.sensor", "Sensor")
+f.last_high = ProtoField.uint8("mysensors.last_high", "Last (high byte)")
+f.sender_high = ProtoField.uint8("mysensors.sender_high", "Sender (high byte)")
+f.destination_high = ProtoField.uint8("mysensors.destination_high", "Destination (high byte)")
+f.payload = ProtoField.bytes("mysensors.payload", "Payload")
+f.signature = ProtoField.bytes("mysensors.signature", "Signature")
+
+local CAPTURE_HEADER_SIZE = 12
+local HEADER_SIZE = 7
+local HEADER_EXTENSION_SIZE = 3		-- protocol version 3, high bytes of last, sender, destination
+
+function mys.dissector(buffer, pinfo, tree)
+	if buffer:len() < CAPTURE_HEADER_SIZE then
+		return 0
+	end
+	pinfo.cols.protocol = "MySensors"
+
+	local root = tree:add(mys, buffer(), "MySensors")
+	local cap = root:add(buffer(0, CAPTURE_HEADER_SIZE), "Capture")
+	cap:add(f.cap_version, buffer(0, 1))
+	cap:add(f.direction, buffer(1, 1))
+	cap:add(f.hop, buffer(2, 1))
+	cap:add(f.tx_result, buffer(3, 1))
+	cap:add(f.retries, buffer(4, 1))
+	cap:add_le(f.rssi, buffer(6, 2))
+	cap:add_le(f.snr, buffer(8, 2))
+
+	local msg = buffer(CAPTURE_HEADER_SIZE):tvb()
+	if msg:len() < HEADER_SIZE then
+		return buffer:len()
+	end
+	local direction = directions[buffer(1, 1):uint()] or "?"
+	local hdr = root:add(msg(0, HEADER_SIZE), "Header")
+	hdr:add(f.last, msg(0, 1))
+	hdr:add(f.sender, msg(1, 1))
+	hdr:add(f.destination, msg(2, 1))
+	hdr:add(f.protocol, msg(3, 1))
+	hdr:add(f.signed, msg(3, 1))
+	hdr:add(f.length, msg(3, 1))
+	hdr:add(f.command, msg(4, 1))
+	hdr:add(f.request_ack, msg(4, 1))
+	hdr:add(f.ack, msg(4, 1))
+	hdr:add(f.payload_type, msg(4, 1))
+	hdr:add(f.type, msg(5, 1))
+	hdr:add(f.sensor, msg(6, 1))
+
+	local last = msg(0, 1):uint()
+	local sender = msg(1, 1):uint()
+	local destination = msg(2, 1):uint()
+	local payload_offset = HEADER_SIZE
+	if msg(3, 1):bitfield(6, 2) == 3 and msg:len() >= HEADER_SIZE + HEADER_EXTENSION_SIZE then
+		local ext = root:add(msg(HEADER_SIZE, HEADER_EXTENSION_SIZE), "Header extension")
+		ext:add(f.last_high, msg(HEADER_SIZE, 1))
+		ext:add(f.sender_high, msg(HEADER_SIZE + 1, 1))
+		ext:add(f.destination_high, msg(HEADER_SIZE + 2, 1))
+		last = last + msg(HEADER_SIZE, 1):uint() * 256
+		sender = sender + msg(HEADER_SIZE + 1, 1):uint() * 256
+		destination = destination + msg(HEADER_SIZE + 2, 1):uint() * 256
+		payload_offset = HEADER_SIZE + HEADER_EXTENSION_SIZE
+	end
+
+	local length = msg(3, 1):bitfield(0, 5)
+	local available = msg:len() - payload_offset
+	local payload_length = math.min(length, available)
+	if payload_length > 0 then
+		root:add(f.payload, msg(payload_offset, payload_length))
+	end
+	if msg(3, 1):bitfield(5, 1) == 1 and available > payload_length then
+		root:add(f.signature, msg(payload_offset + payload_length))
+	end
+
+	local command = msg(4, 1):bitfield(5, 3)
+	pinfo.cols.src = tostring(sender)
+	pinfo.cols.dst = tostring(destination)
+	pinfo.cols.info = string.format("%s %d-%d-%d s=%d %s t=%d l=%d", direction, sender,
+	                                last, destination, msg(6, 1):uint(),
+	                                commands[command] or "?", msg(5, 1):uint(), length)
+	return buffer:len()
+end
+
+-- mysgw writes LINKTYPE_USER0 (147)
+local wtap_encap = DissectorTable.get("wtap_encap")
+wtap_encap:add(wtap.USER0, mys)